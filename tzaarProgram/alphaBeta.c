@@ -16,10 +16,23 @@
 #include <sys/time.h>
 #include <time.h>
 
-/// Statical evaluation function
-/// Should be as quick as possible
+THREAD_LOCAL i32 historyPruneMoves[BOARD_ARRAY_SIZE][BOARD_ARRAY_SIZE];
+THREAD_LOCAL u16 killerMoves[MAX_MOVES][KILLER_SLOTS];
+THREAD_LOCAL u16 counterMoves[2][BOARD_ARRAY_SIZE + 1][BOARD_ARRAY_SIZE + 1];
+THREAD_LOCAL i32 killerRootPly;
+THREAD_LOCAL TTBucket *TranspositionTable;
+THREAD_LOCAL i32 *StackHeightValue = StackHeightValues[EVAL_STANDARD];
+THREAD_LOCAL i32 evalParameters = EVAL_STANDARD;
+THREAD_LOCAL i32 selectiveSearch;
+THREAD_LOCAL i32 futilityMargin;
+size_t ttSize = TTSIZE;
+THREAD_LOCAL Move rootBest1, rootBest2;
+THREAD_LOCAL i32 rootBestValue;
+THREAD_LOCAL bool rootBestFound, rootBestValid;
+
+/// Statical evaluation function computed from highestStack, ZOC and counts
 inline __attribute__ ((always_inline))
-i32 StaticValue()
+i32 StaticValueFull()
 {
 	i32 val = 0; // static value
 
@@ -74,105 +87,429 @@ i32 StaticValue()
 	return val;
 }
 
+#ifdef INCREMENTAL_EVAL
+// terms of StaticValue from the last evaluation in the thread and their inputs
+static THREAD_LOCAL bool evalTermsValid;
+static THREAD_LOCAL i32 evalHighest[STONE_TYPES], evalZOC[STONE_TYPES], evalCounts[STONE_TYPES];
+static THREAD_LOCAL i32 heightTerm;	// bonuses for secure types and for stacks of all types
+static THREAD_LOCAL i32 zocTerms[STONE_TYPES];	// ZOC of the type weighted by its captured stones, from white's view
+static THREAD_LOCAL i32 threatTerms[STONE_TYPES];	// the last stones of the type are threatened, from white's view
+
+/// Bonuses for secure types and for stacks of all types, the same as in StaticValueFull
+/// (not inlined, as UpdateZOCTerms: they are called rarely and StaticValue is inlined in every search)
+__attribute__ ((noinline))
+i32 HeightTerm()
+{
+	i32 val = 0;
+	i32 maxW = MAX(MAX(highestStack[4], highestStack[5]), highestStack[6]);
+	i32 maxB = MAX(MAX(highestStack[0], highestStack[1]), highestStack[2]);
+	bool secW = true, secB = true;
+	FOR(i, 0, 3) {
+		if (highestStack[i] > maxW) {
+			val -= SECURE_TYPE;
+		} else
+			secB = false;
+	}
+	FOR(i, 4, 7) {
+		if (highestStack[i] > maxB) {
+			val += SECURE_TYPE;
+		} else
+			secW = false;
+	}
+	if (secW)
+		val += FULL_SECURE;
+	if (secB)
+		val -= FULL_SECURE;
+	i32 minW = MIN(MIN(highestStack[4], highestStack[5]), highestStack[6]);
+	i32 minB = MIN(MIN(highestStack[0], highestStack[1]), highestStack[2]);
+	if (minW >= 2)
+		val += STACK_OF_ALL_TYPES_BONUS;
+	if (minB >= 2)
+		val -= STACK_OF_ALL_TYPES_BONUS;
+	return val;
+}
+
+/// Recomputes the ZOC terms of the stone type i for the current ZOC and counts
+__attribute__ ((noinline))
+void UpdateZOCTerms(i32 i)
+{
+	i32 sign = i < 3 ? 1 : -1;	// ZOC of black types is good for white
+	evalZOC[i] = zoneOfControl[i];
+	evalCounts[i] = counts[i];
+	zocTerms[i] = sign * ((zoneOfControl[i] * (InitialStoneCounts[i] - counts[i]) * ZONE_OF_CONTROL_HEIGHT) / InitialStoneCounts[i]);
+	threatTerms[i] = counts[i] <= 2 && zoneOfControl[i] == counts[i] ? sign * THREAT_HEIGHT * (3 - counts[i]) : 0;
+}
+#endif
+
+#ifdef CHECK_INCREMENTAL_EVAL
+static THREAD_LOCAL i32 evalCheckErrors;	// incremental static values which differed from the full computation
+#endif
+
+/// Statical evaluation function
+/// Should be as quick as possible, with INCREMENTAL_EVAL only the terms whose inputs changed are recomputed
+/// (siblings in the search differ only in a few stone types)
+inline __attribute__ ((always_inline))
+i32 StaticValue()
+{
+	TCOUNT(evalCalls);
+#ifdef INCREMENTAL_EVAL
+	if (!evalTermsValid) {
+		FOR(i, 0, STONE_TYPES) evalHighest[i] = evalZOC[i] = -1;
+		evalTermsValid = true;
+	}
+	// bonus for secure types and stacks of all types
+	bool heightChanged = false;
+	FOR(i, 0, STONE_TYPES) if (highestStack[i] != evalHighest[i]) {
+		evalHighest[i] = highestStack[i];
+		heightChanged = true;
+	}
+	if (heightChanged)
+		heightTerm = HeightTerm();
+	i32 val = heightTerm;
+
+	// zone of control
+	i32 ZOCw = 0, ZOCb = 0, threatW = 0, threatB = 0;
+	FOR(i, 0, 3) {
+		if (zoneOfControl[i] != evalZOC[i] || counts[i] != evalCounts[i])
+			UpdateZOCTerms(i);
+		val += zocTerms[i];
+		threatB += threatTerms[i];
+		ZOCb += zoneOfControl[i];
+	}
+	FOR(i, 4, 7) {
+		if (zoneOfControl[i] != evalZOC[i] || counts[i] != evalCounts[i])
+			UpdateZOCTerms(i);
+		val += zocTerms[i];
+		threatW += threatTerms[i];
+		ZOCw += zoneOfControl[i];
+	}
+	val += threatB * (player == WHITE ? THREAT_HEIGHT_MULT : 1) + threatW * (player == BLACK ? THREAT_HEIGHT_MULT : 1);
+
+	// a small number of stacks that can be captured is disadvantage for opponent
+	if (ZOCw <= ZOC_CRITICAL_SUM)
+		val += ZOC_CRITICAL_BONUS;
+	if (ZOCb <= ZOC_CRITICAL_SUM)
+		val -= ZOC_CRITICAL_BONUS;
+#ifdef CHECK_INCREMENTAL_EVAL
+	i32 full = StaticValueFull();
+	if (val != full) {	// reported also without DEBUG
+		evalCheckErrors++;
+		printf("error eval incremental static value %d, full computation %d (%d errors)\n", val, full,
+		       evalCheckErrors);
+		fflush(stdout);
+	}
+#endif
+	return val;
+#else
+	return StaticValueFull();
+#endif
+}
+
 /// Statical evaluation function for beginner's AI
 inline __attribute__ ((always_inline))
 i32 StaticValueBeginner()
 {
+	TCOUNT(evalCalls);
 	return 0;
 }
 
+#ifdef EVAL_CACHE
+static THREAD_LOCAL EvalCacheEntry EvalCache[EVAL_CACHE_SIZE];
+#endif
+
+/// materialValue + StaticValue() of the current position, looked up in the eval cache first (with EVAL_CACHE)
 inline __attribute__ ((always_inline))
-TTEntry *LookupPositionInTT()
+i32 CachedStaticValue()
 {
-	i32 index = hash % TTSIZE;
-	if (TranspositionTable[index] != null && TranspositionTable[index]->hash == hash)
-		return TranspositionTable[index];
-	else if (TranspositionTable[index + TTSIZE] != null && TranspositionTable[index + TTSIZE]->hash == hash)
-		return TranspositionTable[index + TTSIZE];
-	else
-		return null;
+#ifdef EVAL_CACHE
+	EvalCacheEntry *entry = &EvalCache[hash & (EVAL_CACHE_SIZE - 1)];
+	u32 lock = (u32) (hash >> 32);
+	if (entry->lock == lock) {
+		TCOUNT(evalCacheHits);
+		return entry->value;
+	}
+	i32 v = materialValue + StaticValue();
+	entry->lock = lock;
+	entry->value = v;
+	return v;
+#else
+	return materialValue + StaticValue();
+#endif
+}
+
+/// Forgets values in the eval cache of the current thread, it must be called when the evaluation constants change
+void ClearEvalCache()
+{
+#ifdef EVAL_CACHE
+	memset(EvalCache, 0, sizeof(EvalCache));
+#endif
+}
+
+/// Switches the evaluation of the current thread to the parameter set (EVAL_STANDARD or EVAL_BEGINNER),
+/// the material value of the position is recounted and the eval cache cleared
+void SetEvalParameters(i32 set)
+{
+	if (set == evalParameters)
+		return;
+	evalParameters = set;
+	StackHeightValue = StackHeightValues[set];
+	CountMaterialValue();
+	ClearEvalCache();
+}
+
+/// Sets the size of TT to the largest power of two which fits into megabytes, tables are allocated later by InitTT
+void SetTTSize(u32 megabytes)
+{
+	size_t bytes = (size_t) megabytes << 20;
+	ttSize = 1;
+	while (2 * ttSize * sizeof(TTBucket) <= bytes)
+		ttSize *= 2;
+}
+
+/// Allocate TT for the current thread if it's not done yet, returns false if there is not enough memory
+bool InitTT()
+{
+	if (TranspositionTable == null)
+		TranspositionTable = (TTBucket *) AllocateTable(ttSize * sizeof(TTBucket));
+	return TranspositionTable != null;
+}
+
+/// Frees TT of the current thread and clears its history table and eval cache, so that the next search
+/// doesn't depend on the previous ones (InitTT allocates a new zeroed table)
+void ClearTT()
+{
+	if (TranspositionTable != null)
+		FreeTable(TranspositionTable, ttSize * sizeof(TTBucket));
+	TranspositionTable = null;
+	memset(historyPruneMoves, 0, sizeof(historyPruneMoves));
+	ClearEvalCache();
+}
+
+/// Xor of the data of the entry, it's xored into the lock so that an entry torn by concurrent writes
+/// of two threads doesn't match the position (the table is shared without locks by the search threads)
+inline __attribute__ ((always_inline))
+u32 TTEntryChecksum(PackedTTEntry * entry)
+{
+	return (entry->bestMove1 | (u32) entry->bestMove2 << 16) ^ (u32) entry->value
+	    ^ (entry->searchDepth | (u32) entry->generationType << 8 | (u32) entry->searchedNodes << 16);
 }
 
+/// Finds the position in TT and unpacks it into entry, returns entry or null if the position isn't saved
 inline __attribute__ ((always_inline))
-bool CompareTTEntries(TTEntry * a, TTEntry * b)
+TTEntry *LookupPositionInTT(TTEntry * entry)
 {
-	if (a->valueType != EXACT_VALUE) {
-		if (b->valueType != EXACT_VALUE)
-			return a->searchedNodes < b->searchedNodes;
-		else
-			return true;
-	} else if (b->valueType != EXACT_VALUE)
-		return false;
-	return a->searchedNodes < b->searchedNodes;
+	TTBucket *bucket = &TranspositionTable[hash & (ttSize - 1)];
+	u32 lock = (u32) (hash >> 32);
+	TCOUNT(ttProbes);
+	for (PackedTTEntry * shared = bucket->entries; shared < bucket->entries + TT_BUCKET_SIZE; shared++) {
+		PackedTTEntry saved = *shared;	// copy, other threads may write the entry meanwhile
+		if (saved.bestMove1 == 0)
+			break;
+		if ((saved.lock ^ TTEntryChecksum(&saved)) == lock) {
+			DecodeMove(saved.bestMove1, &entry->bestMove1);
+			DecodeMove(saved.bestMove2, &entry->bestMove2);
+			entry->value = saved.value;
+			entry->valueType = (saved.generationType & 3) - 1;
+			entry->searchDepth = saved.searchDepth;
+			entry->searchedNodes = saved.searchedNodes;
+			TCOUNT(ttHits);
+			return entry;
+		}
+	}
+	return null;
+}
+
+/// Node counts are stored with 10 significant bits and 6 bits of exponent, smaller counts exactly
+inline __attribute__ ((always_inline))
+u16 EncodeNodes(u32 searchedNodes)
+{
+	if (searchedNodes < 2048)
+		return (u16) searchedNodes;
+	i32 e = 21 - __builtin_clz(searchedNodes);	// searchedNodes >> e is in [1024, 2048)
+	return (u16) ((e << 10) + (searchedNodes >> e));
 }
 
+/// How valuable the entry is for keeping it in TT, entries from older searches lose their worth quickly
 inline __attribute__ ((always_inline))
-void FreeTTEntry(TTEntry * entry)
+i32 TTEntryWorth(PackedTTEntry * entry)
 {
-	ASSERT2(entry != null, "entry to free not null");
-	if (entry->bestMove1 != null)
-		FreeMove(entry->bestMove1);
-	if (entry->bestMove2 != null)
-		FreeMove(entry->bestMove2);
-	DBG(entryAlive--);
-	free(entry);
+	i32 age = (searchGeneration - (entry->generationType >> 2)) & 63;
+	i32 exact = (entry->generationType & 3) == EXACT_VALUE + 1;
+	return entry->searchedNodes + entry->searchDepth * TT_DEPTH_WEIGHT + exact * TT_EXACT_WEIGHT
+	    - age * TT_AGE_WEIGHT;
 }
 
+/// Save the position to TT, best moves are encoded into the entry (bestMove2 could have from == NO_MOVE).
+/// The entry of the same position is overwritten by deeper or larger search, otherwise an empty entry
+/// or the one with the least worth in the bucket is replaced.
 inline __attribute__ ((always_inline))
 void AddPositionToTT(i32 value, i32 type, i32 searchDepth, u32 searchedNodes, Move * bestMove1, Move * bestMove2)
 {
-	i32 index = hash % TTSIZE;
-	if (TranspositionTable[index] != null && TranspositionTable[index]->hash == hash) {
-		if (searchDepth > TranspositionTable[index]->searchDepth || searchedNodes >= TranspositionTable[index]->searchedNodes) {
-			TranspositionTable[index]->searchedNodes = searchedNodes;
-			TranspositionTable[index]->searchDepth = searchDepth;
-			Move *tmp = TranspositionTable[index]->bestMove1;
-			if (tmp != null)
-				FreeMove(tmp);
-			tmp = TranspositionTable[index]->bestMove2;
-			if (tmp != null)
-				FreeMove(tmp);
-			TranspositionTable[index]->bestMove1 = bestMove1;
-			TranspositionTable[index]->bestMove2 = bestMove2;
-			TranspositionTable[index]->value = value;
-			TranspositionTable[index]->valueType = type;
+	ASSERT2(bestMove1->from != NO_MOVE, "saving TT entry without best move");
+	TTBucket *bucket = &TranspositionTable[hash & (ttSize - 1)];
+	PackedTTEntry entry;
+	entry.lock = (u32) (hash >> 32);
+	entry.bestMove1 = EncodeMove(bestMove1);
+	entry.bestMove2 = EncodeMove(bestMove2);
+	entry.value = value;
+	entry.generationType = (u8) (searchGeneration << 2 | (type + 1));
+	entry.searchDepth = searchDepth;
+	entry.searchedNodes = EncodeNodes(searchedNodes);
+	entry.lock ^= TTEntryChecksum(&entry);
+	PackedTTEntry *replace = null;
+	i32 replaceWorth = 0;
+	for (PackedTTEntry * shared = bucket->entries; shared < bucket->entries + TT_BUCKET_SIZE; shared++) {
+		PackedTTEntry saved = *shared;
+		if (saved.bestMove1 == 0) {	// entries are never removed, so there are no more entries in the bucket
+			replace = shared;
+			break;
+		}
+		if ((saved.lock ^ TTEntryChecksum(&saved)) == (u32) (hash >> 32)) {
+			if (searchDepth > saved.searchDepth || entry.searchedNodes >= saved.searchedNodes) {
+				*shared = entry;
+			} else {
+				saved.lock ^= TTEntryChecksum(&saved);
+				saved.generationType = (u8) (searchGeneration << 2 | (saved.generationType & 3));
+				saved.lock ^= TTEntryChecksum(&saved);
+				*shared = saved;
+			}
+			return;
+		}
+		i32 worth = TTEntryWorth(&saved);
+		if (replace == null || worth < replaceWorth) {
+			replace = shared;
+			replaceWorth = worth;
 		}
-		return;
 	}
-	if (TranspositionTable[index + TTSIZE] != null && TranspositionTable[index + TTSIZE]->hash == hash) {
-		if (searchDepth > TranspositionTable[index + TTSIZE]->searchDepth
-		    || searchedNodes >= TranspositionTable[index + TTSIZE]->searchedNodes) {
-			TranspositionTable[index + TTSIZE]->searchedNodes = searchedNodes;
-			TranspositionTable[index + TTSIZE]->searchDepth = searchDepth;
-			TranspositionTable[index + TTSIZE]->bestMove1 = bestMove1;
-			TranspositionTable[index + TTSIZE]->bestMove2 = bestMove2;
-			TranspositionTable[index + TTSIZE]->value = value;
-			TranspositionTable[index + TTSIZE]->valueType = type;
+	DBG(if (replace->bestMove1 != 0) ttKick++; else entryAlive++);
+	*replace = entry;
+}
+
+/// Remembers the best moves on the top level of the search, pv is true for the moves from the previous iteration.
+/// They are searched first, so a partial iteration without them may return worse moves than the previous one.
+inline __attribute__ ((always_inline))
+void SaveRootBest(Move * m1, Move * m2, i32 val, bool pv)
+{
+	rootBest1 = *m1;
+	rootBest2 = *m2;
+	rootBestValue = val;
+	rootBestFound = true;
+	if (pv)
+		rootBestValid = true;
+}
+
+/// Clears killer moves and countermoves and sets the current position as the root of the search in the thread,
+/// called at the beginning of every search, so that it doesn't depend on the previous ones
+void ClearKillerMoves()
+{
+	memset(killerMoves, 0, sizeof(killerMoves));
+	memset(counterMoves, 0, sizeof(counterMoves));
+	killerRootPly = turnNumber * 2 + moveNumber;
+}
+
+/// Saves the turn causing a cutoff in the node (moveNumber 1): m1 and m2 become killer moves of their plies and
+/// countermoves to the last move of the opponent. The position may be also after m1; m2 is null if m1 alone
+/// caused the cutoff, passes are not saved (the generators add them without sorting).
+inline __attribute__ ((always_inline))
+void SaveKillerMoves(Move * m1 __attribute__ ((unused)), Move * m2 __attribute__ ((unused)))
+{
+#ifdef KILLER_MOVES
+	i32 ply = turnNumber * 2 + 1;
+	Move *last = turnNumber * 2 >= killerRootPly ? history[turnNumber * 2] : null;	// the last move of the opponent
+	FOR(i, 0, 2) {
+		Move *m = i == 0 ? m1 : m2;
+		if (m == null || m->from < 0)
+			continue;
+		u16 code = EncodeMove(m);
+		u16 *killers = killerMoves[ply + i];
+		if (killers[0] != code) {
+			for (i32 slot = KILLER_SLOTS - 1; slot > 0; slot--)
+				killers[slot] = killers[slot - 1];
+			killers[0] = code;
 		}
-		return;
+		if (last != null)
+			counterMoves[i][last->from + 1][last->to + 1] = code;
 	}
-	TTEntry *entry = MALLOC(TTEntry);
-	DBG(entryAlive++);
-	entry->bestMove1 = bestMove1;
-	entry->bestMove2 = bestMove2;
-	entry->value = value;
-	entry->hash = hash;
-	entry->searchDepth = searchDepth;
-	entry->searchedNodes = searchedNodes;
-	entry->valueType = type;
-	TTEntry *toSave = entry;
-	if (TranspositionTable[index] == null || CompareTTEntries(TranspositionTable[index], entry)) {
-		toSave = TranspositionTable[index];
-		TranspositionTable[index] = entry;
-	}
-	if (toSave != null) {	// it holds: TranspositionTable[index] > TranspositionTable[index + TTSIZE]
-		TTEntry *old = TranspositionTable[index + TTSIZE];
-		TranspositionTable[index + TTSIZE] = toSave;
-		if (old != null) {
-			FreeTTEntry(old);
-			DBG(ttKick++);
+#endif
+}
+
+#ifdef QUIESCENCE
+/// True if the player to move may have a loud capture: ZOC shows a threatened opponent type
+/// with stacks or with at most QS_CRITICAL_COUNT stones
+inline __attribute__ ((always_inline))
+bool HasLoudCaptures()
+{
+	i32 index = (1 - player) * 2;	// opponent's stone types
+	FOR(i, index, index + 3) if (zoneOfControl[i] > 0 && (highestStack[i] > 1 || counts[i] <= QS_CRITICAL_COUNT))
+		return true;
+	return false;
+}
+
+/// Quiescence search: after the stand pat (the value of the position, at moveNumber 2 it stands for a quiet
+/// second half-move) only loud captures are searched, i.e. captures of stacks and of stones of types with at most
+/// QS_CRITICAL_COUNT stones. Captures which can't raise the stand pat above alpha even with QS_DELTA_MARGIN
+/// are pruned (delta pruning), at most QS_MAX_MOVES captures are searched in a node and qdepth half-moves
+/// in a sequence. The search doesn't check the abort, it is small and its values are saved to TT by the callers.
+i32 Quiescence(i32 alpha, i32 beta, i32 qdepth)
+{
+	if (abs(value) == WIN)
+		return player * value;
+	i32 max = player * CachedStaticValue();	// stand pat
+	if (max >= beta || qdepth == 0 || !HasLoudCaptures())
+		return max;
+	if (max > alpha)
+		alpha = max;
+	i32 standPat = max, searched = 0;
+	Move *moves;
+	i32 count = GenerateAllMovesSortedMove1(&moves);	// only captures also in moveNumber 2
+	for (Move *move = moves; move < moves + count && searched < QS_MAX_MOVES; move++) {
+		i32 to = move->to;
+		bool critical = counts[board[to] + 3] <= QS_CRITICAL_COUNT;
+		if (!critical && (stackHeights[to] == 1
+				  || standPat + StackQuality(stackHeights[to], board[to], to) + QS_DELTA_MARGIN <= alpha))
+			continue;	// a quiet capture or delta pruning
+		searched++;
+		searchedNodes++;
+		TCOUNT(qsNodes);
+		bool secondMove = moveNumber == 2;
+		ExecuteMove(move);
+		i32 val = secondMove ? -Quiescence(-beta, -alpha, qdepth - 1) : Quiescence(alpha, beta, qdepth - 1);
+		RevertLastMove();
+		if (val > max) {
+			max = val;
+			if (val > alpha) {
+				alpha = val;
+				if (alpha >= beta) {
+					TCUTOFF(searched == 1);
+					break;
+				}
+			}
 		}
 	}
+	return max;
+}
+#endif
+
+/// Value of a leaf for the player to move (moveNumber 1), with QUIESCENCE the horizon is searched further by captures
+inline __attribute__ ((always_inline))
+i32 LeafValue(i32 alpha __attribute__ ((unused)), i32 beta __attribute__ ((unused)))
+{
+#ifdef QUIESCENCE
+	return Quiescence(alpha, beta, QS_DEPTH);
+#else
+	return player * CachedStaticValue();
+#endif
+}
+
+/// Value of a leaf after the first half-move of the player to move (moveNumber 2), see LeafValue
+inline __attribute__ ((always_inline))
+i32 LeafValueAfterMove1(i32 alpha __attribute__ ((unused)), i32 beta __attribute__ ((unused)))
+{
+#ifdef QUIESCENCE
+	return Quiescence(alpha, beta, QS_DEPTH);
+#else
+	return player * CachedStaticValue();
+#endif
 }
 
 /// AlphaBeta without enhancements
@@ -182,34 +519,36 @@ i32 AlphaBeta(i32 depth, i32 alpha, i32 beta)
 	ASSERT2(depth >= 0, "depth < 0");
 	ASSERT2(moveNumber == 1, "AB starting: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 	searchedNodes++;
+	if (SEARCH_ABORTED())
+		return 0;
 	if (abs(value) == WIN) {
 		return player * value;
 	}
 	ASSERT2(!IsEndOfGame(), "AB end of game, val %d, depth %d", value, depth);
 	if (depth == 0) {
-		i32 v = materialValue + StaticValue();
+		i32 v = CachedStaticValue();
 		return player * v;
 	}
 	i32 initSearchedNodes = searchedNodes;
-	i32 ttType = LOWER_BOUND;
+	i32 ttType = UPPER_BOUND;
 	i32 moveCount = 0;
-	Move *best1 = null, *best2 = null;
+	Move best1, best2;	// copies, the lists of moves are overwritten by generating in next iterations
+	best1.from = best2.from = NO_MOVE;
 	i32 val, max = -WIN - 1;
 	moveNumber = 1;
-	TTEntry *saved = LookupPositionInTT();
+	TTEntry savedEntry;
+	TTEntry *saved = LookupPositionInTT(&savedEntry);
 	if (saved != null) {
-		if ((saved->bestMove1 != null && !IsMovePossible(saved->bestMove1))
-		    || (saved->bestMove1 != null && !IsMovePossible(saved->bestMove1))) {
+		if (saved->bestMove1.from != NO_MOVE && !IsMovePossible(&saved->bestMove1)) {
 			saved = null;
 			DPRINT("HashCollision");
 			DBG(ttCollision++);
 		}
 	}
 	if (saved != null) {
-		DBG(ttFound++);
 		if (saved->searchDepth >= depth) {
-			DBG(ttHit++);
 			if (saved->valueType == EXACT_VALUE) {
+				TCOUNT(ttCutoffs);
 				ASSERT2(moveNumber == 1, "AB ret 1: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 				return saved->value;
 			} else if (saved->valueType == LOWER_BOUND && saved->value > alpha) {	//update lowerbound if needed
@@ -218,58 +557,38 @@ i32 AlphaBeta(i32 depth, i32 alpha, i32 beta)
 				beta = saved->value;
 			}
 			if (alpha >= beta) {
-				DBG(prunedCount++);
+				TCOUNT(ttCutoffs);
 				ASSERT2(moveNumber == 1, "AB ret 2: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 				return saved->value;
 			}
 		}
 	}
 	bool pruned = false;
-	Move *tmp, *move, *move2, *start1, *start2;
-	GenerateAllMoves(&move);
-	start1 = move;
-	while (move != NULL) {
+	Move *moves, *moves2;
+	i32 count = GenerateAllMoves(&moves);
+	for (Move *move = moves; move < moves + count; move++) {
 		ASSERT2(IsMovePossible(move), "AB: move 1 not possible");
 		ExecuteMove(move);
 		i32 plVal = player * value;
 		if (plVal == WIN) {
 			max = WIN;
-			if (best1 != move) {	// do not cut a branch under you
-				if (best1 != null) {
-					FreeMove(best1);
-				}
-				best1 = move;
-			}
-			if (best2 != null) {
-				FreeMove(best2);
-				best2 = null;
-			}
+			best1 = *move;
+			best2.from = NO_MOVE;
 			//pruning
 			alpha = WIN;
 			pruned = true;
 			RevertLastMove();
-			DBG(prunedCount++);
-			do {
-				tmp = move;
-				move = move->next;
-				if (tmp != best1)
-					FreeMove(tmp);
-			} while (move != NULL);
-			ttType = UPPER_BOUND;
+			TCUTOFF(move == moves);
+			ttType = LOWER_BOUND;
 			break;
 		}
 		else if (depth == 1) {
 			searchedNodes++;
 			i32 val = 0;
-			val = player * (materialValue + StaticValue());
+			val = player * CachedStaticValue();
 			if (val > max) {
 				max = val;
-				if (best1 != move) {	// do not cut a branch under you
-					if (best1 != null) {
-						FreeMove(best1);
-					}
-					best1 = move;
-				}
+				best1 = *move;
 			}
 			if (val > alpha) {
 				alpha = val;
@@ -277,79 +596,51 @@ i32 AlphaBeta(i32 depth, i32 alpha, i32 beta)
 				if (alpha >= beta) {
 					pruned = true;
 					RevertLastMove();
-					DBG(prunedCount++);
-					do {
-						tmp = move;
-						move = move->next;
-						if (tmp != best1)
-							FreeMove(tmp);
-					} while (move != NULL);
-					ttType = UPPER_BOUND;
+					TCUTOFF(move == moves);
+					ttType = LOWER_BOUND;
 					break;
 				}
 			}
 		} else {
-			GenerateAllMoves(&move2);
-			start2 = move2;
-			while (move2 != NULL) {
+			i32 count2 = GenerateAllMoves(&moves2);
+			for (Move *move2 = moves2; move2 < moves2 + count2; move2++) {
 				ASSERT2(IsMovePossible(move2), "AB: move 2 not possible");
 				ExecuteMove(move2);
 				moveCount++;
 				val = -AlphaBeta(depth - 2, -beta, -alpha);
 				RevertLastMove();
+				if (searchAborted) {
+					RevertLastMove();
+					return 0;
+				}
 				if (val > max) {
 					max = val;
-					if (best1 != move) {	// do not cut a branch under you
-						if (best1 != null) {
-							FreeMove(best1);
-						}
-						best1 = move;
-					}
-					if (best2 != null)
-						FreeMove(best2);
-					best2 = move2;
+					best1 = *move;
+					best2 = *move2;
+					if (depth == currDepth)
+						SaveRootBest(&best1, &best2, max, false);
 				}
 				if (val > alpha) {
 					alpha = val;
 					if (alpha >= beta) {
 						pruned = true;
-						DBG(prunedCount++);
-						do {
-							tmp = move2;
-							move2 = move2->next;
-							if (best2 != tmp)
-								FreeMove(tmp);
-						} while (move2 != NULL);
-						ttType = UPPER_BOUND;
+						TCUTOFF(moveCount == 1);
+						ttType = LOWER_BOUND;
 						break;
 					}
 					ttType = EXACT_VALUE;
 				}
-				tmp = move2;
-				move2 = move2->next;
-				if (tmp != best2)
-					FreeMove(tmp);
 			}
 		}
 		RevertLastMove();
 		if (pruned) {
-			do {
-				tmp = move;
-				move = move->next;
-				if (tmp != best1)
-					FreeMove(tmp);
-			} while (move != NULL);
 			break;
 		}
-		tmp = move;
-		move = move->next;
-		if (tmp != best1)
-			FreeMove(tmp);
 	}
 	
 	ASSERT2(max > -WIN - 1, "AB: too low max %d", max);
 	DPRINT2("abPVMO END - depth %d, alpha %d, beta %d, searched %d", depth, alpha, beta, searchedNodes);
-	AddPositionToTT(max, ttType, depth, searchedNodes - initSearchedNodes, best1, best2);
+	AddPositionToTT(max, ttType, depth, searchedNodes - initSearchedNodes, &best1, &best2);
 	ASSERT2(moveNumber == 1, "bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 	return max;
 }
@@ -361,35 +652,37 @@ i32 AlphaBetaPV(i32 depth, i32 alpha, i32 beta)
 	ASSERT2(depth >= 0, "depth < 0");
 	ASSERT2(moveNumber == 1, "AB starting: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 	searchedNodes++;
+	if (SEARCH_ABORTED())
+		return 0;
 	if (abs(value) == WIN) {
 		return player * value;
 	}
 	ASSERT2(!IsEndOfGame(), "AB end of game, val %d, depth %d", value, depth);
 	if (depth == 0) {
-		i32 v = materialValue + StaticValue();
+		i32 v = CachedStaticValue();
 		return player * v;
 	}
 	i32 initSearchedNodes = searchedNodes;
-	i32 ttType = LOWER_BOUND;
+	i32 ttType = UPPER_BOUND;
 	i32 moveCount = 0;
-	Move *best1 = null, *best2 = null;
+	Move best1, best2;	// copies, the lists of moves are overwritten by generating in next iterations
+	best1.from = best2.from = NO_MOVE;
 	i32 val, max = -WIN - 1;
 	moveNumber = 1;
-	TTEntry *saved = LookupPositionInTT();
+	TTEntry savedEntry;
+	TTEntry *saved = LookupPositionInTT(&savedEntry);
 	if (saved != null) {
-		ASSERT2(saved->bestMove1 != null, "saved->bestMove1 == null");
-		if ((saved->bestMove1 != null && !IsMovePossible(saved->bestMove1))
-		    || (saved->bestMove1 != null && !IsMovePossible(saved->bestMove1))) {
+		ASSERT2(saved->bestMove1.from != NO_MOVE, "saved->bestMove1 not set");
+		if (saved->bestMove1.from != NO_MOVE && !IsMovePossible(&saved->bestMove1)) {
 			saved = null;
 			DPRINT("HashCollision");
 			DBG(ttCollision++);
 		}
 	}
 	if (saved != null) {
-		DBG(ttFound++);
 		if (saved->searchDepth >= depth) {
-			DBG(ttHit++);
 			if (saved->valueType == EXACT_VALUE) {
+				TCOUNT(ttCutoffs);
 				ASSERT2(moveNumber == 1, "AB ret 1: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 				return saved->value;
 			} else if (saved->valueType == LOWER_BOUND && saved->value > alpha) {	//update lowerbound if needed
@@ -398,28 +691,28 @@ i32 AlphaBetaPV(i32 depth, i32 alpha, i32 beta)
 				beta = saved->value;
 			}
 			if (alpha >= beta) {
-				DBG(prunedCount++);
+				TCOUNT(ttCutoffs);
 				ASSERT2(moveNumber == 1, "AB ret 2: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 				return saved->value;
 			}
 		}
-		Move *pv1 = saved->bestMove1;
-		Move *pv2 = saved->bestMove2;
-		if (depth == 1 || pv2 == null) {
-			ExecuteMove(pv1);
+		Move pv1 = saved->bestMove1;	// copies because of TT kicks
+		Move pv2 = saved->bestMove2;
+		if (depth == 1 || pv2.from == NO_MOVE) {
+			ExecuteMove(&pv1);
 			i32 plVal = player * value;
 			if (depth == 1 || plVal == WIN) {
 				if (plVal == WIN)
 					max = plVal;
 				else
-					max = player * (materialValue + StaticValue());
-				best1 = CloneMove(pv1);
+					max = player * CachedStaticValue();
+				best1 = pv1;
 				if (max > alpha) {
 					alpha = max;
 					if (alpha >= beta) {
 						RevertLastMove();
 						DPRINT2("pruned by pv move, d = 1, alpha %d, beta %d", alpha, beta);
-						DBG(prunedCount++);
+						TCUTOFF(true);
 						ASSERT2(moveNumber == 1, "AB ret 3: bad moveNumber turnNumber %d, moveNumber %d",
 							turnNumber, moveNumber);
 						return max;
@@ -427,20 +720,22 @@ i32 AlphaBetaPV(i32 depth, i32 alpha, i32 beta)
 				}
 			}
 			RevertLastMove();
-		} else if (pv2 != null) {
-			pv1 = CloneMove(pv1);	//because of TT kicks
-			pv2 = CloneMove(pv2);
-			ExecuteMove(pv1);
-			ExecuteMove(pv2);
+		} else {
+			ExecuteMove(&pv1);
+			ExecuteMove(&pv2);
 			max = -AlphaBetaPV(depth - 2, -beta, -alpha);
 			RevertLastMove();
 			RevertLastMove();
+			if (searchAborted)
+				return 0;
 			best1 = pv1;
 			best2 = pv2;
+			if (depth == currDepth)
+				SaveRootBest(&best1, &best2, max, true);
 			if (max > alpha) {
 				alpha = max;
 				if (alpha >= beta) {
-					DBG(prunedCount++);
+					TCUTOFF(true);
 					ASSERT2(moveNumber == 1, "AB ret 4: bad moveNumber turnNumber %d, moveNumber %d", turnNumber,
 						moveNumber);
 					return max;	//no need to save anything to TT
@@ -451,55 +746,34 @@ i32 AlphaBetaPV(i32 depth, i32 alpha, i32 beta)
 		}
 	}
 	bool pruned = false;
-	Move *tmp, *move, *move2, *start1, *start2;
-	GenerateAllMoves(&move);
-	
-	start1 = move;
-	while (move != NULL) {
+	Move *moves, *moves2;
+	i32 count = GenerateAllMoves(&moves);
+	for (Move *move = moves; move < moves + count; move++) {
 		ASSERT2(IsMovePossible(move), "AB: move 1 not possible");
 		ExecuteMove(move);
 		DPRINT2("exec move 1, depth %d", depth);
 		i32 plVal = player * value;
 		if (plVal == WIN) {
 			max = WIN;
-			if (best1 != move) {	// do not cut a branch under you
-				if (best1 != null) {
-					FreeMove(best1);
-				}
-				best1 = move;
-			}
-			if (best2 != null) {
-				FreeMove(best2);
-				best2 = null;
-			}
+			best1 = *move;
+			best2.from = NO_MOVE;
 			
 			//pruning
 			alpha = WIN;
 			pruned = true;
 			RevertLastMove();
-			DBG(prunedCount++);
+			TCUTOFF(move == moves && saved == null);
 			DPRINT2("pruned, d = 1 or win alpha %d, beta %d", alpha, beta);
-			do {
-				tmp = move;
-				move = move->next;
-				if (tmp != best1)
-					FreeMove(tmp);
-			} while (move != NULL);
-			ttType = UPPER_BOUND;
+			ttType = LOWER_BOUND;
 			break;
 		}
 		else if (depth == 1) {
 			searchedNodes++;
 			i32 val = 0;
-			val = player * (materialValue + StaticValue());
+			val = player * CachedStaticValue();
 			if (val > max) {
 				max = val;
-				if (best1 != move) {	// do not cut a branch under you
-					if (best1 != null) {
-						FreeMove(best1);
-					}
-					best1 = move;
-				}
+				best1 = *move;
 			}
 			if (val > alpha) {
 				alpha = val;
@@ -507,85 +781,55 @@ i32 AlphaBetaPV(i32 depth, i32 alpha, i32 beta)
 				if (alpha >= beta) {
 					pruned = true;
 					RevertLastMove();
-					DBG(prunedCount++);
+					TCUTOFF(move == moves && saved == null);
 					DPRINT2("pruned, d = 1");
-					do {
-						tmp = move;
-						move = move->next;
-						if (tmp != best1)
-							FreeMove(tmp);
-					} while (move != NULL);
-					ttType = UPPER_BOUND;
+					ttType = LOWER_BOUND;
 					break;
 				}
 			}
 		} else {
-			GenerateAllMoves(&move2);
-			start2 = move2;
-			
-			while (move2 != NULL) {
+			i32 count2 = GenerateAllMoves(&moves2);
+			for (Move *move2 = moves2; move2 < moves2 + count2; move2++) {
 				ASSERT2(IsMovePossible(move2), "AB: move 2 not possible");
 				ExecuteMove(move2);
 				moveCount++;
 				val = -AlphaBetaPV(depth - 2, -beta, -alpha);
 				RevertLastMove();
+				if (searchAborted) {
+					RevertLastMove();
+					return 0;
+				}
 				if (val > max) {
 					max = val;
-					if (best1 != move) {	// do not cut a branch under you
-						if (best1 != null) {
-							FreeMove(best1);
-						}
-						best1 = move;
-					}
-					if (best2 != null)
-						FreeMove(best2);
-					best2 = move2;
+					best1 = *move;
+					best2 = *move2;
+					if (depth == currDepth)
+						SaveRootBest(&best1, &best2, max, false);
 				}
 				if (val > alpha) {
 					alpha = val;
 					if (alpha >= beta) {
 						pruned = true;
-						DBG(prunedCount++);
+						TCUTOFF(moveCount == 1 && saved == null);
 						DPRINT2("pruned, alpha %d, beta %d", alpha, beta);
-						do {
-							tmp = move2;
-							move2 = move2->next;
-							if (best2 != tmp)
-								FreeMove(tmp);
-						} while (move2 != NULL);
-						ttType = UPPER_BOUND;
+						ttType = LOWER_BOUND;
 						
 						break;
 					}
 					ttType = EXACT_VALUE;
 				}
-				tmp = move2;
-				move2 = move2->next;
-				if (tmp != best2)
-					FreeMove(tmp);
-				
 			}
 		}
 		RevertLastMove();
 		if (pruned) {
 			DPRINT2("pruned");
-			do {
-				tmp = move;
-				move = move->next;
-				if (tmp != best1)
-					FreeMove(tmp);
-			} while (move != NULL);
 			break;
 		}
-		tmp = move;
-		move = move->next;
-		if (tmp != best1)
-			FreeMove(tmp);
 	}
 	
 	ASSERT2(max > -WIN - 1, "AB: too low max %d", max);
 	DPRINT2("abPVMO END - depth %d, alpha %d, beta %d, searched %d", depth, alpha, beta, searchedNodes);
-	AddPositionToTT(max, ttType, depth, searchedNodes - initSearchedNodes, best1, best2);
+	AddPositionToTT(max, ttType, depth, searchedNodes - initSearchedNodes, &best1, &best2);
 	ASSERT2(moveNumber == 1, "bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 	return max;
 }
@@ -597,34 +841,34 @@ i32 AlphaBetaPVMO(i32 depth, i32 alpha, i32 beta)
 	ASSERT2(depth >= 0, "depth < 0");
 	ASSERT2(moveNumber == 1, "AB starting: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 	searchedNodes++;
+	if (SEARCH_ABORTED())
+		return 0;
 	if (abs(value) == WIN) {
 		return player * value;
 	}
 	ASSERT2(!IsEndOfGame(), "AB end of game, val %d, depth %d", value, depth);
-	if (depth == 0) {
-		i32 v = materialValue + StaticValue();
-		return player * v;
-	}
+	if (depth == 0)
+		return LeafValue(alpha, beta);
 	i32 initSearchedNodes = searchedNodes;
-	i32 ttType = LOWER_BOUND;
+	i32 ttType = UPPER_BOUND;
 	i32 moveCount = 0;
-	Move *best1 = null, *best2 = null;
+	Move best1, best2;	// copies, the lists of moves are overwritten by generating in next iterations
+	best1.from = best2.from = NO_MOVE;
 	i32 val, max = -WIN - 1;
 	moveNumber = 1;
-	TTEntry *saved = LookupPositionInTT();
+	TTEntry savedEntry;
+	TTEntry *saved = LookupPositionInTT(&savedEntry);
 	if (saved != null) {
-		if ((saved->bestMove1 != null && !IsMovePossible(saved->bestMove1))
-		    || (saved->bestMove1 != null && !IsMovePossible(saved->bestMove1))) {
+		if (saved->bestMove1.from != NO_MOVE && !IsMovePossible(&saved->bestMove1)) {
 			saved = null;
 			DPRINT("HashCollision");
 			DBG(ttCollision++);
 		}
 	}
 	if (saved != null) {
-		DBG(ttFound++);
 		if (saved->searchDepth >= depth) {
-			DBG(ttHit++);
 			if (saved->valueType == EXACT_VALUE) {
+				TCOUNT(ttCutoffs);
 				ASSERT2(moveNumber == 1, "AB ret 1: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 				return saved->value;
 			} else if (saved->valueType == LOWER_BOUND && saved->value > alpha) {	//update lowerbound if needed
@@ -633,28 +877,29 @@ i32 AlphaBetaPVMO(i32 depth, i32 alpha, i32 beta)
 				beta = saved->value;
 			}
 			if (alpha >= beta) {
-				DBG(prunedCount++);
+				TCOUNT(ttCutoffs);
 				ASSERT2(moveNumber == 1, "AB ret 2: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 				return saved->value;
 			}
 		}
-		Move *pv1 = saved->bestMove1;
-		Move *pv2 = saved->bestMove2;
-		if (depth == 1 || pv2 == null) {
-			ExecuteMove(pv1);
+		Move pv1 = saved->bestMove1;	// copies because of TT kicks
+		Move pv2 = saved->bestMove2;
+		if (depth == 1 || pv2.from == NO_MOVE) {
+			ExecuteMove(&pv1);
 			i32 plVal = player * value;
 			if (depth == 1 || plVal == WIN) {
 				if (plVal == WIN)
 					max = plVal;
 				else
-					max = player * (materialValue + StaticValue());
-				best1 = CloneMove(pv1);
+					max = LeafValueAfterMove1(alpha, beta);
+				best1 = pv1;
 				if (max > alpha) {
 					alpha = max;
 					if (alpha >= beta) {
 						RevertLastMove();
 						DPRINT2("pruned by pv move, d = 1, alpha %d, beta %d", alpha, beta);
-						DBG(prunedCount++);
+						TCUTOFF(true);
+						SaveKillerMoves(&pv1, null);
 						ASSERT2(moveNumber == 1, "AB ret 3: bad moveNumber turnNumber %d, moveNumber %d",
 							turnNumber, moveNumber);
 						return max;
@@ -662,20 +907,23 @@ i32 AlphaBetaPVMO(i32 depth, i32 alpha, i32 beta)
 				}
 			}
 			RevertLastMove();
-		} else if (pv2 != null) {
-			pv1 = CloneMove(pv1);	//because of TT kicks
-			pv2 = CloneMove(pv2);
-			ExecuteMove(pv1);
-			ExecuteMove(pv2);
+		} else {
+			ExecuteMove(&pv1);
+			ExecuteMove(&pv2);
 			max = -AlphaBetaPVMO(depth - 2, -beta, -alpha);
 			RevertLastMove();
 			RevertLastMove();
+			if (searchAborted)
+				return 0;
 			best1 = pv1;
 			best2 = pv2;
+			if (depth == currDepth)
+				SaveRootBest(&best1, &best2, max, true);
 			if (max > alpha) {
 				alpha = max;
 				if (alpha >= beta) {
-					DBG(prunedCount++);
+					TCUTOFF(true);
+					SaveKillerMoves(&pv1, &pv2);
 					ASSERT2(moveNumber == 1, "AB ret 4: bad moveNumber turnNumber %d, moveNumber %d", turnNumber,
 						moveNumber);
 					return max;	//no need to save anything to TT
@@ -686,53 +934,32 @@ i32 AlphaBetaPVMO(i32 depth, i32 alpha, i32 beta)
 		}
 	}
 	bool pruned = false;
-	Move *tmp, *move, *move2, *start1, *start2;
-	GenerateAllMovesSortedMove1(&move);
-	
-	start1 = move;
-	while (move != NULL) {
+	Move *moves, *moves2;
+	i32 count = GenerateAllMovesSortedMove1(&moves);
+	for (Move *move = moves; move < moves + count; move++) {
 		ASSERT2(IsMovePossible(move), "AB: move 1 not possible");
 		ExecuteMove(move);
 		i32 plVal = player * value;
 		if (plVal == WIN) {
 			max = WIN;
-			if (best1 != move) {	// do not cut a branch under you
-				if (best1 != null) {
-					FreeMove(best1);
-				}
-				best1 = move;
-			}
-			if (best2 != null) {
-				FreeMove(best2);
-				best2 = null;
-			}
+			best1 = *move;
+			best2.from = NO_MOVE;
 			
 			//pruning
 			alpha = WIN;
 			pruned = true;
 			RevertLastMove();
-			DBG(prunedCount++);
-			do {
-				tmp = move;
-				move = move->next;
-				if (tmp != best1)
-					FreeMove(tmp);
-			} while (move != NULL);
-			ttType = UPPER_BOUND;
+			TCUTOFF(move == moves && saved == null);
+			SaveKillerMoves(&best1, null);
+			ttType = LOWER_BOUND;
 			break;
 		}
 		else if (depth == 1) {
 			searchedNodes++;
-			i32 val = 0;
-			val = player * (materialValue + StaticValue());
+			i32 val = LeafValueAfterMove1(alpha, beta);
 			if (val > max) {
 				max = val;
-				if (best1 != move) {	// do not cut a branch under you
-					if (best1 != null) {
-						FreeMove(best1);
-					}
-					best1 = move;
-				}
+				best1 = *move;
 			}
 			if (val > alpha) {
 				alpha = val;
@@ -740,235 +967,155 @@ i32 AlphaBetaPVMO(i32 depth, i32 alpha, i32 beta)
 				if (alpha >= beta) {
 					pruned = true;
 					RevertLastMove();
-					DBG(prunedCount++);
+					TCUTOFF(move == moves && saved == null);
+					SaveKillerMoves(&best1, null);
 					DPRINT2("pruned, d = 1");
-					do {
-						tmp = move;
-						move = move->next;
-						if (tmp != best1)
-							FreeMove(tmp);
-					} while (move != NULL);
-					ttType = UPPER_BOUND;
+					ttType = LOWER_BOUND;
 					break;
 				}
 			}
 		} else {
-			GenerateAllMovesSortedMove2(&move2);
-			
-			start2 = move2;
-			while (move2 != NULL) {
+			i32 count2 = GenerateAllMovesSortedMove2(&moves2);
+			for (Move *move2 = moves2; move2 < moves2 + count2; move2++) {
 				ASSERT2(IsMovePossible(move2), "AB: move 2 not possible");
 				ExecuteMove(move2);
 				moveCount++;
 				val = -AlphaBetaPVMO(depth - 2, -beta, -alpha);
 				RevertLastMove();
 				DPRINT2("rev move 2");
+				if (searchAborted) {
+					RevertLastMove();
+					return 0;
+				}
 				if (val > max) {
 					max = val;
-					if (best1 != move) {	// do not cut a branch under you
-						if (best1 != null) {
-							FreeMove(best1);
-							
-						}
-						best1 = move;
-					}
-					if (best2 != null)
-						FreeMove(best2);
-					
-					best2 = move2;
+					best1 = *move;
+					best2 = *move2;
+					if (depth == currDepth)
+						SaveRootBest(&best1, &best2, max, false);
 				}
 				if (val > alpha) {
 					alpha = val;
 					if (alpha >= beta) {
 						pruned = true;
-						DBG(prunedCount++);
+						TCUTOFF(moveCount == 1 && saved == null);
+						SaveKillerMoves(&best1, &best2);
 						DPRINT2("pruned, alpha %d, beta %d", alpha, beta);
-						do {
-							tmp = move2;
-							move2 = move2->next;
-							if (best2 != tmp)
-								FreeMove(tmp);
-						} while (move2 != NULL);
-						ttType = UPPER_BOUND;
+						ttType = LOWER_BOUND;
 						break;
 					}
 					ttType = EXACT_VALUE;
 				}
-				tmp = move2;
-				move2 = move2->next;
-				if (tmp != best2)
-					FreeMove(tmp);
-				
 			}
 		}
 		RevertLastMove();
 		if (pruned) {
 			DPRINT2("pruned");
-			do {
-				tmp = move;
-				move = move->next;
-				if (tmp != best1)
-					FreeMove(tmp);
-			} while (move != NULL);
 			break;
 		}
-		tmp = move;
-		move = move->next;
-		if (tmp != best1)
-			FreeMove(tmp);
 	}
 	
 	ASSERT2(max > -WIN - 1, "AB: too low max %d", max);
 	DPRINT2("abPVMO END - depth %d, alpha %d, beta %d, searched %d", depth, alpha, beta, searchedNodes);
-	AddPositionToTT(max, ttType, depth, searchedNodes - initSearchedNodes, best1, best2);
+	AddPositionToTT(max, ttType, depth, searchedNodes - initSearchedNodes, &best1, &best2);
 	ASSERT2(moveNumber == 1, "bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 	return max;
 }
 
 /// AlphaBeta with Move Ordering
-i32 AlphaBetaMO(i32 depth, i32 alpha, i32 beta, Move ** m1, Move ** m2)
+i32 AlphaBetaMO(i32 depth, i32 alpha, i32 beta, Move * m1, Move * m2)
 {
 	DPRINT2("abPVMO - depth %d, alpha %d, beta %d, searched %d", depth, alpha, beta, searchedNodes);
 	ASSERT2(depth >= 0, "depth < 0");
 	ASSERT2(moveNumber == 1, "AB starting: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 	searchedNodes++;
+	if (SEARCH_ABORTED())
+		return 0;
 	if (abs(value) == WIN) {
 		return player * value;
 	}
 	ASSERT2(!IsEndOfGame(), "AB end of game, val %d, depth %d", value, depth);
 	if (depth == 0) {
-		i32 v = materialValue + StaticValue();
+		i32 v = CachedStaticValue();
 		return player * v;
 	}
 	i32 moveCount = 0;
-	Move *best1 = null, *best2 = null;
+	Move best1, best2;	// copies, the lists of moves are overwritten by generating in next iterations
+	best1.from = best2.from = NO_MOVE;
 	i32 val, max = -WIN - 1;
 	moveNumber = 1;
 	bool pruned = false;
-	Move *tmp, *move, *move2, *start1, *start2;
-	GenerateAllMoves(&move);
-	start1 = move;
-	while (move != NULL) {
+	Move *moves, *moves2;
+	i32 count = GenerateAllMoves(&moves);
+	for (Move *move = moves; move < moves + count; move++) {
 		ASSERT2(IsMovePossible(move), "AB: move 1 not possible");
 		ExecuteMove(move);
 		i32 plVal = player * value;
 		if (plVal == WIN) {
 			max = WIN;
-			if (best1 != move) {	// do not cut a branch under you
-				if (best1 != null) {
-					FreeMove(best1);					
-				}
-				
-				best1 = move;
-			}
-			if (best2 != null) {
-				FreeMove(best2);
-				best2 = null;
-			}
+			best1 = *move;
+			best2.from = NO_MOVE;
 			//pruning
 			alpha = WIN;
 			pruned = true;
 			RevertLastMove();
-			DBG(prunedCount++);
+			TCUTOFF(move == moves);
 			DPRINT2("pruned, d = 1 or win alpha %d, beta %d", alpha, beta);
-			do {
-				tmp = move;
-				move = move->next;
-				if (tmp != best1)
-					FreeMove(tmp);
-			} while (move != NULL);
 			break;
 		}
 		else if (depth == 1) {
 			searchedNodes++;
 			i32 val = 0;
-			val = player * (materialValue + StaticValue());
+			val = player * CachedStaticValue();
 			if (val > max) {
 				max = val;
-				if (best1 != move) {	// do not cut a branch under you
-					if (best1 != null) {
-						FreeMove(best1);
-					}
-					best1 = move;
-				}
+				best1 = *move;
 			}
 			if (val > alpha) {
 				alpha = val;
 				if (alpha >= beta) {
 					pruned = true;
 					RevertLastMove();
-					DBG(prunedCount++);
-					do {
-						tmp = move;
-						move = move->next;
-						if (tmp != best1)
-							FreeMove(tmp);
-					} while (move != NULL);
+					TCUTOFF(move == moves);
 					break;
 				}
 			}
 		} else {
-			GenerateAllMoves(&move2);
-			start2 = move2;
-			
-			while (move2 != NULL) {
+			i32 count2 = GenerateAllMoves(&moves2);
+			for (Move *move2 = moves2; move2 < moves2 + count2; move2++) {
 				ASSERT2(IsMovePossible(move2), "AB: move 2 not possible");
 				ExecuteMove(move2);
 				moveCount++;
-				Move *tm1 = null, *tm2 = null;
+				Move tm1, tm2;
 				val = -AlphaBetaMO(depth - 2, -beta, -alpha, &tm1, &tm2);
 				RevertLastMove();
+				if (searchAborted) {
+					RevertLastMove();
+					return 0;
+				}
 				if (val > max) {
 					max = val;
-					if (best1 != move) {	// do not cut a branch under you
-						if (best1 != null) {
-							FreeMove(best1);
-							
-						}
-						best1 = move;
-					}
-					if (best2 != null)
-						FreeMove(best2);
-					
-					best2 = move2;
+					best1 = *move;
+					best2 = *move2;
+					if (depth == currDepth)
+						SaveRootBest(&best1, &best2, max, false);
 				}
 				if (val > alpha) {
 					alpha = val;
 					if (alpha >= beta) {
 						pruned = true;
-						DBG(prunedCount++);
+						TCUTOFF(moveCount == 1);
 						DPRINT2("pruned, alpha %d, beta %d", alpha, beta);
-						do {
-							tmp = move2;
-							move2 = move2->next;
-							if (best2 != tmp)
-								FreeMove(tmp);
-						} while (move2 != NULL);
 						break;
 					}
 				}
-				tmp = move2;
-				move2 = move2->next;
-				if (tmp != best2)
-					FreeMove(tmp);
-				
 			}
 		}
 		RevertLastMove();
 		if (pruned) {
 			DPRINT2("pruned");
-			do {
-				tmp = move;
-				move = move->next;
-				if (tmp != best1)
-					FreeMove(tmp);
-			} while (move != NULL);
 			break;//DPRINT2("done del best 1");
 		}
-		tmp = move;
-		move = move->next;
-		if (tmp != best1)
-			FreeMove(tmp);
 	}
 	
 	ASSERT2(max > -WIN - 1, "AB: too low max %d", max);
@@ -986,37 +1133,51 @@ i32 AlphaBetaPVMORandom(i32 depth, i32 randomMargin)
 	ASSERT2(depth == currDepth, "alfa-beta RANDOM PVMO not in top level of search");
 	ASSERT2(depth > 1, "random alfa-beta should have depth > 1");
 	searchedNodes++;
+	if (SEARCH_ABORTED())
+		return 0;
 	i32 moveCount = 0, initSearchedNodes = searchedNodes;
 	i32 val, max = -WIN - 1;
 	moveNumber = 1;
-	Move *move, *move2, *start1, *start2;
+	Move *moves, *moves2;
 	FullMovesList *allMoves = null;
-	GenerateAllMovesSortedMove1(&move);
-	start1 = move;
-	while (move != NULL) {
-		ExecuteMove(move);
-		GenerateAllMovesSortedMove2(&move2);
-		start2 = move2;
-		while (move2 != NULL) {
-			ExecuteMove(move2);
-			moveCount++;
-			val = -AlphaBetaPVMO(depth - 2, -WIN, -max + randomMargin + 1);
-			if (val >= max - randomMargin) {
-				FullMovesList *nMove = MALLOC(FullMovesList);
-				nMove->move1 = move;
-				nMove->move2 = move2;
-				nMove->value = val;
-				nMove->next = allMoves;
-				allMoves = nMove;
+	if (CanSplitRoot()) {	// workers search the root children too
+		SplitRandomRoot(depth, randomMargin, false, &max, &allMoves, &moveCount);
+	} else {
+		i32 count = GenerateAllMovesSortedMove1(&moves);
+		for (Move *move = moves; move < moves + count; move++) {
+			ExecuteMove(move);
+			i32 count2 = GenerateAllMovesSortedMove2(&moves2);
+			for (Move *move2 = moves2; move2 < moves2 + count2; move2++) {
+				ExecuteMove(move2);
+				moveCount++;
+				val = -AlphaBetaPVMO(depth - 2, -WIN, -max + randomMargin + 1);
+				if (val >= max - randomMargin) {
+					FullMovesList *nMove = MALLOC(FullMovesList);
+					nMove->move1 = *move;
+					nMove->move2 = *move2;
+					nMove->value = val;
+					nMove->next = allMoves;
+					allMoves = nMove;
+				}
+				RevertLastMove();
+				if (searchAborted)
+					break;
+				if (val > max) {
+					max = val;
+				}
 			}
 			RevertLastMove();
-			if (val > max) {
-				max = val;
-			}
-			move2 = move2->next;
+			if (searchAborted)
+				break;
 		}
-		RevertLastMove();
-		move = move->next;
+	}
+	if (searchAborted) {
+		while (allMoves != null) {
+			FullMovesList *next = allMoves->next;
+			free(allMoves);
+			allMoves = next;
+		}
+		return 0;
 	}
 	DPRINT2("random selecting started");
 	i32 goodEnoughMoves = 0;
@@ -1027,35 +1188,28 @@ i32 AlphaBetaPVMORandom(i32 depth, i32 randomMargin)
 		curr = curr->next;
 	}
 	ASSERT2(goodEnoughMoves > 0, "there are no moves for random choice!");
-	srand(time(null));
+	srand(randomSeed > 0 ? randomSeed : (u32) time(null));
 	i32 selectedMove = rand() % goodEnoughMoves;
 	DPRINT("found %d good moves, selected random move: %d", goodEnoughMoves, selectedMove);
 	curr = allMoves;
 	i32 i = 0;
 	while (curr != null) {
 		if (curr->value >= max - randomMargin) {
-			if (i == selectedMove) {
+			if (i == selectedMove)
 				selected = curr;
-			} else {
-				FreeMove(curr->move2);
-				if ((curr->next == null || curr->next->move1 != curr->move1)
-				    && (selected == null || curr->move1 != selected->move1))
-					FreeMove(curr->move1);
-				
-			}
 			i++;
-		} else {
-			FreeMove(curr->move2);
-			if ((curr->next == null || curr->next->move1 != curr->move1)
-			    && (selected == null || curr->move1 != selected->move1))
-				FreeMove(curr->move1);
 		}
 		curr = curr->next;
 	}
 	DPRINT2("move count on top level: %d", moveCount);
 	ASSERT2(selected != null, "random select == null");
 	DPRINT("max value: %d, selected move value: %d", max, selected->value);
-	AddPositionToTT(max, EXACT_VALUE, depth, searchedNodes - initSearchedNodes, selected->move1, selected->move2);	//because of retrieving in GetBestMove; it's called only once
+	AddPositionToTT(max, EXACT_VALUE, depth, searchedNodes - initSearchedNodes, &selected->move1, &selected->move2);	//because of retrieving in GetBestMove; it's called only once
+	while (allMoves != null) {
+		curr = allMoves;
+		allMoves = allMoves->next;
+		free(curr);
+	}
 	return max;
 }
 
@@ -1066,35 +1220,35 @@ i32 AlphaBetaPVMONegascout(i32 depth, i32 alpha, i32 beta)
 	ASSERT2(depth >= 0, "depth < 0");
 	ASSERT2(moveNumber == 1, "AB starting: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 	searchedNodes++;
+	if (SEARCH_ABORTED())
+		return 0;
 	if (abs(value) == WIN) {
 		return player * value;
 	}
 	ASSERT2(!IsEndOfGame(), "AB end of game, val %d, depth %d", value, depth);
-	if (depth == 0) {
-		i32 v = materialValue + StaticValue();
-		return player * v;
-	}
+	if (depth == 0)
+		return LeafValue(alpha, beta);
 	i32 initSearchedNodes = searchedNodes;
-	i32 ttType = LOWER_BOUND;
+	i32 ttType = UPPER_BOUND;
 	i32 moveCount = 0;
-	Move *best1 = null, *best2 = null;
+	Move best1, best2;	// copies, the lists of moves are overwritten by generating in next iterations
+	best1.from = best2.from = NO_MOVE;
 	i32 val, max = -WIN - 1;
 	moveNumber = 1;
-	TTEntry *saved = LookupPositionInTT();
+	TTEntry savedEntry;
+	TTEntry *saved = LookupPositionInTT(&savedEntry);
 	if (saved != null) {
-		ASSERT2(saved->bestMove1 != null, "saved->bestMove1 == null");
-		if ((saved->bestMove1 != null && !IsMovePossible(saved->bestMove1))
-		    || (saved->bestMove1 != null && !IsMovePossible(saved->bestMove1))) {
+		ASSERT2(saved->bestMove1.from != NO_MOVE, "saved->bestMove1 not set");
+		if (saved->bestMove1.from != NO_MOVE && !IsMovePossible(&saved->bestMove1)) {
 			saved = null;
 			DPRINT("HashCollision");
 			DBG(ttCollision++);
 		}
 	}
 	if (saved != null) {
-		DBG(ttFound++);
 		if (saved->searchDepth >= depth) {
-			DBG(ttHit++);
 			if (saved->valueType == EXACT_VALUE) {
+				TCOUNT(ttCutoffs);
 				ASSERT2(moveNumber == 1, "AB ret 1: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 				return saved->value;
 			} else if (saved->valueType == LOWER_BOUND && saved->value > alpha) {	//update lowerbound if needed
@@ -1104,27 +1258,28 @@ i32 AlphaBetaPVMONegascout(i32 depth, i32 alpha, i32 beta)
 			}
 			if (alpha >= beta) {
 				DPRINT2("pruned by TT values search depth %d, depth %d", saved->searchDepth, depth);
-				DBG(prunedCount++);
+				TCOUNT(ttCutoffs);
 				ASSERT2(moveNumber == 1, "AB ret 2: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 				return saved->value;
 			}
 		}
-		Move *pv1 = saved->bestMove1;
-		Move *pv2 = saved->bestMove2;
-		if (depth == 1 || pv2 == null) {
-			ExecuteMove(pv1);
+		Move pv1 = saved->bestMove1;	// copies because of TT kicks
+		Move pv2 = saved->bestMove2;
+		if (depth == 1 || pv2.from == NO_MOVE) {
+			ExecuteMove(&pv1);
 			i32 plVal = player * value;
 			if (depth == 1 || plVal == WIN) {
 				if (plVal == WIN)
 					max = plVal;
 				else
-					max = player * (materialValue + StaticValue());
-				best1 = CloneMove(pv1);
+					max = LeafValueAfterMove1(alpha, beta);
+				best1 = pv1;
 				if (max > alpha) {
 					alpha = max;
 					if (alpha >= beta) {
 						RevertLastMove();
-						DBG(prunedCount++);
+						TCUTOFF(true);
+						SaveKillerMoves(&pv1, null);
 						ASSERT2(moveNumber == 1, "AB ret 3: bad moveNumber turnNumber %d, moveNumber %d",
 							turnNumber, moveNumber);
 						return max;
@@ -1132,20 +1287,23 @@ i32 AlphaBetaPVMONegascout(i32 depth, i32 alpha, i32 beta)
 				}
 			}
 			RevertLastMove();
-		} else if (pv2 != null) {
-			pv1 = CloneMove(pv1);	//because of TT kicks
-			pv2 = CloneMove(pv2);
-			ExecuteMove(pv1);
-			ExecuteMove(pv2);
+		} else {
+			ExecuteMove(&pv1);
+			ExecuteMove(&pv2);
 			max = -AlphaBetaPVMONegascout(depth - 2, -beta, -alpha);
 			RevertLastMove();
 			RevertLastMove();
+			if (searchAborted)
+				return 0;
 			best1 = pv1;
 			best2 = pv2;
+			if (depth == currDepth)
+				SaveRootBest(&best1, &best2, max, true);
 			if (max > alpha) {
 				alpha = max;
 				if (alpha >= beta) {
-					DBG(prunedCount++);
+					TCUTOFF(true);
+					SaveKillerMoves(&pv1, &pv2);
 					ASSERT2(moveNumber == 1, "AB ret 4: bad moveNumber turnNumber %d, moveNumber %d", turnNumber,
 						moveNumber);
 					return max;	//no need to save anything to TT
@@ -1156,52 +1314,31 @@ i32 AlphaBetaPVMONegascout(i32 depth, i32 alpha, i32 beta)
 	}
 	bool pruned = false;
 	i32 beta2 = beta;	// negascout
-	Move *tmp, *move, *move2, *start1, *start2;
-	GenerateAllMovesSortedMove1(&move);
-	start1 = move;
-	while (move != NULL) {
+	Move *moves, *moves2;
+	i32 count = GenerateAllMovesSortedMove1(&moves);
+	for (Move *move = moves; move < moves + count; move++) {
 		ASSERT2(IsMovePossible(move), "AB: move 1 not possible");
 		ExecuteMove(move);
 		i32 plVal = player * value;
 		if (plVal == WIN) {
 			max = WIN;
-			if (best1 != move) {	// do not cut a branch under you
-				if (best1 != null) {
-					FreeMove(best1);
-					
-				}
-				best1 = move;
-			}
-			if (best2 != null) {
-				FreeMove(best2);
-				best2 = null;
-			}
+			best1 = *move;
+			best2.from = NO_MOVE;
 			//pruning
 			alpha = WIN;
 			pruned = true;
 			RevertLastMove();
-			DBG(prunedCount++);
+			TCUTOFF(move == moves && saved == null);
+			SaveKillerMoves(&best1, null);
 			DPRINT2("pruned, d = 1 or win alpha %d, beta %d", alpha, beta);
-			do {
-				tmp = move;
-				move = move->next;
-				if (tmp != best1)
-					FreeMove(tmp);
-			} while (move != NULL);
-			ttType = UPPER_BOUND;
+			ttType = LOWER_BOUND;
 			break;
 		} else if (depth == 1) {
 			searchedNodes++;
-			i32 val = 0;
-			val = player * (materialValue + StaticValue());
+			i32 val = LeafValueAfterMove1(alpha, beta);
 			if (val > max) {
 				max = val;
-				if (best1 != move) {	// do not cut a branch under you
-					if (best1 != null) {
-						FreeMove(best1);
-					}
-					best1 = move;
-				}
+				best1 = *move;
 			}
 			if (val > alpha) {
 				alpha = val;
@@ -1209,23 +1346,16 @@ i32 AlphaBetaPVMONegascout(i32 depth, i32 alpha, i32 beta)
 				if (alpha >= beta) {
 					pruned = true;
 					RevertLastMove();
-					DBG(prunedCount++);
+					TCUTOFF(move == moves && saved == null);
+					SaveKillerMoves(&best1, null);
 					DPRINT2("pruned, d = 1");
-					do {
-						tmp = move;
-						move = move->next;
-						if (tmp != best1)
-							FreeMove(tmp);
-					} while (move != NULL);
-					ttType = UPPER_BOUND;
+					ttType = LOWER_BOUND;
 					break;
 				}
 			}
 		} else {
-			GenerateAllMovesSortedMove2(&move2);
-			
-			start2 = move2;
-			while (move2 != NULL) {
+			i32 count2 = GenerateAllMovesSortedMove2(&moves2);
+			for (Move *move2 = moves2; move2 < moves2 + count2; move2++) {
 				ASSERT2(IsMovePossible(move2), "AB: move 2 not possible");
 				ExecuteMove(move2);
 				moveCount++;
@@ -1237,64 +1367,42 @@ i32 AlphaBetaPVMONegascout(i32 depth, i32 alpha, i32 beta)
 					val = -AlphaBetaPVMONegascout(depth - 2, -beta, -alpha);
 				RevertLastMove();
 				DPRINT2("rev move 2");
+				if (searchAborted) {
+					RevertLastMove();
+					return 0;
+				}
 				if (val > max) {
 					max = val;
-					if (best1 != move) {	// do not cut a branch under you
-						if (best1 != null) {
-							FreeMove(best1);
-						}
-						best1 = move;
-					}
-					if (best2 != null)
-						FreeMove(best2);
-					
-					best2 = move2;
+					best1 = *move;
+					best2 = *move2;
+					if (depth == currDepth)
+						SaveRootBest(&best1, &best2, max, false);
 				}
 				if (val > alpha) {
 					alpha = val;
 					if (alpha >= beta) {
 						pruned = true;
-						DBG(prunedCount++);
+						TCUTOFF(moveCount == 1 && saved == null);
+						SaveKillerMoves(&best1, &best2);
 						DPRINT2("pruned, alpha %d, beta %d", alpha, beta);
-						do {
-							tmp = move2;
-							move2 = move2->next;
-							if (best2 != tmp)
-								FreeMove(tmp);
-						} while (move2 != NULL);
-						ttType = UPPER_BOUND;
+						ttType = LOWER_BOUND;
 						break;
 					}
 					ttType = EXACT_VALUE;
 				}
 				beta2 = alpha + 1;	//negascout
-				tmp = move2;
-				move2 = move2->next;
-				if (tmp != best2)
-					FreeMove(tmp);
-				
 			}
 		}
 		RevertLastMove();
 		if (pruned) {
 			DPRINT2("pruned");
-			do {
-				tmp = move;
-				move = move->next;
-				if (tmp != best1)
-					FreeMove(tmp);
-			} while (move != NULL);
 			break;
 		}
-		tmp = move;
-		move = move->next;
-		if (tmp != best1)
-			FreeMove(tmp);
 	}
 	
 	ASSERT2(max > -WIN - 1, "AB: too low max %d", max);
 	DPRINT2("abPVMO END - depth %d, alpha %d, beta %d, searched %d", depth, alpha, beta, searchedNodes);
-	AddPositionToTT(max, ttType, depth, searchedNodes - initSearchedNodes, best1, best2);
+	AddPositionToTT(max, ttType, depth, searchedNodes - initSearchedNodes, &best1, &best2);
 	ASSERT2(moveNumber == 1, "bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 	return max;
 }
@@ -1306,35 +1414,35 @@ i32 AlphaBetaPVMOHistory(i32 depth, i32 alpha, i32 beta)
 	ASSERT2(depth >= 0, "depth < 0");
 	ASSERT2(moveNumber == 1, "AB starting: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 	searchedNodes++;
+	if (SEARCH_ABORTED())
+		return 0;
 	if (abs(value) == WIN) {
 		return player * value;
 	}
 	ASSERT2(!IsEndOfGame(), "AB end of game, val %d, depth %d", value, depth);
-	if (depth == 0) {
-		i32 v = materialValue + StaticValue();
-		return player * v;
-	}
+	if (depth == 0)
+		return LeafValue(alpha, beta);
 	i32 initSearchedNodes = searchedNodes;
-	i32 ttType = LOWER_BOUND;
+	i32 ttType = UPPER_BOUND;
 	i32 moveCount = 0;
-	Move *best1 = null, *best2 = null;
+	Move best1, best2;	// copies, the lists of moves are overwritten by generating in next iterations
+	best1.from = best2.from = NO_MOVE;
 	i32 val, max = -WIN - 1;
 	moveNumber = 1;
-	TTEntry *saved = LookupPositionInTT();
+	TTEntry savedEntry;
+	TTEntry *saved = LookupPositionInTT(&savedEntry);
 	if (saved != null) {
-		ASSERT2(saved->bestMove1 != null, "saved->bestMove1 == null");
-		if ((saved->bestMove1 != null && !IsMovePossible(saved->bestMove1))
-		    || (saved->bestMove1 != null && !IsMovePossible(saved->bestMove1))) {
+		ASSERT2(saved->bestMove1.from != NO_MOVE, "saved->bestMove1 not set");
+		if (saved->bestMove1.from != NO_MOVE && !IsMovePossible(&saved->bestMove1)) {
 			saved = null;
 			DPRINT("HashCollision");
 			DBG(ttCollision++);
 		}
 	}
 	if (saved != null) {
-		DBG(ttFound++);
 		if (saved->searchDepth >= depth) {
-			DBG(ttHit++);
 			if (saved->valueType == EXACT_VALUE) {
+				TCOUNT(ttCutoffs);
 				ASSERT2(moveNumber == 1, "AB ret 1: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 				return saved->value;
 			} else if (saved->valueType == LOWER_BOUND && saved->value > alpha) {	//update lowerbound if needed
@@ -1344,52 +1452,56 @@ i32 AlphaBetaPVMOHistory(i32 depth, i32 alpha, i32 beta)
 			}
 			if (alpha >= beta) {
 				DPRINT2("pruned by TT values search depth %d, depth %d", saved->searchDepth, depth);
-				DBG(prunedCount++);
+				TCOUNT(ttCutoffs);
 				ASSERT2(moveNumber == 1, "AB ret 2: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 				return saved->value;
 			}
 		}
-		Move *pv1 = saved->bestMove1;
-		Move *pv2 = saved->bestMove2;
-		if (depth == 1 || pv2 == null) {
-			ExecuteMove(pv1);
+		Move pv1 = saved->bestMove1;	// copies because of TT kicks
+		Move pv2 = saved->bestMove2;
+		if (depth == 1 || pv2.from == NO_MOVE) {
+			ExecuteMove(&pv1);
 			i32 plVal = player * value;
 			if (depth == 1 || plVal == WIN) {
 				if (plVal == WIN)
 					max = plVal;
 				else
-					max = player * (materialValue + StaticValue());
-				best1 = CloneMove(pv1);
+					max = LeafValueAfterMove1(alpha, beta);
+				best1 = pv1;
 				if (max > alpha) {
 					alpha = max;
 					if (alpha >= beta) {
 						RevertLastMove();
-						DBG(prunedCount++);
+						TCUTOFF(true);
+						SaveKillerMoves(&pv1, null);
 						ASSERT2(moveNumber == 1, "AB ret 3: bad moveNumber turnNumber %d, moveNumber %d",
 							turnNumber, moveNumber);
-						historyPruneMoves[pv1->from][pv1->to] += 1 << depth;
+						historyPruneMoves[pv1.from][pv1.to] += 1 << depth;
 						return max;
 					}
 				}
 			}
 			RevertLastMove();
-		} else if (pv2 != null) {
-			pv1 = CloneMove(pv1);	//because of TT kicks
-			pv2 = CloneMove(pv2);
-			ExecuteMove(pv1);
-			ExecuteMove(pv2);
+		} else {
+			ExecuteMove(&pv1);
+			ExecuteMove(&pv2);
 			max = -AlphaBetaPVMOHistory(depth - 2, -beta, -alpha);
 			RevertLastMove();
 			RevertLastMove();
+			if (searchAborted)
+				return 0;
 			best1 = pv1;
 			best2 = pv2;
+			if (depth == currDepth)
+				SaveRootBest(&best1, &best2, max, true);
 			if (max > alpha) {
 				alpha = max;
 				if (alpha >= beta) {
-					DBG(prunedCount++);
+					TCUTOFF(true);
+					SaveKillerMoves(&pv1, &pv2);
 					ASSERT2(moveNumber == 1, "AB ret 4: bad moveNumber turnNumber %d, moveNumber %d", turnNumber,
 						moveNumber);
-					historyPruneMoves[pv1->from][pv1->to] += 1 << depth;
+					historyPruneMoves[pv1.from][pv1.to] += 1 << depth;
 					return max;	//no need to save anything to TT
 				}
 				ttType = EXACT_VALUE;
@@ -1398,57 +1510,36 @@ i32 AlphaBetaPVMOHistory(i32 depth, i32 alpha, i32 beta)
 		}
 	}
 	bool pruned = false;
-	Move *tmp, *move, *move2, *start1, *start2;
-	GenerateAllMovesSortedMove1(&move);
-	
-	start1 = move;
-	while (move != NULL) {
+	Move *moves, *moves2;
+	i32 count = GenerateAllMovesSortedMove1(&moves);
+	for (Move *move = moves; move < moves + count; move++) {
 		ASSERT2(IsMovePossible(move), "AB: move 1 not possible");
 		ExecuteMove(move);
 		DPRINT2("exec move 1, depth %d", depth);
 		i32 plVal = player * value;
 		if (plVal == WIN) {
 			max = WIN;
-			if (best1 != move) {	// do not cut a branch under you
-				if (best1 != null) {
-					FreeMove(best1);
-				}
-				best1 = move;
-			}
-			if (best2 != null) {
-				FreeMove(best2);
-				best2 = null;
-			}
+			best1 = *move;
+			best2.from = NO_MOVE;
 			
 			//pruning
 			alpha = WIN;
 			pruned = true;
 			RevertLastMove();
-			DBG(prunedCount++);
+			TCUTOFF(move == moves && saved == null);
+			SaveKillerMoves(&best1, null);
 			DPRINT2("pruned, d = 1 or win alpha %d, beta %d", alpha, beta);
-			do {
-				tmp = move;
-				move = move->next;
-				if (tmp != best1)
-					FreeMove(tmp);
-			} while (move != NULL);
-			ttType = UPPER_BOUND;
-			historyPruneMoves[best1->from][best1->to] += 1 << depth;
+			ttType = LOWER_BOUND;
+			historyPruneMoves[best1.from][best1.to] += 1 << depth;
 			
 			break;
 		}
 		else if (depth == 1) {
 			searchedNodes++;
-			i32 val = 0;
-			val = player * (materialValue + StaticValue());
+			i32 val = LeafValueAfterMove1(alpha, beta);
 			if (val > max) {
 				max = val;
-				if (best1 != move) {	// do not cut a branch under you
-					if (best1 != null) {
-						FreeMove(best1);
-					}
-					best1 = move;
-				}
+				best1 = *move;
 			}
 			if (val > alpha) {
 				alpha = val;
@@ -1456,25 +1547,18 @@ i32 AlphaBetaPVMOHistory(i32 depth, i32 alpha, i32 beta)
 				if (alpha >= beta) {
 					pruned = true;
 					RevertLastMove();
-					DBG(prunedCount++);
+					TCUTOFF(move == moves && saved == null);
+					SaveKillerMoves(&best1, null);
 					DPRINT2("pruned, d = 1");
-					do {
-						tmp = move;
-						move = move->next;
-						if (tmp != best1)
-							FreeMove(tmp);
-					} while (move != NULL);
-					ttType = UPPER_BOUND;
-					historyPruneMoves[best1->from][best1->to] += 1 << depth;
+					ttType = LOWER_BOUND;
+					historyPruneMoves[best1.from][best1.to] += 1 << depth;
 					
 					break;
 				}
 			}
 		} else {
-			GenerateAllMovesSortedMove2(&move2);
-			
-			start2 = move2;
-			while (move2 != NULL) {
+			i32 count2 = GenerateAllMovesSortedMove2(&moves2);
+			for (Move *move2 = moves2; move2 < moves2 + count2; move2++) {
 				DPRINT2("start exec move 2");
 				ASSERT2(IsMovePossible(move2), "AB: move 2 not possible");
 				ExecuteMove(move2);
@@ -1483,65 +1567,43 @@ i32 AlphaBetaPVMOHistory(i32 depth, i32 alpha, i32 beta)
 				val = -AlphaBetaPVMOHistory(depth - 2, -beta, -alpha);
 				RevertLastMove();
 				DPRINT2("rev move 2");
+				if (searchAborted) {
+					RevertLastMove();
+					return 0;
+				}
 				if (val > max) {
 					max = val;
-					if (best1 != move) {	// do not cut a branch under you
-						if (best1 != null) {
-							FreeMove(best1);
-						}
-						best1 = move;
-					}
-					if (best2 != null)
-						FreeMove(best2);
-					
-					best2 = move2;
+					best1 = *move;
+					best2 = *move2;
+					if (depth == currDepth)
+						SaveRootBest(&best1, &best2, max, false);
 				}
 				if (val > alpha) {
 					alpha = val;
 					if (alpha >= beta) {
 						pruned = true;
-						DBG(prunedCount++);
+						TCUTOFF(moveCount == 1 && saved == null);
+						SaveKillerMoves(&best1, &best2);
 						DPRINT2("pruned, alpha %d, beta %d", alpha, beta);
-						do {
-							tmp = move2;
-							move2 = move2->next;
-							if (best2 != tmp)
-								FreeMove(tmp);
-						} while (move2 != NULL);
-						ttType = UPPER_BOUND;
+						ttType = LOWER_BOUND;
 						
-						historyPruneMoves[best1->from][best1->to] += 1 << depth;
+						historyPruneMoves[best1.from][best1.to] += 1 << depth;
 						
 						break;
 					}
 					ttType = EXACT_VALUE;
 				}
-				tmp = move2;
-				move2 = move2->next;
-				if (tmp != best2)
-					FreeMove(tmp);
-				
 			}
 		}
 		RevertLastMove();
 		if (pruned) {
-			do {
-				tmp = move;
-				move = move->next;
-				if (tmp != best1)
-					FreeMove(tmp);
-			} while (move != NULL);
 			break;
 		}
-		tmp = move;
-		move = move->next;
-		if (tmp != best1)
-			FreeMove(tmp);
 	}
 	
 	ASSERT2(max > -WIN - 1, "AB: too low max %d", max);
 	DPRINT2("abPVMO END - depth %d, alpha %d, beta %d, searched %d", depth, alpha, beta, searchedNodes);
-	AddPositionToTT(max, ttType, depth, searchedNodes - initSearchedNodes, best1, best2);
+	AddPositionToTT(max, ttType, depth, searchedNodes - initSearchedNodes, &best1, &best2);
 	ASSERT2(moveNumber == 1, "bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 	return max;
 }
@@ -1554,36 +1616,36 @@ i32 AlphaBetaPVMOHistoryNegascout(i32 depth, i32 alpha, i32 beta)
 	ASSERT2(depth >= 0, "depth < 0");
 	ASSERT2(moveNumber == 1, "AB starting: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 	searchedNodes++;
+	if (SEARCH_ABORTED())
+		return 0;
 	if (abs(value) == WIN) {
 		return player * value;
 	}
 	ASSERT2(!IsEndOfGame(), "AB end of game, val %d, depth %d", value, depth);
-	if (depth == 0) {
-		i32 v = materialValue + StaticValue();
-		return player * v;
-	}
+	if (depth == 0)
+		return LeafValue(alpha, beta);
 	i32 initSearchedNodes = searchedNodes;
-	i32 ttType = LOWER_BOUND;
+	i32 ttType = UPPER_BOUND;
 	i32 moveCount = 0;
-	Move *best1 = null, *best2 = null;
+	Move best1, best2;	// copies, the lists of moves are overwritten by generating in next iterations
+	best1.from = best2.from = NO_MOVE;
 	i32 val, max = -WIN - 1;
 	moveNumber = 1;
-	TTEntry *saved = LookupPositionInTT();
+	TTEntry savedEntry;
+	TTEntry *saved = LookupPositionInTT(&savedEntry);
 	//i32 beta2 = -WIN-2;//negascout
 	if (saved != null) {
-		ASSERT2(saved->bestMove1 != null, "saved->bestMove1 == null");
-		if ((saved->bestMove1 != null && !IsMovePossible(saved->bestMove1))
-		    || (saved->bestMove1 != null && !IsMovePossible(saved->bestMove1))) {
+		ASSERT2(saved->bestMove1.from != NO_MOVE, "saved->bestMove1 not set");
+		if (saved->bestMove1.from != NO_MOVE && !IsMovePossible(&saved->bestMove1)) {
 			saved = null;
 			DPRINT("HashCollision");
 			DBG(ttCollision++);
 		}
 	}
 	if (saved != null) {
-		DBG(ttFound++);
 		if (saved->searchDepth >= depth) {
-			DBG(ttHit++);
 			if (saved->valueType == EXACT_VALUE) {
+				TCOUNT(ttCutoffs);
 				ASSERT2(moveNumber == 1, "AB ret 1: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 				return saved->value;
 			} else if (saved->valueType == LOWER_BOUND && saved->value > alpha) {	//update lowerbound if needed
@@ -1593,53 +1655,57 @@ i32 AlphaBetaPVMOHistoryNegascout(i32 depth, i32 alpha, i32 beta)
 			}
 			if (alpha >= beta) {
 				DPRINT2("pruned by TT values search depth %d, depth %d", saved->searchDepth, depth);
-				DBG(prunedCount++);
+				TCOUNT(ttCutoffs);
 				ASSERT2(moveNumber == 1, "AB ret 2: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 				return saved->value;
 			}
 		}
-		Move *pv1 = saved->bestMove1;
-		Move *pv2 = saved->bestMove2;
-		if (depth == 1 || pv2 == null) {
-			ExecuteMove(pv1);
+		Move pv1 = saved->bestMove1;	// copies because of TT kicks
+		Move pv2 = saved->bestMove2;
+		if (depth == 1 || pv2.from == NO_MOVE) {
+			ExecuteMove(&pv1);
 			i32 plVal = player * value;
 			if (depth == 1 || plVal == WIN) {
 				if (plVal == WIN)
 					max = plVal;
 				else
-					max = player * (materialValue + StaticValue());
-				best1 = CloneMove(pv1);
+					max = LeafValueAfterMove1(alpha, beta);
+				best1 = pv1;
 				if (max > alpha) {
 					alpha = max;
 					if (alpha >= beta) {
 						RevertLastMove();
 						DPRINT2("pruned by pv move, d = 1, alpha %d, beta %d", alpha, beta);
-						DBG(prunedCount++);
+						TCUTOFF(true);
+						SaveKillerMoves(&pv1, null);
 						ASSERT2(moveNumber == 1, "AB ret 3: bad moveNumber turnNumber %d, moveNumber %d",
 							turnNumber, moveNumber);
-						historyPruneMoves[pv1->from][pv1->to] += 1 << depth;
+						historyPruneMoves[pv1.from][pv1.to] += 1 << depth;
 						return max;
 					}
 				}
 			}
 			RevertLastMove();
-		} else if (pv2 != null) {
-			pv1 = CloneMove(pv1);	//because of TT kicks
-			pv2 = CloneMove(pv2);
-			ExecuteMove(pv1);
-			ExecuteMove(pv2);
+		} else {
+			ExecuteMove(&pv1);
+			ExecuteMove(&pv2);
 			max = -AlphaBetaPVMOHistoryNegascout(depth - 2, -beta, -alpha);
 			RevertLastMove();
 			RevertLastMove();
+			if (searchAborted)
+				return 0;
 			best1 = pv1;
 			best2 = pv2;
+			if (depth == currDepth)
+				SaveRootBest(&best1, &best2, max, true);
 			if (max > alpha) {
 				alpha = max;
 				if (alpha >= beta) {
-					DBG(prunedCount++);
+					TCUTOFF(true);
+					SaveKillerMoves(&pv1, &pv2);
 					ASSERT2(moveNumber == 1, "AB ret 4: bad moveNumber turnNumber %d, moveNumber %d", turnNumber,
 						moveNumber);
-					historyPruneMoves[pv1->from][pv1->to] += 1 << depth;
+					historyPruneMoves[pv1.from][pv1.to] += 1 << depth;
 					return max;	//no need to save anything to TT
 				}
 				ttType = EXACT_VALUE;
@@ -1648,55 +1714,34 @@ i32 AlphaBetaPVMOHistoryNegascout(i32 depth, i32 alpha, i32 beta)
 	}
 	bool pruned = false;
 	i32 beta2 = beta;
-	Move *tmp, *move, *move2, *start1, *start2;
-	GenerateAllMovesSortedMove1(&move);
-	
-	start1 = move;
-	while (move != NULL) {
+	Move *moves, *moves2;
+	i32 count = GenerateAllMovesSortedMove1(&moves);
+	for (Move *move = moves; move < moves + count; move++) {
 		ASSERT2(IsMovePossible(move), "AB: move 1 not possible");
 		ExecuteMove(move);
 		DPRINT2("exec move 1, depth %d", depth);
 		i32 plVal = player * value;
 		if (plVal == WIN) {
 			max = WIN;
-			if (best1 != move) {	// do not cut a branch under you
-				if (best1 != null) {
-					FreeMove(best1);
-				}
-				best1 = move;
-			}
-			if (best2 != null) {
-				FreeMove(best2);
-				best2 = null;
-			}
+			best1 = *move;
+			best2.from = NO_MOVE;
 			
 			//pruning
 			alpha = WIN;
 			pruned = true;
 			RevertLastMove();
-			DBG(prunedCount++);
+			TCUTOFF(move == moves && saved == null);
+			SaveKillerMoves(&best1, null);
 			DPRINT2("pruned, d = 1 or win alpha %d, beta %d", alpha, beta);
-			do {
-				tmp = move;
-				move = move->next;
-				if (tmp != best1)
-					FreeMove(tmp);
-			} while (move != NULL);
-			ttType = UPPER_BOUND;
-			historyPruneMoves[best1->from][best1->to] += 1 << depth;
+			ttType = LOWER_BOUND;
+			historyPruneMoves[best1.from][best1.to] += 1 << depth;
 			break;
 		} else if (depth == 1) {
 			searchedNodes++;
-			i32 val = 0;
-			val = player * (materialValue + StaticValue());
+			i32 val = LeafValueAfterMove1(alpha, beta);
 			if (val > max) {
 				max = val;
-				if (best1 != move) {	// do not cut a branch under you
-					if (best1 != null) {
-						FreeMove(best1);
-					}
-					best1 = move;
-				}
+				best1 = *move;
 			}
 			if (val > alpha) {
 				alpha = val;
@@ -1704,26 +1749,18 @@ i32 AlphaBetaPVMOHistoryNegascout(i32 depth, i32 alpha, i32 beta)
 				if (alpha >= beta) {
 					pruned = true;
 					RevertLastMove();
-					DBG(prunedCount++);
+					TCUTOFF(move == moves && saved == null);
+					SaveKillerMoves(&best1, null);
 					DPRINT2("pruned, d = 1");
-					do {
-						tmp = move;
-						move = move->next;
-						if (tmp != best1)
-							FreeMove(tmp);
-					} while (move != NULL);
-					ttType = UPPER_BOUND;
-					historyPruneMoves[best1->from][best1->to] += 1 << depth;
+					ttType = LOWER_BOUND;
+					historyPruneMoves[best1.from][best1.to] += 1 << depth;
 					
 					break;
 				}
 			}
 		} else {
-			GenerateAllMovesSortedMove2(&move2);
-			
-			start2 = move2;
-			
-			while (move2 != NULL) {
+			i32 count2 = GenerateAllMovesSortedMove2(&moves2);
+			for (Move *move2 = moves2; move2 < moves2 + count2; move2++) {
 				ASSERT2(IsMovePossible(move2), "AB: move 2 not possible");
 				ExecuteMove(move2);
 				moveCount++;
@@ -1734,83 +1771,566 @@ i32 AlphaBetaPVMOHistoryNegascout(i32 depth, i32 alpha, i32 beta)
 				} else
 					val = -AlphaBetaPVMOHistoryNegascout(depth - 2, -beta, -alpha);
 				RevertLastMove();
+				if (searchAborted) {
+					RevertLastMove();
+					return 0;
+				}
 				if (val > max) {
 					max = val;
-					if (best1 != move) {	// do not cut a branch under you
-						if (best1 != null) {
-							FreeMove(best1);
-						}
-						best1 = move;
-					}
-					if (best2 != null)
-						FreeMove(best2);
-					
-					best2 = move2;
+					best1 = *move;
+					best2 = *move2;
+					if (depth == currDepth)
+						SaveRootBest(&best1, &best2, max, false);
 				}
 				if (val > alpha) {
 					alpha = val;
 					if (alpha >= beta) {
 						pruned = true;
-						DBG(prunedCount++);
+						TCUTOFF(moveCount == 1 && saved == null);
+						SaveKillerMoves(&best1, &best2);
 						DPRINT2("pruned, alpha %d, beta %d", alpha, beta);
-						do {
-							tmp = move2;
-							move2 = move2->next;
-							if (best2 != tmp)
-								FreeMove(tmp);
-						} while (move2 != NULL);
-						ttType = UPPER_BOUND;
-						historyPruneMoves[best1->from][best1->to] += 1 << depth;
+						ttType = LOWER_BOUND;
+						historyPruneMoves[best1.from][best1.to] += 1 << depth;
 						
 						break;
 					}
 					ttType = EXACT_VALUE;
 				}
 				beta2 = alpha + 1;	//negascout
-				tmp = move2;
-				move2 = move2->next;
-				if (tmp != best2)
-					FreeMove(tmp);
-				
 			}
 		}
 		RevertLastMove();
 		if (pruned) {
 			DPRINT2("pruned");
-			do {
-				tmp = move;
-				move = move->next;
-				if (tmp != best1)
-					FreeMove(tmp);
-			} while (move != NULL);
 			break;
 		}
-		tmp = move;
-		move = move->next;
-		if (tmp != best1)
-			FreeMove(tmp);
 	}
 	
 	ASSERT2(max > -WIN - 1, "AB: too low max %d", max);
 	DPRINT2("abPVMO END - depth %d, alpha %d, beta %d, searched %d", depth, alpha, beta, searchedNodes);
-	AddPositionToTT(max, ttType, depth, searchedNodes - initSearchedNodes, best1, best2);
+	AddPositionToTT(max, ttType, depth, searchedNodes - initSearchedNodes, &best1, &best2);
 	ASSERT2(moveNumber == 1, "bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 	return max;
 }
 
-/// AlphaBeta with TT and Principal Variation Move and Move Ordering and beginner evaluation function
-i32 AlphaBetaPVMOBeginner(i32 depth, i32 alpha, i32 beta)
-{				//the only difference from AlphaBetaPVMO is calling StaticValueBeginner instead of StaticValue
-	DPRINT2("abPVMO beginner - depth %d, alpha %d, beta %d, searched %d", depth, alpha, beta, searchedNodes);
-	ASSERT2(depth >= 0, "depth < 0");
-	ASSERT2(moveNumber == 1, "AB starting: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
-	searchedNodes++;
-	if (abs(value) == WIN) {
-		DPRINT2("found win %d, pl %d, depth %d", value, player, depth);
-		return player * value;
-	}
-	ASSERT2(!IsEndOfGame(), "AB end of game, val %d, depth %d", value, depth);
-	if (depth == 0) {
+/// MTD(f) -- zero-window searches by AlphaBetaPVMOHistory starting at guess (the value of the previous iteration)
+/// until the lower and upper bounds of the value meet; TT keeps the bounds of positions between the passes.
+/// Values of iterations differ a lot, so the next test is moved by a step from the returned bound,
+/// the step is doubled while passes fail in the same direction.
+/// The best root moves are those of the last pass that failed high, a pass that fails low has no best moves.
+i32 MTDF(i32 depth, i32 guess)
+{
+	i32 lower = -WIN, upper = WIN, g = guess;
+	long long step = 0;	// negative after fail-lows
+	Move best1, best2;
+	bool found = false;
+	while (lower < upper) {
+		i32 beta = g == lower ? g + 1 : g;
+		rootBestFound = false;
+		g = AlphaBetaPVMOHistory(depth, beta - 1, beta);
+		TCOUNT(mtdfPasses);
+		if (searchAborted) {
+			rootBestFound = rootBestValid = false;	// the moves of the previous iteration are used
+			return 0;
+		}
+		DPRINT2("MTD(f) depth %d, beta %d, value %d", depth, beta, g);
+		i32 bound = g;
+		if (g < beta) {
+			upper = g;
+			step = step < 0 ? MAX(step * 2, -WIN) : -MTDF_STEP;
+		} else {
+			lower = g;
+			step = step > 0 ? MIN(step * 2, WIN) : MTDF_STEP;
+			TTEntry savedEntry;
+			TTEntry *saved = rootBestFound ? null : LookupPositionInTT(&savedEntry);
+			if (rootBestFound) {
+				best1 = rootBest1;
+				best2 = rootBest2;
+				found = true;
+			} else if (saved != null) {	// cut off by the root entry in TT
+				best1 = saved->bestMove1;
+				best2 = saved->bestMove2;
+				found = true;
+			}
+		}
+		g = (i32) MAX(lower, MIN(upper, bound + step));
+	}
+	if (found)
+		SaveRootBest(&best1, &best2, g, false);
+	else
+		rootBestFound = false;	// no pass failed high, all moves lose, the moves are taken from TT
+	return g;
+}
+
+/// AlphaBeta with TT and Principal Variation Move and Move Ordering, parallelized by YBWC (see ybwc.h)
+i32 AlphaBetaPVMOYBWC(i32 depth, i32 alpha, i32 beta)
+{
+	DPRINT2("abPVMO YBWC - depth %d, alpha %d, beta %d, searched %d", depth, alpha, beta, searchedNodes);
+	ASSERT2(depth >= 0, "depth < 0");
+	ASSERT2(moveNumber == 1, "AB starting: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
+	searchedNodes++;
+	if (SEARCH_ABORTED())
+		return 0;
+	if (abs(value) == WIN) {
+		return player * value;
+	}
+	ASSERT2(!IsEndOfGame(), "AB end of game, val %d, depth %d", value, depth);
+	if (depth == 0)
+		return LeafValue(alpha, beta);
+	i32 initSearchedNodes = searchedNodes;
+	i32 ttType = UPPER_BOUND;
+	i32 moveCount = 0;
+	Move best1, best2;	// copies, the lists of moves are overwritten by generating in next iterations
+	best1.from = best2.from = NO_MOVE;
+	i32 val, max = -WIN - 1;
+	moveNumber = 1;
+	TTEntry savedEntry;
+	TTEntry *saved = LookupPositionInTT(&savedEntry);
+	if (saved != null) {
+		if (saved->bestMove1.from != NO_MOVE && !IsMovePossible(&saved->bestMove1)) {
+			saved = null;
+			DPRINT("HashCollision");
+			DBG(ttCollision++);
+		}
+	}
+	if (saved != null) {
+		if (saved->searchDepth >= depth) {
+			if (saved->valueType == EXACT_VALUE) {
+				TCOUNT(ttCutoffs);
+				ASSERT2(moveNumber == 1, "AB ret 1: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
+				return saved->value;
+			} else if (saved->valueType == LOWER_BOUND && saved->value > alpha) {	//update lowerbound if needed
+				alpha = saved->value;
+			} else if (saved->valueType == UPPER_BOUND && saved->value < beta) {	//update upperbound if needed
+				beta = saved->value;
+			}
+			if (alpha >= beta) {
+				TCOUNT(ttCutoffs);
+				ASSERT2(moveNumber == 1, "AB ret 2: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
+				return saved->value;
+			}
+		}
+		Move pv1 = saved->bestMove1;	// copies because of TT kicks
+		Move pv2 = saved->bestMove2;
+		if (depth == 1 || pv2.from == NO_MOVE) {
+			ExecuteMove(&pv1);
+			i32 plVal = player * value;
+			if (depth == 1 || plVal == WIN) {
+				if (plVal == WIN)
+					max = plVal;
+				else
+					max = LeafValueAfterMove1(alpha, beta);
+				best1 = pv1;
+				if (max > alpha) {
+					alpha = max;
+					if (alpha >= beta) {
+						RevertLastMove();
+						DPRINT2("pruned by pv move, d = 1, alpha %d, beta %d", alpha, beta);
+						TCUTOFF(true);
+						SaveKillerMoves(&pv1, null);
+						ASSERT2(moveNumber == 1, "AB ret 3: bad moveNumber turnNumber %d, moveNumber %d",
+							turnNumber, moveNumber);
+						return max;
+					}
+				}
+			}
+			RevertLastMove();
+		} else {
+			ExecuteMove(&pv1);
+			ExecuteMove(&pv2);
+			max = -AlphaBetaPVMOYBWC(depth - 2, -beta, -alpha);
+			RevertLastMove();
+			RevertLastMove();
+			if (searchAborted)
+				return 0;
+			best1 = pv1;
+			best2 = pv2;
+			if (depth == currDepth)
+				SaveRootBest(&best1, &best2, max, true);
+			if (max > alpha) {
+				alpha = max;
+				if (alpha >= beta) {
+					TCUTOFF(true);
+					SaveKillerMoves(&pv1, &pv2);
+					ASSERT2(moveNumber == 1, "AB ret 4: bad moveNumber turnNumber %d, moveNumber %d", turnNumber,
+						moveNumber);
+					return max;	//no need to save anything to TT
+				}
+				ttType = EXACT_VALUE;
+			}
+			
+		}
+	}
+	bool pruned = false;
+	Move *moves = null, *moves2;
+	i32 count = 0;
+	if (CanSplit(depth)) {	// the children are searched by SplitNode, the loop is skipped
+		if (!SplitNode(depth, &alpha, beta, &max, &best1, &best2, &ttType))
+			return 0;
+		if (ttType == LOWER_BOUND)
+			SaveKillerMoves(&best1, &best2);
+	} else
+		count = GenerateAllMovesSortedMove1(&moves);
+	for (Move *move = moves; move < moves + count; move++) {
+		ASSERT2(IsMovePossible(move), "AB: move 1 not possible");
+		ExecuteMove(move);
+		i32 plVal = player * value;
+		if (plVal == WIN) {
+			max = WIN;
+			best1 = *move;
+			best2.from = NO_MOVE;
+			
+			//pruning
+			alpha = WIN;
+			pruned = true;
+			RevertLastMove();
+			TCUTOFF(move == moves && saved == null);
+			SaveKillerMoves(&best1, null);
+			ttType = LOWER_BOUND;
+			break;
+		}
+		else if (depth == 1) {
+			searchedNodes++;
+			i32 val = LeafValueAfterMove1(alpha, beta);
+			if (val > max) {
+				max = val;
+				best1 = *move;
+			}
+			if (val > alpha) {
+				alpha = val;
+				ttType = EXACT_VALUE;
+				if (alpha >= beta) {
+					pruned = true;
+					RevertLastMove();
+					TCUTOFF(move == moves && saved == null);
+					SaveKillerMoves(&best1, null);
+					DPRINT2("pruned, d = 1");
+					ttType = LOWER_BOUND;
+					break;
+				}
+			}
+		} else {
+			i32 count2 = GenerateAllMovesSortedMove2(&moves2);
+			for (Move *move2 = moves2; move2 < moves2 + count2; move2++) {
+				ASSERT2(IsMovePossible(move2), "AB: move 2 not possible");
+				ExecuteMove(move2);
+				moveCount++;
+				val = -AlphaBetaPVMOYBWC(depth - 2, -beta, -alpha);
+				RevertLastMove();
+				DPRINT2("rev move 2");
+				if (searchAborted) {
+					RevertLastMove();
+					return 0;
+				}
+				if (val > max) {
+					max = val;
+					best1 = *move;
+					best2 = *move2;
+					if (depth == currDepth)
+						SaveRootBest(&best1, &best2, max, false);
+				}
+				if (val > alpha) {
+					alpha = val;
+					if (alpha >= beta) {
+						pruned = true;
+						TCUTOFF(moveCount == 1 && saved == null);
+						SaveKillerMoves(&best1, &best2);
+						DPRINT2("pruned, alpha %d, beta %d", alpha, beta);
+						ttType = LOWER_BOUND;
+						break;
+					}
+					ttType = EXACT_VALUE;
+				}
+			}
+		}
+		RevertLastMove();
+		if (pruned) {
+			DPRINT2("pruned");
+			break;
+		}
+	}
+	
+	ASSERT2(max > -WIN - 1, "AB: too low max %d", max);
+	DPRINT2("abPVMO YBWC END - depth %d, alpha %d, beta %d, searched %d", depth, alpha, beta, searchedNodes);
+	AddPositionToTT(max, ttType, depth, searchedNodes - initSearchedNodes, &best1, &best2);
+	ASSERT2(moveNumber == 1, "bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
+	return max;
+}
+
+/// SELECTIVE_* methods of AlphaBetaPVMOSelective used by the AI, 0 for AIs without selective search
+i32 SelectiveSearchOfAI(i32 ai)
+{
+	if (ai == AIALPHABETA_ID_SELECTIVE)
+		return SELECTIVE_LMR | SELECTIVE_FUTILITY;
+	if (ai == AIALPHABETA_ID_LMR)
+		return SELECTIVE_LMR;
+	if (ai == AIALPHABETA_ID_FUTILITY)
+		return SELECTIVE_FUTILITY;
+	return 0;
+}
+
+/// Sets selective search of the AI for the search in the current thread and the futility margin for the current
+/// eval parameter set: the highest StackQuality of a stack, i.e. of the last stone of a type
+void SetSelectiveSearch(i32 ai)
+{
+	selectiveSearch = SelectiveSearchOfAI(ai);
+	futilityMargin = 0;
+	FOR(h, 1, MAX_STACK_HEIGHT) FOR(field, 0, BOARD_ARRAY_SIZE) {
+		i32 quality = StackHeightValue[h] * StackByCountValue[1] + StackValueByField[h][field] * FIELD_VALUE_MULT;
+		futilityMargin = MAX(futilityMargin, quality);
+	}
+}
+
+/// AlphaBetaPVMOHistoryNegascout with selective search: late pairs are searched to a lower depth with a zero window
+/// first and again to the full depth only if they fail high (SELECTIVE_LMR); in frontier nodes quiet second moves
+/// (stacks and the pass) are skipped when the static value after the first move with the material they gain
+/// and futilityMargin cannot reach alpha (SELECTIVE_FUTILITY). Methods are given by selectiveSearch.
+i32 AlphaBetaPVMOSelective(i32 depth, i32 alpha, i32 beta)
+{
+	DPRINT2("abPVMO selective - depth %d, alpha %d, beta %d, searched %d", depth, alpha, beta,
+		searchedNodes);
+	ASSERT2(depth >= 0, "depth < 0");
+	ASSERT2(moveNumber == 1, "AB starting: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
+	searchedNodes++;
+	if (SEARCH_ABORTED())
+		return 0;
+	if (abs(value) == WIN) {
+		return player * value;
+	}
+	ASSERT2(!IsEndOfGame(), "AB end of game, val %d, depth %d", value, depth);
+	if (depth == 0)
+		return LeafValue(alpha, beta);
+	i32 initSearchedNodes = searchedNodes;
+	i32 ttType = UPPER_BOUND;
+	i32 moveCount = 0;
+	Move best1, best2;	// copies, the lists of moves are overwritten by generating in next iterations
+	best1.from = best2.from = NO_MOVE;
+	i32 val, max = -WIN - 1;
+	moveNumber = 1;
+	TTEntry savedEntry;
+	TTEntry *saved = LookupPositionInTT(&savedEntry);
+	//i32 beta2 = -WIN-2;//negascout
+	if (saved != null) {
+		ASSERT2(saved->bestMove1.from != NO_MOVE, "saved->bestMove1 not set");
+		if (saved->bestMove1.from != NO_MOVE && !IsMovePossible(&saved->bestMove1)) {
+			saved = null;
+			DPRINT("HashCollision");
+			DBG(ttCollision++);
+		}
+	}
+	if (saved != null) {
+		if (saved->searchDepth >= depth) {
+			if (saved->valueType == EXACT_VALUE) {
+				TCOUNT(ttCutoffs);
+				ASSERT2(moveNumber == 1, "AB ret 1: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
+				return saved->value;
+			} else if (saved->valueType == LOWER_BOUND && saved->value > alpha) {	//update lowerbound if needed
+				alpha = saved->value;
+			} else if (saved->valueType == UPPER_BOUND && saved->value < beta) {	//update upperbound if needed
+				beta = saved->value;
+			}
+			if (alpha >= beta) {
+				DPRINT2("pruned by TT values search depth %d, depth %d", saved->searchDepth, depth);
+				TCOUNT(ttCutoffs);
+				ASSERT2(moveNumber == 1, "AB ret 2: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
+				return saved->value;
+			}
+		}
+		Move pv1 = saved->bestMove1;	// copies because of TT kicks
+		Move pv2 = saved->bestMove2;
+		if (depth == 1 || pv2.from == NO_MOVE) {
+			ExecuteMove(&pv1);
+			i32 plVal = player * value;
+			if (depth == 1 || plVal == WIN) {
+				if (plVal == WIN)
+					max = plVal;
+				else
+					max = LeafValueAfterMove1(alpha, beta);
+				best1 = pv1;
+				if (max > alpha) {
+					alpha = max;
+					if (alpha >= beta) {
+						RevertLastMove();
+						DPRINT2("pruned by pv move, d = 1, alpha %d, beta %d", alpha, beta);
+						TCUTOFF(true);
+						SaveKillerMoves(&pv1, null);
+						ASSERT2(moveNumber == 1, "AB ret 3: bad moveNumber turnNumber %d, moveNumber %d",
+							turnNumber, moveNumber);
+						historyPruneMoves[pv1.from][pv1.to] += 1 << depth;
+						return max;
+					}
+				}
+			}
+			RevertLastMove();
+		} else {
+			ExecuteMove(&pv1);
+			ExecuteMove(&pv2);
+			max = -AlphaBetaPVMOSelective(depth - 2, -beta, -alpha);
+			RevertLastMove();
+			RevertLastMove();
+			if (searchAborted)
+				return 0;
+			best1 = pv1;
+			best2 = pv2;
+			if (depth == currDepth)
+				SaveRootBest(&best1, &best2, max, true);
+			if (max > alpha) {
+				alpha = max;
+				if (alpha >= beta) {
+					TCUTOFF(true);
+					SaveKillerMoves(&pv1, &pv2);
+					ASSERT2(moveNumber == 1, "AB ret 4: bad moveNumber turnNumber %d, moveNumber %d", turnNumber,
+						moveNumber);
+					historyPruneMoves[pv1.from][pv1.to] += 1 << depth;
+					return max;	//no need to save anything to TT
+				}
+				ttType = EXACT_VALUE;
+			}
+		}
+	}
+	bool pruned = false;
+	i32 beta2 = beta;
+	Move *moves, *moves2;
+	i32 count = GenerateAllMovesSortedMove1(&moves);
+	for (Move *move = moves; move < moves + count; move++) {
+		ASSERT2(IsMovePossible(move), "AB: move 1 not possible");
+		ExecuteMove(move);
+		DPRINT2("exec move 1, depth %d", depth);
+		i32 plVal = player * value;
+		if (plVal == WIN) {
+			max = WIN;
+			best1 = *move;
+			best2.from = NO_MOVE;
+			
+			//pruning
+			alpha = WIN;
+			pruned = true;
+			RevertLastMove();
+			TCUTOFF(move == moves && saved == null);
+			SaveKillerMoves(&best1, null);
+			DPRINT2("pruned, d = 1 or win alpha %d, beta %d", alpha, beta);
+			ttType = LOWER_BOUND;
+			historyPruneMoves[best1.from][best1.to] += 1 << depth;
+			break;
+		} else if (depth == 1) {
+			searchedNodes++;
+			i32 val = LeafValueAfterMove1(alpha, beta);
+			if (val > max) {
+				max = val;
+				best1 = *move;
+			}
+			if (val > alpha) {
+				alpha = val;
+				ttType = EXACT_VALUE;
+				if (alpha >= beta) {
+					pruned = true;
+					RevertLastMove();
+					TCUTOFF(move == moves && saved == null);
+					SaveKillerMoves(&best1, null);
+					DPRINT2("pruned, d = 1");
+					ttType = LOWER_BOUND;
+					historyPruneMoves[best1.from][best1.to] += 1 << depth;
+					
+					break;
+				}
+			}
+		} else {
+			// futility pruning, the root is searched fully because of its best moves
+			bool futile = (selectiveSearch & SELECTIVE_FUTILITY) && depth == 2 && depth != currDepth && alpha > -WIN;
+			i32 staticValue = futile ? player * CachedStaticValue() : 0;	// after the first move
+			i32 count2 = GenerateAllMovesSortedMove2(&moves2);
+			for (Move *move2 = moves2; move2 < moves2 + count2; move2++) {
+				ASSERT2(IsMovePossible(move2), "AB: move 2 not possible");
+				if (futile && (move2->from == -1 || board[move2->from] * board[move2->to] > 0)) {	// quiet move
+					i32 from = move2->from, to = move2->to, bound = staticValue + futilityMargin;
+					if (from != -1)	// the change of materialValue by stacking, like in ExecuteMove
+						bound += StackQuality(stackHeights[from] + stackHeights[to], board[from], to)
+						    - StackQuality(stackHeights[from], board[from], from) - StackQuality(stackHeights[to], board[to], to);
+					if (bound <= alpha) {
+						TCOUNT(futilityPrunes);
+						max = MAX(max, bound);	// the pair isn't a best move, it may be better only by the margin
+						continue;
+					}
+				}
+				ExecuteMove(move2);
+				moveCount++;
+				i32 reduction = 0;	// late move reduction in half-moves, whole turns keep the side of the horizon
+				if ((selectiveSearch & SELECTIVE_LMR) && depth >= LMR_MIN_DEPTH && moveCount > LMR_FULL_PAIRS
+				    && move2 - moves2 >= LMR_LATE_MOVE2)
+					reduction = MIN(move - moves >= LMR_LATE_MOVE1 ? 4 : 2, (depth - 2) & ~1);
+				if (reduction > 0) {
+					TCOUNT(lmrReductions);
+					val = -AlphaBetaPVMOSelective(depth - 2 - reduction, -alpha - 1, -alpha);
+				}
+				if (reduction == 0 || val > alpha) {	// a reduced pair which failed high is searched again
+					if (reduction > 0)
+						TCOUNT(lmrReSearches);
+					if (depth > 2 && beta2 < beta) {	// negascount
+						val = -AlphaBetaPVMOSelective(depth - 2, -beta2, -alpha);
+						if (val > alpha && val < beta)
+							val = -AlphaBetaPVMOSelective(depth - 2, -beta, -alpha);	// NegaScout
+					} else
+						val = -AlphaBetaPVMOSelective(depth - 2, -beta, -alpha);
+				}
+				RevertLastMove();
+				if (searchAborted) {
+					RevertLastMove();
+					return 0;
+				}
+				if (val > max) {
+					max = val;
+					best1 = *move;
+					best2 = *move2;
+					if (depth == currDepth)
+						SaveRootBest(&best1, &best2, max, false);
+				}
+				if (val > alpha) {
+					alpha = val;
+					if (alpha >= beta) {
+						pruned = true;
+						TCUTOFF(moveCount == 1 && saved == null);
+						SaveKillerMoves(&best1, &best2);
+						DPRINT2("pruned, alpha %d, beta %d", alpha, beta);
+						ttType = LOWER_BOUND;
+						historyPruneMoves[best1.from][best1.to] += 1 << depth;
+						
+						break;
+					}
+					ttType = EXACT_VALUE;
+				}
+				beta2 = alpha + 1;	//negascout
+			}
+		}
+		RevertLastMove();
+		if (pruned) {
+			DPRINT2("pruned");
+			break;
+		}
+	}
+	
+	ASSERT2(max > -WIN - 1, "AB: too low max %d", max);
+	DPRINT2("abPVMO END - depth %d, alpha %d, beta %d, searched %d", depth, alpha, beta, searchedNodes);
+	if (best1.from != NO_MOVE)	// all pairs may be pruned by futility
+		AddPositionToTT(max, ttType, depth, searchedNodes - initSearchedNodes, &best1, &best2);
+	ASSERT2(moveNumber == 1, "bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
+	return max;
+}
+
+/// AlphaBeta with TT and Principal Variation Move and Move Ordering and beginner evaluation function
+i32 AlphaBetaPVMOBeginner(i32 depth, i32 alpha, i32 beta)
+{				//the only difference from AlphaBetaPVMO is calling StaticValueBeginner instead of StaticValue
+	DPRINT2("abPVMO beginner - depth %d, alpha %d, beta %d, searched %d", depth, alpha, beta, searchedNodes);
+	ASSERT2(depth >= 0, "depth < 0");
+	ASSERT2(moveNumber == 1, "AB starting: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
+	searchedNodes++;
+	if (SEARCH_ABORTED())
+		return 0;
+	if (abs(value) == WIN) {
+		DPRINT2("found win %d, pl %d, depth %d", value, player, depth);
+		return player * value;
+	}
+	ASSERT2(!IsEndOfGame(), "AB end of game, val %d, depth %d", value, depth);
+	if (depth == 0) {
 		DPRINT2("depth 0, val %d", player * (materialValue + StaticValueBeginner()));
 		i32 v = materialValue + StaticValueBeginner();
 		ASSERT2(abs(v) < WIN / 10,
@@ -1819,26 +2339,26 @@ i32 AlphaBetaPVMOBeginner(i32 depth, i32 alpha, i32 beta)
 		return player * v;
 	}
 	i32 initSearchedNodes = searchedNodes;
-	i32 ttType = LOWER_BOUND;
+	i32 ttType = UPPER_BOUND;
 	i32 moveCount = 0;
-	Move *best1 = null, *best2 = null;
+	Move best1, best2;	// copies, the lists of moves are overwritten by generating in next iterations
+	best1.from = best2.from = NO_MOVE;
 	i32 val, max = -WIN - 1;
 	moveNumber = 1;
-	TTEntry *saved = LookupPositionInTT();
+	TTEntry savedEntry;
+	TTEntry *saved = LookupPositionInTT(&savedEntry);
 	if (saved != null) {
-		ASSERT2(saved->bestMove1 != null, "saved->bestMove1 == null");
-		if ((saved->bestMove1 != null && !IsMovePossible(saved->bestMove1))
-		    || (saved->bestMove1 != null && !IsMovePossible(saved->bestMove1))) {
+		ASSERT2(saved->bestMove1.from != NO_MOVE, "saved->bestMove1 not set");
+		if (saved->bestMove1.from != NO_MOVE && !IsMovePossible(&saved->bestMove1)) {
 			saved = null;
 			DPRINT("HashCollision");
 			DBG(ttCollision++);
 		}
 	}
 	if (saved != null) {
-		DBG(ttFound++);
 		if (saved->searchDepth >= depth) {
-			DBG(ttHit++);
 			if (saved->valueType == EXACT_VALUE) {
+				TCOUNT(ttCutoffs);
 				ASSERT2(moveNumber == 1, "AB ret 1: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 				return saved->value;
 			} else if (saved->valueType == LOWER_BOUND && saved->value > alpha) {	//update lowerbound if needed
@@ -1848,16 +2368,16 @@ i32 AlphaBetaPVMOBeginner(i32 depth, i32 alpha, i32 beta)
 			}
 			if (alpha >= beta) {
 				DPRINT2("pruned by TT values search depth %d, depth %d", saved->searchDepth, depth);
-				DBG(prunedCount++);
+				TCOUNT(ttCutoffs);
 				ASSERT2(moveNumber == 1, "AB ret 2: bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 				return saved->value;
 			}
 		}
-		Move *pv1 = saved->bestMove1;
-		Move *pv2 = saved->bestMove2;
-		if (depth == 1 || pv2 == null) {
+		Move pv1 = saved->bestMove1;	// copies because of TT kicks
+		Move pv2 = saved->bestMove2;
+		if (depth == 1 || pv2.from == NO_MOVE) {
 			DPRINT2("pv move for depth == 1");
-			ExecuteMove(pv1);
+			ExecuteMove(&pv1);
 			i32 plVal = player * value;
 			if (depth == 1 || plVal == WIN) {
 				DPRINT2("pv move executed, d = 1");
@@ -1865,13 +2385,14 @@ i32 AlphaBetaPVMOBeginner(i32 depth, i32 alpha, i32 beta)
 					max = plVal;
 				else
 					max = player * (materialValue + StaticValueBeginner());
-				best1 = CloneMove(pv1);
+				best1 = pv1;
 				if (max > alpha) {
 					alpha = max;
 					if (alpha >= beta) {
 						RevertLastMove();
 						DPRINT2("pruned by pv move, d = 1, alpha %d, beta %d", alpha, beta);
-						DBG(prunedCount++);
+						TCUTOFF(true);
+						SaveKillerMoves(&pv1, null);
 						ASSERT2(moveNumber == 1, "AB ret 3: bad moveNumber turnNumber %d, moveNumber %d",
 							turnNumber, moveNumber);
 						return max;
@@ -1880,23 +2401,26 @@ i32 AlphaBetaPVMOBeginner(i32 depth, i32 alpha, i32 beta)
 			}
 			RevertLastMove();
 			DPRINT2("pv move done");
-		} else if (pv2 != null) {
-			pv1 = CloneMove(pv1);	//because of TT kicks
-			pv2 = CloneMove(pv2);
-			ExecuteMove(pv1);
-			ExecuteMove(pv2);
+		} else {
+			ExecuteMove(&pv1);
+			ExecuteMove(&pv2);
 			DPRINT2("starting PV moves");
 			max = -AlphaBetaPVMOBeginner(depth - 2, -beta, -alpha);
 			DPRINT2("done PV moves");
 			RevertLastMove();
 			RevertLastMove();
+			if (searchAborted)
+				return 0;
 			DPRINT2("best are pv moves");
 			best1 = pv1;
 			best2 = pv2;
+			if (depth == currDepth)
+				SaveRootBest(&best1, &best2, max, true);
 			if (max > alpha) {
 				alpha = max;
 				if (alpha >= beta) {
-					DBG(prunedCount++);
+					TCUTOFF(true);
+					SaveKillerMoves(&pv1, &pv2);
 					ASSERT2(moveNumber == 1, "AB ret 4: bad moveNumber turnNumber %d, moveNumber %d", turnNumber,
 						moveNumber);
 					return max;	//no need to save anything to TT
@@ -1906,40 +2430,26 @@ i32 AlphaBetaPVMOBeginner(i32 depth, i32 alpha, i32 beta)
 		}
 	}
 	bool pruned = false;;
-	Move *tmp, *move, *move2, *start1, *start2;
-	GenerateAllMovesSortedMove1(&move);
-	start1 = move;
-	while (move != NULL) {
+	Move *moves, *moves2;
+	i32 count = GenerateAllMovesSortedMove1(&moves);
+	for (Move *move = moves; move < moves + count; move++) {
 		ASSERT2(IsMovePossible(move), "AB: move 1 not possible");
 		ExecuteMove(move);
 		DPRINT2("exec move 1, depth %d", depth);
 		i32 plVal = player * value;
 		if (plVal == WIN) {
 			max = WIN;
-			if (best1 != move) {	// do not cut a branch under you
-				if (best1 != null) {
-					FreeMove(best1);
-				}
-				best1 = move;
-			}
-			if (best2 != null) {
-				FreeMove(best2);
-				best2 = null;
-			}
+			best1 = *move;
+			best2.from = NO_MOVE;
 			
 			//pruning
 			alpha = WIN;
 			pruned = true;
 			RevertLastMove();
-			DBG(prunedCount++);
+			TCUTOFF(move == moves && saved == null);
+			SaveKillerMoves(&best1, null);
 			DPRINT2("pruned, d = 1 or win alpha %d, beta %d", alpha, beta);
-			do {
-				tmp = move;
-				move = move->next;
-				if (tmp != best1)
-					FreeMove(tmp);
-			} while (move != NULL);
-			ttType = UPPER_BOUND;
+			ttType = LOWER_BOUND;
 			break;
 		} else if (depth == 1) {
 			searchedNodes++;
@@ -1947,12 +2457,7 @@ i32 AlphaBetaPVMOBeginner(i32 depth, i32 alpha, i32 beta)
 			val = player * (materialValue + StaticValueBeginner());
 			if (val > max) {
 				max = val;
-				if (best1 != move) {	// do not cut a branch under you
-					if (best1 != null) {
-						FreeMove(best1);
-					}
-					best1 = move;
-				}
+				best1 = *move;
 			}
 			if (val > alpha) {
 				alpha = val;
@@ -1960,23 +2465,16 @@ i32 AlphaBetaPVMOBeginner(i32 depth, i32 alpha, i32 beta)
 				if (alpha >= beta) {
 					pruned = true;
 					RevertLastMove();
-					DBG(prunedCount++);
+					TCUTOFF(move == moves && saved == null);
+					SaveKillerMoves(&best1, null);
 					DPRINT2("pruned, d = 1");
-					do {
-						tmp = move;
-						move = move->next;
-						if (tmp != best1)
-							FreeMove(tmp);
-					} while (move != NULL);
-					ttType = UPPER_BOUND;
+					ttType = LOWER_BOUND;
 					break;
 				}
 			}
 		} else {
-			GenerateAllMovesSortedMove2(&move2);
-			start2 = move2;
-			
-			while (move2 != NULL) {
+			i32 count2 = GenerateAllMovesSortedMove2(&moves2);
+			for (Move *move2 = moves2; move2 < moves2 + count2; move2++) {
 				DPRINT2("start exec move 2");
 				ASSERT2(IsMovePossible(move2), "AB: move 2 not possible");
 				ExecuteMove(move2);
@@ -1985,58 +2483,38 @@ i32 AlphaBetaPVMOBeginner(i32 depth, i32 alpha, i32 beta)
 				val = -AlphaBetaPVMOBeginner(depth - 2, -beta, -alpha);
 				RevertLastMove();
 				DPRINT2("rev move 2");
+				if (searchAborted) {
+					RevertLastMove();
+					return 0;
+				}
 				if (val > max) {
 					max = val;
-					if (best1 != move) {	// do not cut a branch under you
-						if (best1 != null) {
-							FreeMove(best1);
-						}
-						best1 = move;
-					}
-					if (best2 != null)
-						FreeMove(best2);
-					best2 = move2;
+					best1 = *move;
+					best2 = *move2;
+					if (depth == currDepth)
+						SaveRootBest(&best1, &best2, max, false);
 				}
 				if (val > alpha) {
 					alpha = val;
 					if (alpha >= beta) {
 						pruned = true;
-						DBG(prunedCount++);
-						do {
-							tmp = move2;
-							move2 = move2->next;
-							if (best2 != tmp)
-								FreeMove(tmp);
-						} while (move2 != NULL);
-						ttType = UPPER_BOUND;
+						TCUTOFF(moveCount == 1 && saved == null);
+						SaveKillerMoves(&best1, &best2);
+						ttType = LOWER_BOUND;
 						break;
 					}
 					ttType = EXACT_VALUE;
 				}
-				tmp = move2;
-				move2 = move2->next;
-				if (tmp != best2)
-					FreeMove(tmp);
 			}
 		}
 		RevertLastMove();
 		if (pruned) {
-			do {
-				tmp = move;
-				move = move->next;
-				if (tmp != best1)
-					FreeMove(tmp);
-			} while (move != NULL);
 			break;
 		}
-		tmp = move;
-		move = move->next;
-		if (tmp != best1)
-			FreeMove(tmp);
 	}
 	ASSERT2(max > -WIN - 1, "AB: too low max %d", max);
 	DPRINT2("abPVMO END - depth %d, alpha %d, beta %d, searched %d", depth, alpha, beta, searchedNodes);
-	AddPositionToTT(max, ttType, depth, searchedNodes - initSearchedNodes, best1, best2);
+	AddPositionToTT(max, ttType, depth, searchedNodes - initSearchedNodes, &best1, &best2);
 	ASSERT2(moveNumber == 1, "bad moveNumber turnNumber %d, moveNumber %d", turnNumber, moveNumber);
 	return max;
 }
@@ -2049,37 +2527,51 @@ i32 AlphaBetaPVMORandomBeginner(i32 depth, i32 randomMargin)
 	ASSERT2(depth == currDepth, "alfa-beta RANDOM PVMO not in top level of search");
 	ASSERT2(depth > 1, "random alfa-beta should have depth > 1");
 	searchedNodes++;
+	if (SEARCH_ABORTED())
+		return 0;
 	i32 moveCount = 0, initSearchedNodes = searchedNodes;
 	i32 val, max = -WIN - 1;
 	moveNumber = 1;
-	Move *move, *move2, *start1, *start2;
+	Move *moves, *moves2;
 	FullMovesList *allMoves = null;
-	GenerateAllMovesSortedMove1(&move);
-	start1 = move;
-	while (move != NULL) {
-		ExecuteMove(move);
-		GenerateAllMovesSortedMove2(&move2);
-		start2 = move2;
-		while (move2 != NULL) {
-			ExecuteMove(move2);
-			moveCount++;
-			val = -AlphaBetaPVMOBeginner(depth - 2, -WIN, -max + randomMargin + 1);
-			if (val >= max - randomMargin) {
-				FullMovesList *nMove = MALLOC(FullMovesList);
-				nMove->move1 = move;
-				nMove->move2 = move2;
-				nMove->value = val;
-				nMove->next = allMoves;
-				allMoves = nMove;
+	if (CanSplitRoot()) {	// workers search the root children too
+		SplitRandomRoot(depth, randomMargin, true, &max, &allMoves, &moveCount);
+	} else {
+		i32 count = GenerateAllMovesSortedMove1(&moves);
+		for (Move *move = moves; move < moves + count; move++) {
+			ExecuteMove(move);
+			i32 count2 = GenerateAllMovesSortedMove2(&moves2);
+			for (Move *move2 = moves2; move2 < moves2 + count2; move2++) {
+				ExecuteMove(move2);
+				moveCount++;
+				val = -AlphaBetaPVMOBeginner(depth - 2, -WIN, -max + randomMargin + 1);
+				if (val >= max - randomMargin) {
+					FullMovesList *nMove = MALLOC(FullMovesList);
+					nMove->move1 = *move;
+					nMove->move2 = *move2;
+					nMove->value = val;
+					nMove->next = allMoves;
+					allMoves = nMove;
+				}
+				RevertLastMove();
+				if (searchAborted)
+					break;
+				if (val > max) {
+					max = val;
+				}
 			}
 			RevertLastMove();
-			if (val > max) {
-				max = val;
-			}
-			move2 = move2->next;
+			if (searchAborted)
+				break;
 		}
-		RevertLastMove();
-		move = move->next;
+	}
+	if (searchAborted) {
+		while (allMoves != null) {
+			FullMovesList *next = allMoves->next;
+			free(allMoves);
+			allMoves = next;
+		}
+		return 0;
 	}
 	DPRINT2("random selecting started");
 	i32 goodEnoughMoves = 0;
@@ -2090,33 +2582,27 @@ i32 AlphaBetaPVMORandomBeginner(i32 depth, i32 randomMargin)
 		curr = curr->next;
 	}
 	ASSERT2(goodEnoughMoves > 0, "there are no moves for random choice!");
-	srand(time(null));
+	srand(randomSeed > 0 ? randomSeed : (u32) time(null));
 	i32 selectedMove = rand() % goodEnoughMoves;
 	DPRINT("found %d good moves, selected random move: %d", goodEnoughMoves, selectedMove);
 	curr = allMoves;
 	i32 i = 0;
 	while (curr != null) {
 		if (curr->value >= max - randomMargin) {
-			if (i == selectedMove) {
+			if (i == selectedMove)
 				selected = curr;
-			} else {
-				FreeMove(curr->move2);
-				if ((curr->next == null || curr->next->move1 != curr->move1)
-				    && (selected == null || curr->move1 != selected->move1))
-					FreeMove(curr->move1);
-			}
 			i++;
-		} else {
-			FreeMove(curr->move2);
-			if ((curr->next == null || curr->next->move1 != curr->move1)
-			    && (selected == null || curr->move1 != selected->move1))
-				FreeMove(curr->move1);
 		}
 		curr = curr->next;
 	}
 	DPRINT("move count on top level: %d", moveCount);
 	ASSERT2(selected != null, "random select == null");
 	DPRINT("max value: %d, selected move value: %d", max, selected->value);
-	AddPositionToTT(max, EXACT_VALUE, depth, searchedNodes - initSearchedNodes, selected->move1, selected->move2);	//because of retrieving in GetBestMove; it's called only once
+	AddPositionToTT(max, EXACT_VALUE, depth, searchedNodes - initSearchedNodes, &selected->move1, &selected->move2);	//because of retrieving in GetBestMove; it's called only once
+	while (allMoves != null) {
+		curr = allMoves;
+		allMoves = allMoves->next;
+		free(curr);
+	}
 	return max;
 }
@@ -26,33 +26,96 @@
 #define EXACT_VALUE 0
 #define LOWER_BOUND -1
 #define UPPER_BOUND 1
-#define TTSIZE (1 << 19)
+#define TTSIZE (1 << 18)	//default number of buckets in TT (16 MB)
+#define TT_BUCKET_SIZE 4	//entries in one 64-byte bucket
+// weights for choosing the entry to replace in a full bucket, in units of encoded searchedNodes (1024 is a doubling)
+#define TT_DEPTH_WEIGHT 256
+#define TT_EXACT_WEIGHT 1024
+#define TT_AGE_WEIGHT 4096
+
+//quiescence search, see Quiescence
+#define QS_DEPTH 2		//half-moves of loud captures searched after the horizon
+#define QS_MAX_MOVES 4		//captures searched in one node of the quiescence search
+#define QS_CRITICAL_COUNT 2	//every capture of a type with this many stones left is loud
+#define QS_DELTA_MARGIN 20000	//added to the material of the captured stack in delta pruning
+
+//selective search of AlphaBetaPVMOSelective, AIs choose the methods by SelectiveSearchOfAI
+#define SELECTIVE_LMR 1		//late move reductions -- late pairs are searched to a lower depth with a zero window first
+#define SELECTIVE_FUTILITY 2	//futility pruning of quiet second moves in frontier nodes (depth 2)
+#define LMR_MIN_DEPTH 4		//nodes with a lower depth search all pairs to the full depth
+#define LMR_FULL_PAIRS 3	//pairs of a node searched to the full depth (after the PV pair)
+#define LMR_LATE_MOVE2 4	//second moves from this index on are late (killers and the best captures are before them)
+#define LMR_LATE_MOVE1 4	//pairs with also the first move from this index on are reduced by 2 turns, others by 1 turn
+
+//eval cache -- values of materialValue + StaticValue() of positions, it's small and separate for every thread
+#define EVAL_CACHE_SIZE (1 << 14)	//number of entries (128 kB)
+
+typedef struct evalCacheEntry {
+	u32 lock;		// upper half of the hash, the lower half determines the index
+	i32 value;
+} EvalCacheEntry;
 
 //history heuristics
-i32 historyPruneMoves[BOARD_ARRAY_SIZE][BOARD_ARRAY_SIZE];	//only for first move of player
+extern THREAD_LOCAL i32 historyPruneMoves[BOARD_ARRAY_SIZE][BOARD_ARRAY_SIZE];	//only for first move of player
+
+//killer moves and countermoves, moves are encoded by EncodeMove (0 for none)
+#define KILLER_SLOTS 2		//killer moves of a ply, the newest first
+extern THREAD_LOCAL u16 killerMoves[MAX_MOVES][KILLER_SLOTS];	//indexed by the ply (turnNumber * 2 + moveNumber)
+// indexed by moveNumber - 1 and the last move of the opponent (from + 1, to + 1, so that a pass is [0][0])
+extern THREAD_LOCAL u16 counterMoves[2][BOARD_ARRAY_SIZE + 1][BOARD_ARRAY_SIZE + 1];
+extern THREAD_LOCAL i32 killerRootPly;	// the ply of the root of the search in the thread, history before it isn't searched
 
 //transposition tables
-typedef struct ttEntry {
-	thash hash;
-	Move *bestMove1, *bestMove2;
+typedef struct ttEntry {	// unpacked TT entry returned by LookupPositionInTT
+	Move bestMove1, bestMove2;	// bestMove2.from == NO_MOVE if bestMove1 wins
 	i32 value, valueType;	//type is EXACT_VALUE, LOWER_BOUND or UPPER_BOUND
 	i32 searchDepth;
 	u32 searchedNodes;
 } TTEntry;
-TTEntry *TranspositionTable[2 * TTSIZE];	//2* because of replacement schema Twobig
+
+typedef struct packedTTEntry {	// 16 bytes, stored directly in the table
+	u32 lock;		// upper half of the hash xor TTEntryChecksum, the lower half determines the index
+	u16 bestMove1, bestMove2;	// encoded by EncodeMove, bestMove1 == 0 for an empty entry
+	i32 value;
+	u8 searchDepth;
+	u8 generationType;	// generation of the search << 2 | (valueType + 1)
+	u16 searchedNodes;	// encoded by EncodeNodes, keeps the order of node counts
+} PackedTTEntry;
+
+typedef struct ttBucket {	// one cache line, a position can be saved only in the bucket given by its hash
+	PackedTTEntry entries[TT_BUCKET_SIZE];
+} __attribute__ ((aligned(64))) TTBucket;
+extern THREAD_LOCAL TTBucket *TranspositionTable;	// ttSize buckets, helper threads of the search use the table of the main one
+extern size_t ttSize;		// power of two, set by SetTTSize before the first search
+
+// the best root moves of the running ID iteration, they don't depend on the root entry in TT shared by threads
+extern THREAD_LOCAL Move rootBest1, rootBest2;
+extern THREAD_LOCAL i32 rootBestValue;
+extern THREAD_LOCAL bool rootBestFound;
+extern THREAD_LOCAL bool rootBestValid;	// set when the moves from the previous iteration were searched first
 
 //for random selecting
 typedef struct fullMovesList {
-	Move *move1, *move2;
+	Move move1, move2;
 	i32 value;		//value that is determined by search after executing the moves
 	struct fullMovesList *next;
 } FullMovesList;
 
-static __attribute__ ((unused))
-i32 StackHeightValue[] = { 0, 10, 100, 150, 155, 160, 160, 160, 160, 150, 140, 130, 100, 90, 60 };
+//eval parameter sets, see SetEvalParameters
+#define EVAL_STANDARD 0
+#define EVAL_BEGINNER 1		//higher stacks are always better, for the AI for beginners
+#define EVAL_PARAMETER_SETS 2
 
 static __attribute__ ((unused))
-i32 StackHeightValueBeginner[] = { 0, 10, 50, 110, 180, 250, 300, 350, 400, 450, 500, 550, 600, 650, 700 };
+i32 StackHeightValues[EVAL_PARAMETER_SETS][MAX_STACK_HEIGHT] = {
+	{ 0, 10, 100, 150, 155, 160, 160, 160, 160, 150, 140, 130, 100, 90, 60 },	// EVAL_STANDARD
+	{ 0, 10, 50, 110, 180, 250, 300, 350, 400, 450, 500, 550, 600, 650, 700 }	// EVAL_BEGINNER
+};
+extern THREAD_LOCAL i32 *StackHeightValue;	// the row of StackHeightValues of the current set
+extern THREAD_LOCAL i32 evalParameters;	// the current set, helper threads of a search use the set of the main thread
+
+extern THREAD_LOCAL i32 selectiveSearch;	// SELECTIVE_* methods of the running search, set by SetSelectiveSearch
+extern THREAD_LOCAL i32 futilityMargin;	// the highest StackQuality for the current parameter set
 
 static __attribute__ ((unused))
 i32 StackByCountValue[] = { 0, 100, 90, 60, 30, 20, 15, 10, 8, 6, 5, 4, 3, 2, 1, 1 };
@@ -252,23 +315,55 @@ i32 StackValueByField[][BOARD_ARRAY_SIZE] = {
 // FUNCTIONS 
 // -------
 // static evaluators
+i32 StaticValueFull();
+#ifdef INCREMENTAL_EVAL
+i32 HeightTerm();
+void UpdateZOCTerms(i32 i);
+#endif
 i32 StaticValue();
 i32 StaticValueBeginner();
+i32 CachedStaticValue();
+void ClearEvalCache();
+void SetEvalParameters(i32 set);
 
 // transposition tables functions
-TTEntry *LookupPositionInTT();
-bool CompareTTEntries(TTEntry * a, TTEntry * b);
-void FreeTTEntry(TTEntry * entry);
+void SetTTSize(u32 megabytes);
+bool InitTT();
+void ClearTT();
+u32 TTEntryChecksum(PackedTTEntry * entry);
+TTEntry *LookupPositionInTT(TTEntry * entry);
+u16 EncodeNodes(u32 searchedNodes);
+i32 TTEntryWorth(PackedTTEntry * entry);
+
+// killer moves and countermoves
+void ClearKillerMoves();
+void SaveKillerMoves(Move * m1, Move * m2);
+
+// quiescence search at the horizon
+#ifdef QUIESCENCE
+bool HasLoudCaptures();
+i32 Quiescence(i32 alpha, i32 beta, i32 qdepth);
+#endif
+i32 LeafValue(i32 alpha, i32 beta);
+i32 LeafValueAfterMove1(i32 alpha, i32 beta);
+
+// selective search
+i32 SelectiveSearchOfAI(i32 ai);
+void SetSelectiveSearch(i32 ai);
 
 // Alpha-beta with different enhancements
+void SaveRootBest(Move * m1, Move * m2, i32 val, bool pv);
 i32 AlphaBeta(i32 depth, i32 alpha, i32 beta);
 i32 AlphaBetaPV(i32 depth, i32 alpha, i32 beta);
 i32 AlphaBetaPVMO(i32 depth, i32 alpha, i32 beta);
-i32 AlphaBetaMO(i32 depth, i32 alpha, i32 beta, Move ** m1, Move ** m2);
+i32 AlphaBetaMO(i32 depth, i32 alpha, i32 beta, Move * m1, Move * m2);
 i32 AlphaBetaPVMORandom(i32 depth, i32 randomMargin);
 i32 AlphaBetaPVMONegascout(i32 depth, i32 alpha, i32 beta);
 i32 AlphaBetaPVMOHistory(i32 depth, i32 alpha, i32 beta);
 i32 AlphaBetaPVMOHistoryNegascout(i32 depth, i32 alpha, i32 beta);
+i32 MTDF(i32 depth, i32 guess);
+i32 AlphaBetaPVMOYBWC(i32 depth, i32 alpha, i32 beta);
+i32 AlphaBetaPVMOSelective(i32 depth, i32 alpha, i32 beta);
 i32 AlphaBetaPVMOBeginner(i32 depth, i32 alpha, i32 beta);
 i32 AlphaBetaPVMORandomBeginner(i32 depth, i32 randomMargin);
 
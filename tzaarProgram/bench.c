@@ -0,0 +1,123 @@
+/*
+ * The module bench runs the standard benchmark, see bench.h. Lines of its
+ * output start with "BENCH", other lines are debug prints of the searches.
+ *
+ * Author: Pavel Veselý
+ * License: GPL v3, see license.txt
+*/
+#include "bench.h"
+#include "tzaarSaveLoad.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+static double Now()
+{
+	struct timeval tv;
+	gettimeofday(&tv, null);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/// Adds the value to the signature byte by byte (FNV-1a)
+static thash AddToSignature(thash signature, unsigned long long value)
+{
+	FOR(i, 0, 8) {
+		signature ^= (value >> (8 * i)) & 0xff;
+		signature *= FNV_PRIME;
+	}
+	return signature;
+}
+
+/// Adds the move to the signature, a missing move is added as NO_MOVE
+static thash AddMoveToSignature(thash signature, Move * move)
+{
+	signature = AddToSignature(signature, (u32) (move != null ? move->from : NO_MOVE));
+	return AddToSignature(signature, (u32) (move != null ? move->to : NO_MOVE));
+}
+
+/// Prints the move like " A1-B2", a missing move as " -"
+static void PrintMove(Move * move)
+{
+	if (move == null)
+		printf(" -");
+	else
+		printf(" %s-%s", IndexToFieldName(move->from), IndexToFieldName(move->to));
+}
+
+/// Searches every position in dir by every AI of the benchmark (or only by ai if it isn't -1) and prints statistics.
+/// Every search starts with empty transposition tables. Returns OK or an error code.
+i32 RunBench(const char *dir, i32 ai)
+{
+	if (dir == null)
+		dir = BENCH_DIR;
+	searchDepthLimit = BENCH_AB_DEPTH;
+	searchNodeLimit = BENCH_DFPNS_NODES;
+	randomSeed = BENCH_RANDOM_SEED;
+	printf("BENCH positions %s, Alpha-beta depth %d, DFPNS nodes %d, threads %d\n", dir, BENCH_AB_DEPTH,
+	       BENCH_DFPNS_NODES, searchThreads);
+	thash signature = FNV_OFFSET;
+	unsigned long long totalNodes = 0;
+	double totalTime = 0;
+	i32 searches = 0, err = OK;
+	char file[FILENAME_MAX];
+	FOR(p, 0, (i32) (sizeof(BenchPositions) / sizeof(BenchPositions[0]))) {
+		snprintf(file, sizeof(file), "%s/%s", dir, BenchPositions[p]);
+		FOR(a, 0, (i32) (sizeof(BenchAIs) / sizeof(BenchAIs[0]))) {
+			if (ai != -1 && BenchAIs[a] != ai)
+				continue;
+			if (LoadPosition(file) != OK) {
+				printf("BENCH cannot load position '%s'\n", file);
+				err = CANNOT_LOAD_POSITION;
+				break;
+			}
+			ClearTT();
+			ClearTT2();
+			memset(&searchStats, 0, sizeof(searchStats));
+			Move *m1, *m2;
+			double start = Now();
+			if (!GetBestMove(BenchAIs[a], BENCH_TIME_LIMIT, &m1, &m2, false)) {
+				printf("BENCH search of '%s' by ai %d failed\n", BenchPositions[p], BenchAIs[a]);
+				err = GET_BEST_MOVE_ERROR;
+				break;
+			}
+			double duration = Now() - start;
+			signature = AddToSignature(signature, searchStats.nodes);
+			signature = AddMoveToSignature(signature, m1);
+			signature = AddMoveToSignature(signature, m2);
+			totalNodes += searchStats.nodes;
+			totalTime += duration;
+			searches++;
+			printf("BENCH %-22s ai %2d  nodes %10llu  time %8.3f s  nps %9.0f", BenchPositions[p], BenchAIs[a],
+			       searchStats.nodes, duration, searchStats.nodes / MAX(duration, 1e-6));
+#ifdef TELEMETRY
+			printf("  TT hit %5.1f %%", 100.0 * searchTelemetry.ttHits / MAX(searchTelemetry.ttProbes, 1));
+			if (BenchAIs[a] >= DFPNS)	// no cutoffs in DFPNS
+				printf("  first cut     -  ");
+			else
+				printf("  first cut %5.1f %%",
+				       100.0 * searchTelemetry.firstMoveCutoffs / MAX(searchTelemetry.cutoffs, 1));
+#endif
+			printf("  moves");
+			PrintMove(m1);
+			PrintMove(m2);
+			printf("\n");
+			fflush(stdout);
+			free(m1);
+			free(m2);
+		}
+		if (err != OK)
+			break;
+	}
+	printf("BENCH total: searches %d, nodes %llu, time %0.3f s, nps %0.0f\n", searches, totalNodes, totalTime,
+	       totalNodes / MAX(totalTime, 1e-6));
+	printf("BENCH signature: %016llx\n", signature);
+	searchDepthLimit = 0;
+	searchNodeLimit = 0;
+	randomSeed = 0;
+	return err;
+}
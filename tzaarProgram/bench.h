@@ -0,0 +1,47 @@
+/*
+ * The header file for module bench which runs the standard benchmark: every
+ * position of the benchmark set is searched by every AI at a fixed depth
+ * (Alpha-beta) or with a fixed node budget (DFPNS). For each search it prints
+ * the searched nodes, time, nodes per second, the TT hit rate and the rate of
+ * cutoffs by the first move (with TELEMETRY) and the best moves,
+ * at the end the totals and a signature of all node counts and best moves.
+ * The signature is the same for builds which search the same trees, so it
+ * detects changes of the search, while nodes per second compare the speed.
+ * Searches are reproducible only with one thread (-j 1, the default).
+ *
+ * Author: Pavel Veselý
+ * License: GPL v3, see license.txt
+*/
+#ifndef BENCH_H_INCLUDED
+#define BENCH_H_INCLUDED
+
+#include "tzaarlib.h"
+
+#define BENCH_DIR "../testPositions/benchSet"	// relative to tzaarProgram, where make bench runs
+#define BENCH_AB_DEPTH 5	// depth of all Alpha-beta AIs
+#define BENCH_DFPNS_NODES 500000	// node budget of DFPNS AIs
+#define BENCH_TIME_LIMIT 1000000	// only to make searches not abortable by time
+#define BENCH_RANDOM_SEED 1	// for AIALPHABETA_RANDOM
+
+// positions in files of the benchmark directory, in the format of position files
+static __attribute__ ((unused))
+const char *BenchPositions[] = {
+	"opening-start.txt",
+	"opening-turn4.txt",
+	"middlegame-20974.txt",
+	"middlegame-21135.txt",
+	"endgame-21084.txt",
+	"endgame-21102.txt"
+};
+
+static __attribute__ ((unused))
+i32 BenchAIs[] = {
+	AIALPHABETA, AIALPHABETA_ID, AIALPHABETA_ID_PV, AIALPHABETA_ID_PV_MO, AIALPHABETA_ID_MO, AIALPHABETA_RANDOM,
+	AIALPHABETA_ID_PV_MO_SCOUT, AIALPHABETA_ID_PV_MO_HISTORY, AIALPHABETA_ID_PV_MO_SCOUT_HISTORY, AIALPHABETA_ID_PV_MO_YBWC,
+	AIALPHABETA_ID_MTDF, AIALPHABETA_ID_LMR,
+	DFPNS, DFPNS_EPS_TRICK, WEAK_PNS, DFPNS_EVAL_BASED, DFPNS_WEAK_EPS_EVAL, DFPNS_DYNAMIC_WIDENING_EPS_EVAL
+};
+
+i32 RunBench(const char *dir, i32 ai);
+
+#endif				// BENCH_H_INCLUDED
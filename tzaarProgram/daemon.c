@@ -0,0 +1,487 @@
+/*
+ * The module daemon runs the engine as a long-lived process. The main thread
+ * reads commands from the standard input and passes them to the engine thread,
+ * which owns the position and the search state (they are thread local), so
+ * a running search can be stopped by a command.
+ *
+ * Author: Pavel Veselý
+ * License: GPL v3, see license.txt
+*/
+#define _GNU_SOURCE		// for fmemopen, strdup and strtok_r
+#include "daemon.h"
+#include "tzaarSaveLoad.h"
+#include "perft.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#define POSITION_NUMBERS (1 + 2 * BOARD_ARRAY_SIZE)	// player, stones and stack heights
+
+// Queue of commands from the reader (the main thread) to the engine thread, it's unbounded,
+// so the reader never waits for the engine
+typedef struct commandList {
+	char *command;
+	struct commandList *next;
+} CommandList;
+static CommandList *queueFirst, *queueLast;
+static pthread_mutex_t queueMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queueNotEmpty = PTHREAD_COND_INITIALIZER;
+
+// A go command is stopped if stop was read after it, go commands are numbered from 1 in order of reading
+static i32 goRead, goStarted, stoppedGo;
+
+// Pondering -- the engine thread executes the predicted turn of the opponent and searches the position after it.
+// The state is shared by both threads and guarded by ponderMutex (locked before queueMutex).
+static pthread_mutex_t ponderMutex = PTHREAD_MUTEX_INITIALIZER;
+static bool ponderActive;	// the reader compares moves with the prediction
+static bool ponderConverted;	// the opponent played the predicted turn and go came, the search is for our move now
+static i32 ponderMatched;	// moves of the predicted turn which the opponent already played
+static Move ponderMoves[2];	// the predicted turn
+static i32 ponderTime;		// time limit given to the pondering search
+static double ponderStart;
+
+// Defaults for the go command, used only by the engine thread
+static i32 daemonAi, daemonTime;
+static bool positionLoaded;
+// Moves of the current turn and the predicted turn, they have to live because history keeps pointers to them
+static Move turnMoves[2], predictedMoves[2];
+
+static double Now()
+{
+	struct timeval tv;
+	gettimeofday(&tv, null);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void PushCommand(char *command)
+{
+	CommandList *item = MALLOC(CommandList);
+	item->command = command;
+	item->next = null;
+	pthread_mutex_lock(&queueMutex);
+	if (queueLast == null)
+		queueFirst = item;
+	else
+		queueLast->next = item;
+	queueLast = item;
+	pthread_cond_signal(&queueNotEmpty);
+	pthread_mutex_unlock(&queueMutex);
+}
+
+static char *PopCommand()
+{
+	pthread_mutex_lock(&queueMutex);
+	while (queueFirst == null)
+		pthread_cond_wait(&queueNotEmpty, &queueMutex);
+	CommandList *item = queueFirst;
+	queueFirst = item->next;
+	if (queueFirst == null)
+		queueLast = null;
+	pthread_mutex_unlock(&queueMutex);
+	char *command = item->command;
+	free(item);
+	return command;
+}
+
+/// Stops the search of the last go command read
+static void StopRunningSearch()
+{
+	pthread_mutex_lock(&queueMutex);
+	stoppedGo = goRead;
+	stopSearch = true;
+	pthread_mutex_unlock(&queueMutex);
+}
+
+/// Returns true if the command is the word or starts with the word followed by a space
+static bool IsCommand(const char *command, const char *word)
+{
+	size_t len = strlen(word);
+	return strncmp(command, word, len) == 0 && (command[len] == '\0' || isspace((i32) command[len]));
+}
+
+static i32 CountTokens(const char *s)
+{
+	i32 count = 0;
+	while (*s != '\0') {
+		while (isspace((i32) *s))
+			s++;
+		if (*s == '\0')
+			break;
+		count++;
+		while (*s != '\0' && !isspace((i32) *s))
+			s++;
+	}
+	return count;
+}
+
+/// Parses "F1 F2" or "pass" into the move, returns false if it's not a move on the board
+static bool ParseMove(char *args, Move * move)
+{
+	char from[8], to[8];
+	i32 n = sscanf(args, "%7s %7s", from, to);
+	if (n == 1 && strcmp(from, "pass") == 0) {
+		move->from = move->to = -1;
+		return true;
+	}
+	if (n != 2)
+		return false;
+	move->from = FieldNameToIndex(from);
+	move->to = FieldNameToIndex(to);
+	return move->from != INVALID_INPUT && move->to != INVALID_INPUT && move->from != move->to
+	    && strcmp(IndexToFieldName(move->from), "-") != 0 && strcmp(IndexToFieldName(move->to), "-") != 0;
+}
+
+static void PrintMove(Move * move)
+{
+	if (move->from == -1)
+		printf(" pass");
+	else
+		printf(" %s %s", IndexToFieldName(move->from), IndexToFieldName(move->to));
+}
+
+static void DaemonPosition(char *args)
+{
+	i32 err;
+	while (isspace((i32) *args))
+		args++;
+	if (strncmp(args, "file=", 5) == 0) {
+		err = LoadPosition(args + 5);
+	} else {
+		FILE *f = fmemopen(args, strlen(args), "r");
+		if (f == null) {
+			printf("error cannot read position\n");
+			fflush(stdout);
+			return;
+		}
+		err = ReadPosition(f);
+		fclose(f);
+	}
+	positionLoaded = err == OK;
+	if (!positionLoaded) {
+		printf("error bad position (err %d)\n", err);
+		fflush(stdout);
+	}
+}
+
+static void DaemonMove(char *args)
+{
+	while (isspace((i32) *args))
+		args++;
+	if (!positionLoaded || IsEndOfGame()) {
+		printf("error no position to move in\n");
+		fflush(stdout);
+		return;
+	}
+	Move move;
+	if (!ParseMove(args, &move)) {
+		printf("error bad move %s\n", args);
+		fflush(stdout);
+		return;
+	}
+	if (!IsMovePossible(&move)) {
+		printf("error move not possible %s\n", args);
+		fflush(stdout);
+		return;
+	}
+	value = 0;
+	turnMoves[moveNumber - 1] = move;
+	ExecuteMove(&turnMoves[moveNumber - 1]);
+	if (moveNumber == 1)
+		turnNumber = 1;	// moves of the game are never reverted, so plies of the search start from the beginning
+	if (IsEndOfGame()) {
+		printf("info game over\n");
+		fflush(stdout);
+	}
+}
+
+/// Executes the opponent's turn from TT and lets the reader compare it with the real one.
+/// Returns false if there is nothing to ponder on.
+static bool StartPondering(i32 time)
+{
+	TTEntry entry;
+	if (LookupPositionInTT(&entry) == null || entry.bestMove2.from == NO_MOVE || !IsMovePossible(&entry.bestMove1)) {
+		printf("info no ponder move\n");
+		fflush(stdout);
+		return false;
+	}
+	predictedMoves[0] = entry.bestMove1;
+	ExecuteMove(&predictedMoves[0]);
+	if (IsEndOfGame() || !IsMovePossible(&entry.bestMove2)) {
+		RevertLastMove();
+		printf("info no ponder move\n");
+		fflush(stdout);
+		return false;
+	}
+	predictedMoves[1] = entry.bestMove2;
+	ExecuteMove(&predictedMoves[1]);
+	if (IsEndOfGame()) {
+		RevertLastMove();
+		RevertLastMove();
+		printf("info no ponder move\n");
+		fflush(stdout);
+		return false;
+	}
+	pthread_mutex_lock(&ponderMutex);
+	pthread_mutex_lock(&queueMutex);
+	bool pending = queueFirst != null;
+	pthread_mutex_unlock(&queueMutex);
+	if (pending) {		// the opponent's moves could be already there, don't wait for them
+		pthread_mutex_unlock(&ponderMutex);
+		RevertLastMove();
+		RevertLastMove();
+		printf("info no ponder move\n");
+		fflush(stdout);
+		return false;
+	}
+	turnNumber = 1;		// like after any turn of the game, the search expects it; FinishPondering restores it for reverting
+	printf("ponder");
+	PrintMove(&predictedMoves[0]);
+	PrintMove(&predictedMoves[1]);
+	printf("\n");
+	fflush(stdout);
+	ponderActive = true;
+	ponderConverted = false;
+	ponderMatched = 0;
+	ponderMoves[0] = predictedMoves[0];
+	ponderMoves[1] = predictedMoves[1];
+	ponderTime = time;
+	ponderStart = Now();
+	ponderTimeShift = 0;
+	pondering = true;
+	pthread_mutex_unlock(&ponderMutex);
+	return true;
+}
+
+/// Ends pondering after the search, returns true if the search became the search for our move.
+/// Otherwise the position is set according to the moves the opponent really played.
+static bool FinishPondering()
+{
+	pthread_mutex_lock(&ponderMutex);
+	bool converted = ponderConverted;
+	i32 matched = ponderMatched;
+	ponderActive = ponderConverted = false;
+	pondering = false;
+	ponderTimeShift = 0;
+	pthread_mutex_unlock(&ponderMutex);
+	if (converted || matched == 2)	// the position after the predicted turn is the real one
+		return converted;
+	turnNumber = 2;		// the predicted turn was executed in the first turn, the search overwrote its history
+	history[1 * 2 + 1] = &predictedMoves[0];
+	history[1 * 2 + 2] = &predictedMoves[1];
+	RevertLastMove();
+	RevertLastMove();
+	if (matched == 1) {	// the reader took the first move, the second one is queued
+		turnMoves[0] = predictedMoves[0];
+		ExecuteMove(&turnMoves[0]);
+	}
+	return false;
+}
+
+/// Passes the command from the reader to the engine thread, unless pondering consumes it.
+/// Commands are pushed under ponderMutex, so the engine cannot start pondering with a command in the queue.
+static void DispatchCommand(char *command)
+{
+	Move move;
+	pthread_mutex_lock(&ponderMutex);
+	if (IsCommand(command, "stop") || IsCommand(command, "quit")) {
+		ponderActive = false;	// the engine gives back the moves of the opponent already taken
+		StopRunningSearch();
+	} else if (ponderActive && !ponderConverted && !IsCommand(command, "isready")) {
+		if (ponderMatched < 2 && IsCommand(command, "move") && ParseMove(command + strlen("move"), &move)
+		    && move.from == ponderMoves[ponderMatched].from && move.to == ponderMoves[ponderMatched].to) {
+			ponderMatched++;
+			pthread_mutex_unlock(&ponderMutex);
+			free(command);
+			return;
+		}
+		if (ponderMatched == 2 && IsCommand(command, "go") && strstr(command, "ponder") == null) {
+			// ponder hit, the time limit is counted from now
+			i32 time = ponderTime;
+			char *t = strstr(command, "time=");
+			if (t != null)
+				sscanf(t, "time=%d", &time);
+			ponderTimeShift = Now() - ponderStart + time - ponderTime;
+			pondering = false;
+			ponderConverted = true;
+			pthread_mutex_unlock(&ponderMutex);
+			free(command);
+			return;
+		}
+		// the opponent played another turn, moves taken by pondering are given back to the engine
+		ponderActive = false;
+		if (ponderMatched < 2) {
+			FOR(i, 0, ponderMatched) {
+				char *m = (char *) malloc(16);
+				if (ponderMoves[i].from == -1)
+					strcpy(m, "move pass");
+				else
+					sprintf(m, "move %s %s", IndexToFieldName(ponderMoves[i].from),
+						IndexToFieldName(ponderMoves[i].to));
+				PushCommand(m);
+			}
+			ponderMatched = 0;
+		}
+		StopRunningSearch();
+	}
+	if (IsCommand(command, "go"))
+		goRead++;
+	PushCommand(command);
+	pthread_mutex_unlock(&ponderMutex);
+}
+
+static void DaemonGo(char *args)
+{
+	i32 ai = daemonAi, time = daemonTime;
+	bool ponder = false;
+	char *saveptr, *token;
+	for (token = strtok_r(args, " \t", &saveptr); token != null; token = strtok_r(null, " \t", &saveptr)) {
+		if (strcmp(token, "ponder") == 0)
+			ponder = true;
+		else if (sscanf(token, "time=%d", &time) != 1 && sscanf(token, "ai=%d", &ai) != 1) {
+			printf("error unknown go parameter %s\n", token);
+			fflush(stdout);
+			return;
+		}
+	}
+	if (!positionLoaded || IsEndOfGame() || moveNumber != 1) {
+		printf("error search is possible only at the beginning of a turn in a running game\n");
+		fflush(stdout);
+		return;
+	}
+	value = 0;
+	if (ponder && !StartPondering(time))
+		return;
+	Move *m1, *m2;
+	bool found = GetBestMove(ai, time, &m1, &m2, true) && m1 != null;
+	if (ponder && !FinishPondering()) {	// the result of pondering is kept only in TT
+		if (m1 != null)
+			FreeMove(m1);
+		if (m2 != null)
+			FreeMove(m2);
+		value = 0;
+		return;
+	}
+	if (!found) {
+		printf("error cannot get best moves (ai %d)\n", ai);
+		fflush(stdout);
+		value = 0;
+		return;
+	}
+	printf("bestmove");
+	PrintMove(m1);
+	if (m2 != null)
+		PrintMove(m2);
+	printf("\ninfo time %0.3f value %d\n", searchDuration, value);
+	fflush(stdout);
+	FreeMove(m1);
+	if (m2 != null)
+		FreeMove(m2);
+	value = 0;		// ExecuteMove expects zero value
+}
+
+static void DaemonPerft(char *args)
+{
+	i32 depth = 0;
+	bool divide = false, hashed = false, check = false;
+	char *saveptr, *token;
+	for (token = strtok_r(args, " \t", &saveptr); token != null; token = strtok_r(null, " \t", &saveptr)) {
+		if (strcmp(token, "divide") == 0)
+			divide = true;
+		else if (strcmp(token, "hash") == 0)
+			hashed = true;
+		else if (strcmp(token, "check") == 0)
+			check = true;
+		else if (sscanf(token, "%d", &depth) != 1) {
+			printf("error unknown perft parameter %s\n", token);
+			fflush(stdout);
+			return;
+		}
+	}
+	if (!positionLoaded) {
+		printf("error no position for perft\n");
+		fflush(stdout);
+		return;
+	}
+	RunPerft(depth, divide, hashed, check);
+}
+
+/// The engine thread processes commands until quit
+static void *EngineThread(void *unused __attribute__ ((unused)))
+{
+	while (true) {
+		char *command = PopCommand();
+		bool quit = false;
+		if (IsCommand(command, "position"))
+			DaemonPosition(command + strlen("position"));
+		else if (IsCommand(command, "move"))
+			DaemonMove(command + strlen("move"));
+		else if (IsCommand(command, "go")) {
+			goStarted++;
+			pthread_mutex_lock(&queueMutex);
+			stopSearch = stoppedGo >= goStarted;	// stop could be read before this search started
+			pthread_mutex_unlock(&queueMutex);
+			DaemonGo(command + strlen("go"));
+		} else if (IsCommand(command, "perft")) {
+			DaemonPerft(command + strlen("perft"));
+		} else if (IsCommand(command, "isready")) {
+			printf("readyok\n");
+			fflush(stdout);
+		} else if (IsCommand(command, "quit"))
+			quit = true;
+		else if (!IsCommand(command, "stop")) {	// stop is handled by the reader
+			printf("error unknown command %s\n", command);
+			fflush(stdout);
+		}
+		free(command);
+		if (quit)
+			return null;
+	}
+}
+
+/// Reads commands from stdin until quit or the end of input, returns OK or ERROR if the engine cannot start
+i32 RunDaemon(i32 ai, i32 time)
+{
+	daemonAi = ai;
+	daemonTime = time;
+	pthread_t engine;
+	if (pthread_create(&engine, null, EngineThread, null) != 0) {
+		printf("error cannot start the engine thread\n");
+		return ERROR;
+	}
+	char line[DAEMON_LINE_LENGTH];
+	char *command = null;
+	while (fgets(line, DAEMON_LINE_LENGTH, stdin) != null) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (command != null) {	// position is not complete yet
+			size_t len = strlen(command);
+			command = (char *) realloc(command, len + strlen(line) + 2);
+			command[len] = ' ';
+			strcpy(command + len + 1, line);
+		} else {
+			char *s = line;
+			while (isspace((i32) *s))
+				s++;
+			if (*s == '\0')
+				continue;
+			command = strdup(s);
+		}
+		if (IsCommand(command, "position") && strstr(command, "file=") == null
+		    && CountTokens(command) < 1 + POSITION_NUMBERS)
+			continue;	// the position continues on the next line
+		bool quit = IsCommand(command, "quit");
+		DispatchCommand(command);
+		command = null;
+		if (quit)
+			break;
+	}
+	if (command != null)
+		DispatchCommand(command);	// incomplete position, the engine reports it
+	if (feof(stdin))
+		DispatchCommand(strdup("quit"));
+	pthread_join(engine, null);
+	return OK;
+}
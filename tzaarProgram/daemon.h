@@ -0,0 +1,40 @@
+/*
+ * The header file for module daemon which runs the engine as a long-lived
+ * process controlled by commands on the standard input. The position, the
+ * transposition tables and the history tables stay alive between moves.
+ *
+ * Commands (one per line):
+ *   position                followed by the position in the format of position files
+ *                           (player, 81 stones, 81 stack heights; line breaks do not matter)
+ *   position file=FILE      loads the position from FILE
+ *   move F1 F2              executes the move of the player to move, ie. move A1 B2
+ *   move pass               passes in the second move of a turn
+ *   go [time=N] [ai=N]      searches for the best moves and prints
+ *                           "bestmove F1 F2 [F3 F4 | pass]" and "info time T value V"
+ *   go ponder [time=N] [ai=N]
+ *                           after our turn is played, executes the opponent's turn predicted
+ *                           by TT, prints "ponder F1 F2 F3 F4" and searches until the opponent
+ *                           moves; if the move commands match the prediction, the next go
+ *                           continues the search with its time limit counted from then,
+ *                           otherwise pondering stops and the moves are executed as usual
+ *   perft N [divide] [hash] [check]
+ *                           counts leaves in N half-moves from the position, see perft.h
+ *   stop                    stops the search, the best moves found so far are printed
+ *   isready                 prints "readyok" when all previous commands are processed
+ *   quit                    stops the search and ends the daemon
+ * Errors are reported by lines "error ...", other lines of the output (ie. debug
+ * prints "D: ...") should be ignored by the client.
+ *
+ * Author: Pavel Veselý
+ * License: GPL v3, see license.txt
+*/
+#ifndef DAEMON_H_INCLUDED
+#define DAEMON_H_INCLUDED
+
+#include "tzaarlib.h"
+
+#define DAEMON_LINE_LENGTH 4096
+
+i32 RunDaemon(i32 ai, i32 time);
+
+#endif				// DAEMON_H_INCLUDED
@@ -16,10 +16,23 @@
 
 void printHelp() {
 	printf("Searches for the best moves in a position in Tzaar: \n");
-	printf("\t-a AI --ai\t AI number (1-9, 20-25, 40-42)\n");
+	printf("\t-a AI --ai\t AI number (1-14, 20-25, 40-42)\n");
 	printf("\t-b FILE --bestmove=FILE\t Search for the best moves in a position stored in FILE. This is required option.\n");
 	printf("\t-e FILE --execute=FILE\t Execute the the best moves and then save the position to FILE.\n");
 	printf("\t-t SECONDS --timelimit=SECONDS\t Set time limit of the search to SECONDS (default is %d).\n", AI_TIME_LIMIT);
+	printf("\t-d --daemon\t Run as a daemon reading commands from the standard input, see daemon.h (-a and -t set defaults).\n");
+	printf("\t-H MB --hash=MB\t Size of the alpha-beta transposition table in megabytes, rounded down to a power of two (default is %d).\n",
+	       (i32) (TTSIZE * sizeof(TTBucket) >> 20));
+	printf("\t-P MB --pnshash=MB\t Size of the DFPNS transposition table in megabytes, rounded down to a power of two (default is %d).\n",
+	       (i32) (TT2SIZE * sizeof(TT2Bucket) >> 20));
+	printf("\t--bench[=DIR]\t Run the benchmark on positions in DIR (default is %s) and print statistics, -a selects one AI.\n", BENCH_DIR);
+	printf("\t-p DEPTH --perft=DEPTH\t Count leaves of the game tree in DEPTH half-moves from the position given by -b, see perft.h.\n");
+	printf("\t\t--divide\t Print the counts for every move from the position.\n");
+	printf("\t\t--perfthash\t Look up subtrees in a table of the size of the transposition table.\n");
+	printf("\t\t--perftcheck\t Compare the position updated by moves with its computation from scratch (slow).\n");
+	printf("\t--telemetry=LEVEL\t Write counters of searches as JSON lines, LEVEL 1 after every search, 2 also after every iteration, see telemetry.h.\n");
+	printf("\t--telemetryfile=FILE\t Append the telemetry lines to FILE instead of the standard error output.\n");
+	printf("\t-j N --threads=N\t Number of search threads (default is 1). AI 2-4, 7-9 and 11-14 run helper threads sharing the transposition table, AI 6, 10, 40 and 41 share subtrees by YBWC, DFPNS AIs run helper threads sharing TT2, AI 42 runs the AI it chooses, perft shares the moves from the position.\n");
 }
 
 i32 main(i32 argc, char *argv[])
@@ -28,6 +41,12 @@ i32 main(i32 argc, char *argv[])
 	i32 time = AI_TIME_LIMIT; // in seconds
 	char *executeFile = null;
 	char *fileWithPosition = null;
+	bool runDaemon = false;
+	bool runBench = false;
+	char *benchDir = null;
+	i32 perftDepth = 0;
+	bool divide = false, perftHash = false, perftCheck = false;
+	i32 megabytes;
 	i32 c, option_index;
 	while ((c = getopt_long(argc, argv, options, long_options, &option_index)) >= 0) {
 		switch (c) {
@@ -39,6 +58,44 @@ i32 main(i32 argc, char *argv[])
 			fileWithPosition = (char *) malloc(sizeof(char) * (strlen(optarg) + 5));
 			strcpy(fileWithPosition, optarg);
 			break;
+		case 'd':
+			runDaemon = true;
+			break;
+		case 'B':
+			runBench = true;
+			benchDir = optarg;	// null without the argument
+			break;
+		case 'p':
+			if (sscanf(optarg, "%d", &perftDepth) != 1 || perftDepth <= 0) {
+				printf("Bad depth of perft '%s'.\n", optarg);
+				return 0;
+			}
+			break;
+		case 'D':
+			divide = true;
+			break;
+		case 'K':
+			perftHash = true;
+			break;
+		case 'C':
+			perftCheck = true;
+			break;
+		case 'T':
+			if (sscanf(optarg, "%d", &telemetryLevel) != 1 || telemetryLevel < TELEMETRY_OFF
+			    || telemetryLevel > TELEMETRY_ITERATION) {
+				printf("Bad telemetry level '%s' (%d-%d).\n", optarg, TELEMETRY_OFF, TELEMETRY_ITERATION);
+				return 0;
+			}
+#ifndef TELEMETRY
+			printf("Telemetry is not compiled in, see TELEMETRY in tzaarlib.h.\n");
+#endif
+			break;
+		case 'F':
+			if (!OpenTelemetryFile(optarg)) {
+				printf("Cannot open the telemetry file '%s'.\n", optarg);
+				return 0;
+			}
+			break;
 		case 'e':
 			executeFile = (char *) malloc(sizeof(char) * (strlen(optarg) + 5));
 			strcpy(executeFile, optarg);
@@ -51,11 +108,45 @@ i32 main(i32 argc, char *argv[])
 			sscanf(optarg, "%d", &time);
 			DPRINT2("argument time limit: %d", time);
 			break;
+		case 'H':
+			if (sscanf(optarg, "%d", &megabytes) != 1 || megabytes <= 0) {
+				printf("Bad size of the transposition table '%s'.\n", optarg);
+				return 0;
+			}
+			SetTTSize(megabytes);
+			DPRINT2("argument hash: %d MB, %zu slots", megabytes, ttSize);
+			break;
+		case 'P':
+			if (sscanf(optarg, "%d", &megabytes) != 1 || megabytes <= 0) {
+				printf("Bad size of the DFPNS transposition table '%s'.\n", optarg);
+				return 0;
+			}
+			SetTT2Size(megabytes);
+			DPRINT2("argument pnshash: %d MB, %zu slots", megabytes, tt2Size);
+			break;
+		case 'j':
+			if (sscanf(optarg, "%d", &searchThreads) != 1 || searchThreads <= 0 || searchThreads > MAX_SEARCH_THREADS) {
+				printf("Bad number of search threads '%s' (1-%d).\n", optarg, MAX_SEARCH_THREADS);
+				return 0;
+			}
+			DPRINT2("argument threads: %d", searchThreads);
+			break;
 		default:
 			printf("Not known argument '%c'. Type tzaar -h for help.\n", c);
 			break;
 		}
 	}
+	if (runDaemon)
+		return RunDaemon(ai, time);
+	if (runBench)
+		return RunBench(benchDir, ai);
+	if (perftDepth > 0) {
+		if (fileWithPosition == null || LoadPosition(fileWithPosition) != OK) {
+			printf("Cannot load the position for perft, it's given by -b FILE.\n");
+			return CANNOT_LOAD_POSITION;
+		}
+		return RunPerft(perftDepth, divide, perftHash, perftCheck);
+	}
 	if (fileWithPosition == null) {
 		printf("File with a position was not specified. Printing usage:\n");
 		printHelp();
@@ -10,6 +10,9 @@
 
 #include "tzaarlib.h"
 #include "tzaarSaveLoad.h"
+#include "daemon.h"
+#include "bench.h"
+#include "perft.h"
 #include <getopt.h>
 
 static __attribute__ ((unused))
@@ -19,11 +22,22 @@ struct option long_options[] = {
 	{"help", 1, 0, 'h'},
 	{"execute", 1, 0, 'e'},
 	{"timelimit", 1, 0, 't'},
+	{"hash", 1, 0, 'H'},
+	{"pnshash", 1, 0, 'P'},
+	{"daemon", 0, 0, 'd'},
+	{"threads", 1, 0, 'j'},
+	{"bench", 2, 0, 'B'},	// only the long option, the argument (a directory) is optional
+	{"perft", 1, 0, 'p'},
+	{"divide", 0, 0, 'D'},	// long options for perft
+	{"perfthash", 0, 0, 'K'},
+	{"perftcheck", 0, 0, 'C'},
+	{"telemetry", 1, 0, 'T'},	// only long options
+	{"telemetryfile", 1, 0, 'F'},
 	{0, 0, 0, 0}
 };
 
 static __attribute__ ((unused))
-const char *options = "a:t:e:b:h";
+const char *options = "a:t:e:b:hH:P:dj:p:";
 
 i32 ProcessPosition(i32 ai, i32 time, const char *fileWithPosition, const char *fileBestMoves, const char *fileEorExecutedPos);
 
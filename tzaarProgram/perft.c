@@ -0,0 +1,220 @@
+/*
+ * The module perft counts leaves of the game tree, see perft.h. Results are
+ * printed as lines "divide F1-F2 N" and "perft depth D leaves N ...", failed
+ * checks as lines "error perft ...".
+ *
+ * Author: Pavel Veselý
+ * License: GPL v3, see license.txt
+*/
+#include "perft.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+static PerftEntry *perftTable;	// null if perft isn't hashed
+static size_t perftSize;	// entries in perftTable, power of two
+static bool perftCheck;
+static i32 perftErrors;		// failed checks (check runs in one thread)
+
+// The moves from the position, shared by the threads
+static PositionState perftRoot;
+static Move rootMoves[MAX_POSSIBILITIES];
+static unsigned long long rootLeaves[MAX_POSSIBILITIES];
+static i32 rootCount, rootNext, rootDepth;
+static pthread_mutex_t rootMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static double Now()
+{
+	struct timeval tv;
+	gettimeofday(&tv, null);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+/// Writes the move like "A1-B2" or "pass" to buffer, which has at least 8 chars
+static void MoveToString(Move * move, char *buffer)
+{
+	if (move->from == -1)
+		strcpy(buffer, "pass");
+	else
+		sprintf(buffer, "%s-%s", IndexToFieldName(move->from), IndexToFieldName(move->to));
+}
+
+static void ReportError(Move * move, i32 depth, const char *what)
+{
+	char m[8];
+	MoveToString(move, m);
+	printf("error perft %s after %s with depth %d left\n", what, m, depth);
+	fflush(stdout);
+	perftErrors++;
+}
+
+/// Compares properties updated by ExecuteMove with their computation from scratch
+static void CheckExecutedMove(Move * move, i32 depth)
+{
+	PositionState incremental, counted;
+	memset(&incremental, 0, sizeof(incremental));	// padding is compared too
+	memset(&counted, 0, sizeof(counted));
+	SavePositionState(&incremental);
+	turnNumber++;		// counting ZOC generates moves, the ply of the move being checked must not be overwritten
+	CountBitboards();
+	CountLineOccupancy();
+	CountZoneOfControl();
+	CountHash();
+	turnNumber--;
+	SavePositionState(&counted);
+	RestorePositionState(&incremental);
+	if (incremental.hash != counted.hash)
+		ReportError(move, depth, "hash differs");
+#ifdef BITBOARDS
+	if (incremental.occupiedBitboard != counted.occupiedBitboard
+	    || memcmp(incremental.colourBitboards, counted.colourBitboards, sizeof(counted.colourBitboards)) != 0
+	    || memcmp(incremental.stoneBitboards, counted.stoneBitboards, sizeof(counted.stoneBitboards)) != 0)
+		ReportError(move, depth, "bitboards differ");
+#endif
+#ifdef LINE_TABLES
+	if (memcmp(incremental.lineOccupancy, counted.lineOccupancy, sizeof(counted.lineOccupancy)) != 0)
+		ReportError(move, depth, "line occupancy differs");
+#endif
+	if (memcmp(incremental.zoneOfControl, counted.zoneOfControl, sizeof(counted.zoneOfControl)) != 0
+	    || memcmp(incremental.threatenByCounts, counted.threatenByCounts, sizeof(counted.threatenByCounts)) != 0)
+		ReportError(move, depth, "ZOC differs");
+}
+
+/// Executes the move, counts leaves under it in depth - 1 and reverts it
+inline __attribute__ ((always_inline))
+unsigned long long PerftMove(Move * move, i32 depth)
+{
+	PositionState before, after;
+	if (perftCheck) {
+		memset(&before, 0, sizeof(before));
+		SavePositionState(&before);
+	}
+	ExecuteMove(move);
+	if (perftCheck)
+		CheckExecutedMove(move, depth);
+	unsigned long long leaves = 0;
+	if (depth == 1)
+		leaves = 1;	// also when the game ended
+	else if (value == 0)
+		leaves = Perft(depth - 1);
+	RevertLastMove();
+	if (perftCheck) {
+		memset(&after, 0, sizeof(after));
+		SavePositionState(&after);
+		if (memcmp(&before, &after, sizeof(after)) != 0)
+			ReportError(move, depth, "position not restored by RevertLastMove");
+	}
+	return leaves;
+}
+
+/// Returns the number of leaves in depth half-moves from the current position
+unsigned long long Perft(i32 depth)
+{
+	if (depth == 0)
+		return 1;
+	thash key = 0;
+	PerftEntry *entry = null;
+	if (perftTable != null && depth >= 2) {
+		key = hash ^ (moveNumber == 2 ? PERFT_MOVE2_KEY : 0);
+		entry = &perftTable[key & (perftSize - 1)];
+		PerftEntry saved = *entry;	// copy, other threads may write the entry meanwhile
+		if ((saved.lock ^ saved.data) == key && (i32) (saved.data & 0xFF) == depth)
+			return saved.data >> 8;
+	}
+	Move *moves;
+	i32 count = GenerateAllMoves(&moves);
+	unsigned long long leaves = 0;
+	if (depth == 1 && !perftCheck) {
+		leaves = count;	// all generated moves are legal
+	} else {
+		for (Move *move = moves; move < moves + count; move++)
+			leaves += PerftMove(move, depth);
+	}
+	if (entry != null) {
+		PerftEntry e;
+		e.data = leaves << 8 | depth;
+		e.lock = key ^ e.data;
+		*entry = e;
+	}
+	return leaves;
+}
+
+/// Takes moves from the position until all are searched, runs in all threads of perft
+static void *PerftWorker(void *unused __attribute__ ((unused)))
+{
+	RestorePositionState(&perftRoot);
+	while (true) {
+		pthread_mutex_lock(&rootMutex);
+		i32 i = rootNext++;
+		pthread_mutex_unlock(&rootMutex);
+		if (i >= rootCount)
+			break;
+		Move move = rootMoves[i];	// a copy, ExecuteMove writes into the move
+		rootLeaves[i] = PerftMove(&move, rootDepth);
+	}
+	return null;
+}
+
+/// Counts leaves to the depth from the current position and prints them (for every move if divide is true).
+/// Returns OK, or ERROR if a check failed or the table cannot be allocated.
+i32 RunPerft(i32 depth, bool divide, bool hashed, bool check)
+{
+	if (depth < 1 || depth > PERFT_MAX_DEPTH) {
+		printf("error perft depth has to be 1-%d\n", PERFT_MAX_DEPTH);
+		fflush(stdout);
+		return ERROR;
+	}
+	perftCheck = check;
+	perftErrors = 0;
+	if (hashed) {
+		size_t bytes = ttSize * sizeof(TTBucket);	// the memory of TT
+		perftTable = (PerftEntry *) AllocateTable(bytes);
+		if (perftTable == null) {
+			printf("error perft cannot allocate the table\n");
+			fflush(stdout);
+			return ERROR;
+		}
+		perftSize = bytes / sizeof(PerftEntry);
+	}
+	double start = Now();
+	rootCount = 0;
+	if (value == 0 && !IsEndOfGame()) {
+		Move *moves;
+		rootCount = GenerateAllMoves(&moves);
+		memcpy(rootMoves, moves, rootCount * sizeof(Move));
+	}
+	rootNext = 0;
+	rootDepth = depth;
+	SavePositionState(&perftRoot);
+	i32 threads = check ? 1 : MIN(searchThreads, MAX(rootCount, 1));	// check counts from scratch in shared tables
+	pthread_t helpers[MAX_SEARCH_THREADS];
+	i32 started = 0;
+	FOR(i, 1, threads) {
+		if (pthread_create(&helpers[started], null, PerftWorker, null) != 0)
+			break;
+		started++;
+	}
+	PerftWorker(null);
+	FOR(i, 0, started) pthread_join(helpers[i], null);
+	double duration = Now() - start;
+	unsigned long long leaves = 0;
+	FOR(i, 0, rootCount) {
+		leaves += rootLeaves[i];
+		if (divide) {
+			char m[8];
+			MoveToString(&rootMoves[i], m);
+			printf("divide %s %llu\n", m, rootLeaves[i]);
+		}
+	}
+	printf("perft depth %d leaves %llu time %0.3f leaves/s %0.0f threads %d%s%s\n", depth, leaves, duration,
+	       leaves / MAX(duration, 1e-6), 1 + started, hashed ? " hashed" : "", check ? " checked" : "");
+	fflush(stdout);
+	if (hashed) {
+		FreeTable(perftTable, perftSize * sizeof(PerftEntry));
+		perftTable = null;
+	}
+	return perftErrors == 0 ? OK : ERROR;
+}
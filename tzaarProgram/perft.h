@@ -0,0 +1,36 @@
+/*
+ * The header file for module perft which counts leaves of the game tree to
+ * a given depth in half-moves (perft). Counts are an exact oracle for the move
+ * generator, ExecuteMove and RevertLastMove: any two implementations must give
+ * the same numbers. A position where the game ended is a leaf only at the last
+ * half-move; the game tree ends there.
+ * Modes:
+ *   divide  counts for every move from the position are printed
+ *   hash    subtrees are looked up in a table of the size of TT (-H) by the hash,
+ *           the move number and the depth (fast, exact up to 64-bit hash collisions)
+ *   check   after every move the hash, bitboards, line occupancy and ZOC are compared
+ *           with their computation from scratch and after every revert the whole
+ *           position with the position before the move (slow, single thread)
+ * With -j the moves from the position are shared by the threads.
+ *
+ * Author: Pavel Veselý
+ * License: GPL v3, see license.txt
+*/
+#ifndef PERFT_H_INCLUDED
+#define PERFT_H_INCLUDED
+
+#include "tzaarlib.h"
+
+#define PERFT_MAX_DEPTH 40
+#define PERFT_MOVE2_KEY 0x9E3779B97F4A7C15ULL	// xored into the key of positions in the second move of a turn
+
+typedef struct perftEntry {	// 16 bytes, the table is shared by threads without locks
+	thash lock;		// key ^ data, so that an entry torn by concurrent writes doesn't match
+	unsigned long long data;	// leaves << 8 | depth
+} PerftEntry;
+
+unsigned long long PerftMove(Move * move, i32 depth);
+unsigned long long Perft(i32 depth);
+i32 RunPerft(i32 depth, bool divide, bool hashed, bool check);
+
+#endif				// PERFT_H_INCLUDED
@@ -15,75 +15,137 @@
 #include <ctype.h>
 #include <sys/time.h>
 
-u32 maxDfpnsSearchedNodes;
+THREAD_LOCAL u32 maxDfpnsSearchedNodes;
+THREAD_LOCAL TT2Bucket *DFPNSTranspositionTable;
+i32 pnsThreads = 1;
+THREAD_LOCAL bool pnsHelper;
+volatile u8 pnsBusy[PNS_BUSY_SIZE];
+size_t tt2Size = TT2SIZE;
 
+/// Sets the size of TT2 to the largest power of two which fits into megabytes, tables are allocated later by InitTT2
+void SetTT2Size(u32 megabytes)
+{
+	size_t bytes = (size_t) megabytes << 20;
+	tt2Size = 1;
+	while (2 * tt2Size * sizeof(TT2Bucket) <= bytes)
+		tt2Size *= 2;
+}
+
+/// Allocate TT2 for the current thread if it's not done yet, returns false if there is not enough memory
+bool InitTT2()
+{
+	if (DFPNSTranspositionTable == null)
+		DFPNSTranspositionTable = (TT2Bucket *) AllocateTable(tt2Size * sizeof(TT2Bucket));
+	return DFPNSTranspositionTable != null;
+}
+
+/// Frees TT2 of the current thread, InitTT2 allocates a new zeroed table for the next search
+void ClearTT2()
+{
+	if (DFPNSTranspositionTable != null)
+		FreeTable(DFPNSTranspositionTable, tt2Size * sizeof(TT2Bucket));
+	DFPNSTranspositionTable = null;
+}
+
+/// Xor of the data of the entry, it's xored into the stored hash so that an entry torn by concurrent writes
+/// of two threads doesn't match the position (TT2 is shared without locks by DFPNS threads)
 inline __attribute__ ((always_inline))
-TT2Entry *LookupPositionInTT2()
+thash TT2EntryChecksum(TT2Entry * entry)
 {
-	u32 index = hash % TT2SIZE;
-	if (DFPNSTranspositionTable[index] != null && DFPNSTranspositionTable[index]->hash == hash)
-		return DFPNSTranspositionTable[index];
-	else if (DFPNSTranspositionTable[index + TT2SIZE] != null
-		 && DFPNSTranspositionTable[index + TT2SIZE]->hash == hash)
-		return DFPNSTranspositionTable[index + TT2SIZE];
-	else
-		return null;
+	return ((thash) entry->pn | (thash) entry->dn << 32) ^ ((thash) entry->minWinningDepth | (thash) entry->maxLosingDepth << 32)
+	    ^ ((thash) entry->searchedNodes | (thash) entry->generation << 32);
 }
 
+/// Finds the position in TT2 and copies it into entry, returns entry or null if the position isn't saved
 inline __attribute__ ((always_inline))
-void FreeTT2Entry(TT2Entry * entry)
+TT2Entry *LookupPositionInTT2(TT2Entry * entry)
 {
-	ASSERT2(entry != null, "entry to free null");
-	DBG(entry2Alive--);
-	free(entry);
+	TT2Bucket *bucket = &DFPNSTranspositionTable[hash & (tt2Size - 1)];
+	TCOUNT(ttProbes);
+	for (TT2Entry * shared = bucket->entries; shared < bucket->entries + TT2_BUCKET_SIZE; shared++) {
+		*entry = *shared;	// copy, other threads may write the entry meanwhile
+		if ((entry->pn | entry->dn) == 0)
+			break;
+		if ((entry->hash ^ TT2EntryChecksum(entry)) == hash) {
+			entry->hash = hash;
+			TCOUNT(ttHits);
+			return entry;
+		}
+	}
+	return null;
 }
 
+/// Size of the subtree of the entry, quartered for each search since the entry was saved
+inline __attribute__ ((always_inline))
+u32 TT2EntryWorth(TT2Entry * entry)
+{
+	u32 age = searchGeneration - entry->generation;
+	return age >= 16 ? 0 : entry->searchedNodes >> (2 * age);
+}
+
+/// The entry of the same position is overwritten by larger search, otherwise an empty entry
+/// or the one with the least worth in the bucket is replaced
 inline __attribute__ ((always_inline))
 void AddPositionToTT2(u32 pn, u32 dn, u32 minWinningDepth, u32 maxLosingDepth, u32 searchedNodes)
 {
-	u32 index = hash % TT2SIZE;
-	if (DFPNSTranspositionTable[index] != null && DFPNSTranspositionTable[index]->hash == hash) {
-		if (searchedNodes > DFPNSTranspositionTable[index]->searchedNodes) {
-			DFPNSTranspositionTable[index]->searchedNodes = searchedNodes;
-			DFPNSTranspositionTable[index]->pn = pn;
-			DFPNSTranspositionTable[index]->dn = dn;
-			DFPNSTranspositionTable[index]->minWinningDepth = minWinningDepth;
-			DFPNSTranspositionTable[index]->maxLosingDepth = maxLosingDepth;
+	ASSERT2(pn != 0 || dn != 0, "saving TT2 entry with pn == dn == 0");
+	TT2Bucket *bucket = &DFPNSTranspositionTable[hash & (tt2Size - 1)];
+	TT2Entry *replace = null;
+	u32 replaceWorth = 0;
+	for (TT2Entry * shared = bucket->entries; shared < bucket->entries + TT2_BUCKET_SIZE; shared++) {
+		TT2Entry entry = *shared;
+		if ((entry.pn | entry.dn) == 0) {	// entries are never removed, so there are no more entries in the bucket
+			DBG(entry2Alive++);
+			replace = shared;
+			break;
 		}
-		return;
-	}
-	if (DFPNSTranspositionTable[index + TT2SIZE] != null && DFPNSTranspositionTable[index + TT2SIZE]->hash == hash) {
-		if (searchedNodes > DFPNSTranspositionTable[index + TT2SIZE]->searchedNodes) {
-			DFPNSTranspositionTable[index + TT2SIZE]->searchedNodes = searchedNodes;
-			DFPNSTranspositionTable[index + TT2SIZE]->pn = pn;
-			DFPNSTranspositionTable[index + TT2SIZE]->dn = dn;
-			DFPNSTranspositionTable[index + TT2SIZE]->minWinningDepth = minWinningDepth;
-			DFPNSTranspositionTable[index + TT2SIZE]->maxLosingDepth = maxLosingDepth;
+		if ((entry.hash ^ TT2EntryChecksum(&entry)) == hash) {
+			if (searchedNodes <= entry.searchedNodes) {
+				entry.generation = searchGeneration;
+				entry.hash = hash ^ TT2EntryChecksum(&entry);
+				*shared = entry;
+				return;
+			}
+			replace = shared;
+			break;
 		}
-		return;
-	}
-	TT2Entry *entry = MALLOC(TT2Entry);
-	DBG(entry2Alive++);
-	entry->pn = pn;
-	entry->dn = dn;
-	entry->minWinningDepth = minWinningDepth;
-	entry->maxLosingDepth = maxLosingDepth;
-	entry->hash = hash;
-	entry->searchedNodes = searchedNodes;
-	TT2Entry *toSave = entry;
-	if (DFPNSTranspositionTable[index] == null || DFPNSTranspositionTable[index]->searchedNodes < searchedNodes) {
-		toSave = DFPNSTranspositionTable[index];
-		DFPNSTranspositionTable[index] = entry;
-	}
-	if (toSave != null) {	// this holds: DFPNSTranspositionTable[index]->searchedNodes > DFPNSTranspositionTable[index + TT2SIZE]->searchedNodes
-		TT2Entry *old = DFPNSTranspositionTable[index + TT2SIZE];
-		DFPNSTranspositionTable[index + TT2SIZE] = toSave;
-		if (old != null) {
-			FreeTT2Entry(old);
-			DBG(tt2Kick++);
-			DPRINT2("tt2 kick");
+		u32 worth = TT2EntryWorth(&entry);
+		if (replace == null || worth < replaceWorth) {
+			replace = shared;
+			replaceWorth = worth;
 		}
 	}
+	DBG(if ((replace->pn | replace->dn) != 0 && (replace->hash ^ TT2EntryChecksum(replace)) != hash) tt2Kick++);
+	TT2Entry entry;
+	entry.pn = pn;
+	entry.dn = dn;
+	entry.minWinningDepth = minWinningDepth;
+	entry.maxLosingDepth = maxLosingDepth;
+	entry.searchedNodes = searchedNodes;
+	entry.generation = searchGeneration;
+	entry.hash = hash ^ TT2EntryChecksum(&entry);
+	*replace = entry;
+}
+
+/// Counts the DFPNS threads in the child position, it's called before and after searching the child (busy is 1 or -1)
+inline __attribute__ ((always_inline))
+void MarkBusyInPNS(i32 busy)
+{
+	if (pnsThreads > 1)
+		__sync_fetch_and_add(&pnsBusy[hash & (PNS_BUSY_SIZE - 1)], busy);
+}
+
+/// Virtual proof number of the current position: pn of a child searched by other threads is multiplied by
+/// (1 + their number), so that helpers select different children. It only chooses the child to expand, TT2 gets
+/// the real proof numbers. The main thread keeps the real proof numbers, otherwise it may leave the most proving
+/// child to a helper and never finish it. Proven and disproven children are not changed.
+inline __attribute__ ((always_inline))
+u32 VirtualPN(u32 pn)
+{
+	if (!pnsHelper || pn == 0 || pn >= PNS_INFINITY)	// INFINITY is float here because of math.h
+		return pn;
+	uint64_t vpn = (uint64_t) pn * (1 + pnsBusy[hash & (PNS_BUSY_SIZE - 1)]);
+	return vpn >= PNS_INFINITY ? PNS_INFINITY - 1 : (u32) vpn;
 }
 
 /// dfpns without enhancements
@@ -92,15 +154,16 @@ FullMove *dfpns(u32 depth, u32 tpn, u32 tdn)
 	u32 initSearchedNodes = searchedNodes;
 	DPRINT2("PNS: player %d tpn %d tdn %d depth %d searched %u", player, tpn, tdn, depth, searchedNodes);
 	ASSERT2(!IsEndOfGame(), "pns starting in a final position, val %d, depth %d", value, depth);
-	Move *move, *move2, *curr, *curr2, *tmp;
-	Move *maxLooseMove1 = null, *maxLooseMove2 = null;	// for counting the best move in lost position
-	GenerateAllMovesSorted(&move);
+	Move *moves, *moves2;
+	Move maxLooseMove1, maxLooseMove2;	// for counting the best move in lost position, copies of moves
+	maxLooseMove1.from = maxLooseMove2.from = NO_MOVE;
+	i32 count = GenerateAllMovesSorted(&moves);
 	while (1) {
-		curr = move;
-		Move *minPNm1 = null, *minPNm2 = null;
-		u32 minPN = INFINITY, minPN2 = INFINITY, sumDN = 0, minDN = INFINITY, moveCount = 0;
+		Move *minPNm1 = null;
+		Move minPNm2;	// a copy, the second moves are generated again for the next first move
+		u32 minPN = INFINITY, minVPN = PNS_INFINITY, minVPN2 = PNS_INFINITY, sumDN = 0, minDN = INFINITY, moveCount = 0;
 		u32 minWinningDepth = INFINITY, maxLosingDepth = 0;	// for counting the best move in lost position
-		while (curr != null) {
+		for (Move *curr = moves; curr < moves + count; curr++) {
 			ExecuteMove(curr);
 			i32 plVal = player * value;
 			if (plVal == WIN) {
@@ -108,25 +171,19 @@ FullMove *dfpns(u32 depth, u32 tpn, u32 tdn)
 				//imediate pruning
 				RevertLastMove();
 				DPRINT2("PNS: pruning fast after one move, depth %d, minPN 0, sumDN INFTY", depth);
-				if (minPNm2 != null) {
-					FreeMove(minPNm2);
-				}
 				AddPositionToTT2(0, INFINITY, 1, INFINITY, 1);	//searchedNodes - initSearchedNodes == 0
 				if (depth == 1) {
-					FreeAllMoves(move, curr);
 					FullMove *fm = MALLOC(FullMove);
-					fm->m1 = curr;
-					fm->m2 = null;
+					fm->m1 = *curr;
+					fm->m2.from = NO_MOVE;
 					return fm;
 				} else {
-					FreeAllMovesWithoutException(move);
 					return null;
 				}
 			}
 			else {
-				GenerateAllMovesSorted(&move2);
-				curr2 = move2;
-				while (curr2 != null) {
+				i32 count2 = GenerateAllMovesSorted(&moves2);
+				for (Move *curr2 = moves2; curr2 < moves2 + count2; curr2++) {
 					ExecuteMove(curr2);
 					searchedNodes++;
 					u32 pn, dn, winningDepth, losingDep;	// pn and dn are swaped between tree layers
@@ -142,27 +199,20 @@ FullMove *dfpns(u32 depth, u32 tpn, u32 tdn)
 							RevertLastMove();
 							DPRINT2("PNS: pruning fast, depth %d, minPN 0, sumDN INFTY",
 								depth);
-							if (minPNm2 != null) {
-								FreeMove(minPNm2);
-							}
 							AddPositionToTT2(0, INFINITY, 2, INFINITY, 2);	//searchedNodes - initSearchedNodes == 0; 2 is depth
 							if (depth == 1) {
-								FreeAllMovesWithoutException(curr2->next);
-								FreeAllMoves(move, curr);
 								FullMove *fm = MALLOC(FullMove);
-								fm->m1 = curr;
-								fm->m2 = curr2;
+								fm->m1 = *curr;
+								fm->m2 = *curr2;
 								return fm;
 							} else {
-								FreeAllMovesWithoutException(curr2);
-								FreeAllMovesWithoutException(move);
 								return null;
 							}
 						}
 					} else {
-						TT2Entry *entry2 = LookupPositionInTT2();
+						TT2Entry savedEntry2;
+						TT2Entry *entry2 = LookupPositionInTT2(&savedEntry2);
 						if (entry2 != null) {
-							DBG(tt2Found++);
 							pn = entry2->dn;
 							dn = entry2->pn;
 							winningDepth = entry2->maxLosingDepth + 2;
@@ -177,13 +227,14 @@ FullMove *dfpns(u32 depth, u32 tpn, u32 tdn)
 						}
 					}
 					moveCount++;
+					u32 vpn = VirtualPN(pn);	// only for choosing the child, TT2 gets the real pn
 
 					if (winningDepth < minWinningDepth)
 						minWinningDepth = winningDepth;
 					if (losingDep > maxLosingDepth) {
 						maxLosingDepth = losingDep;
-						maxLooseMove1 = curr;
-						maxLooseMove2 = CloneMove(curr2);	// otherwise it will be deallocated
+						maxLooseMove1 = *curr;
+						maxLooseMove2 = *curr2;
 					}
 
 					ASSERT2(dn <= INFINITY && dn >= 0, "dn > INFINITY, dn = %d", dn);
@@ -192,13 +243,12 @@ FullMove *dfpns(u32 depth, u32 tpn, u32 tdn)
 						sumDN = INFINITY;
 					else sumDN += dn; // not weak
 
-					if (pn < minPN || (pn == minPN && dn < minDN)) {
-						minPN2 = minPN;
+					if (pn < minPN)
 						minPN = pn;
+					if (vpn < minVPN || (vpn == minVPN && dn < minDN)) {
+						minVPN2 = minVPN;
+						minVPN = vpn;
 						minDN = dn;
-						if (minPNm2 != null) {
-							FreeMove(minPNm2);
-						}
 						if (minPN == 0) {	// pruning
 							RevertLastMove();
 							RevertLastMove();
@@ -208,63 +258,49 @@ FullMove *dfpns(u32 depth, u32 tpn, u32 tdn)
 							AddPositionToTT2(minPN, sumDN, minWinningDepth, maxLosingDepth,
 									 searchedNodes - initSearchedNodes);
 							if (depth == 1) {
-								FreeAllMovesWithoutException(curr2->next);
-								FreeAllMoves(move, curr);
 								FullMove *fm = MALLOC(FullMove);
-								fm->m1 = curr;
-								fm->m2 = curr2;
+								fm->m1 = *curr;
+								fm->m2 = *curr2;
 								return fm;
 							} else {
-								FreeAllMovesWithoutException(curr2);
-								FreeAllMovesWithoutException(move);
 								return null;
 							}
 						}
 						minPNm1 = curr;
-						minPNm2 = curr2;
-					} else if (pn < minPN2)
-						minPN2 = pn;
+						minPNm2 = *curr2;
+					} else if (vpn < minVPN2)
+						minVPN2 = vpn;
 					RevertLastMove();
-					tmp = curr2;
-					curr2 = curr2->next;
-					if (tmp != minPNm2)
-						FreeMove(tmp);
 				}
 			}
 			RevertLastMove();
-			curr = curr->next;
 		}
 		ASSERT2(minPN > 0, "dfpns: minPN should be > 0, but it's %d", minPN);
-		if (sumDN == 0 || sumDN >= tdn || minPN >= tpn || searchedNodes > maxDfpnsSearchedNodes) {
+		if (sumDN == 0 || sumDN >= tdn || minPN >= tpn || searchedNodes > maxDfpnsSearchedNodes || SEARCH_ABORTED()) {
 			AddPositionToTT2(minPN, sumDN, minWinningDepth, maxLosingDepth, searchedNodes - initSearchedNodes);
 			if (depth == 1 && sumDN == 0) {
 				DPRINT("I'm loser and max losing depth is %d", maxLosingDepth);
-				DPRINT("move 1: f %d t %d", maxLooseMove1->from, maxLooseMove1->to);
-				DPRINT("move 2: f %d t %d", maxLooseMove2->from, maxLooseMove2->to);
-				FreeAllMoves(move, maxLooseMove1);
-				if (minPNm2 != null)
-					FreeMove(minPNm2);
+				DPRINT("move 1: f %d t %d", maxLooseMove1.from, maxLooseMove1.to);
+				DPRINT("move 2: f %d t %d", maxLooseMove2.from, maxLooseMove2.to);
 				FullMove *fm = MALLOC(FullMove);
 				fm->m1 = maxLooseMove1;
 				fm->m2 = maxLooseMove2;
 				return fm;
 			} else {
-				if (minPNm2 != null)
-					FreeMove(minPNm2);
 				ASSERT2(minPN > 0, "exiting dfpns and minPN %d", minPN);
-				FreeAllMovesWithoutException(move);
 				return null;
 			}
 		}
-		u32 ntdn = MIN(tpn, 1 + minPN2);
-		if (minPN2 == INFINITY)
+		u32 ntdn = MIN(tpn, 1 + minVPN2);
+		if (minVPN2 == PNS_INFINITY)
 			ntdn = tpn;
 		ExecuteMove(minPNm1);
-		ExecuteMove(minPNm2);
+		ExecuteMove(&minPNm2);
+		MarkBusyInPNS(1);
 		dfpns(depth + 1, tdn - sumDN + minDN, ntdn);
+		MarkBusyInPNS(-1);
 		RevertLastMove();
 		RevertLastMove();
-		FreeMove(minPNm2);
 	}
 }
 
@@ -274,15 +310,16 @@ FullMove *dfpnsEpsTrick(u32 depth, u32 tpn, u32 tdn)
 	u32 initSearchedNodes = searchedNodes;
 	DPRINT2("PNS: player %d tpn %d tdn %d depth %d searched %u", player, tpn, tdn, depth, searchedNodes);
 	ASSERT2(!IsEndOfGame(), "pns starting in a final position, val %d, depth %d", value, depth);
-	Move *move, *move2, *curr, *curr2, *tmp;
-	Move *maxLooseMove1 = null, *maxLooseMove2 = null;	// for counting the best move in lost position
-	GenerateAllMovesSorted(&move);
+	Move *moves, *moves2;
+	Move maxLooseMove1, maxLooseMove2;	// for counting the best move in lost position, copies of moves
+	maxLooseMove1.from = maxLooseMove2.from = NO_MOVE;
+	i32 count = GenerateAllMovesSorted(&moves);
 	while (1) {
-		curr = move;
-		Move *minPNm1 = null, *minPNm2 = null;
-		u32 minPN = INFINITY, minPN2 = INFINITY, sumDN = 0, minDN = INFINITY, moveCount = 0;
+		Move *minPNm1 = null;
+		Move minPNm2;	// a copy, the second moves are generated again for the next first move
+		u32 minPN = INFINITY, minVPN = PNS_INFINITY, minVPN2 = PNS_INFINITY, sumDN = 0, minDN = INFINITY, moveCount = 0;
 		u32 minWinningDepth = INFINITY, maxLosingDepth = 0;	// for counting the best move in lost position
-		while (curr != null) {
+		for (Move *curr = moves; curr < moves + count; curr++) {
 			ExecuteMove(curr);
 			i32 plVal = player * value;
 			if (plVal == WIN) {
@@ -290,25 +327,19 @@ FullMove *dfpnsEpsTrick(u32 depth, u32 tpn, u32 tdn)
 				//imediate pruning
 				RevertLastMove();
 				DPRINT2("PNS: pruning fast after one move, depth %d, minPN 0, sumDN INFTY", depth);
-				if (minPNm2 != null) {
-					FreeMove(minPNm2);
-				}
 				AddPositionToTT2(0, INFINITY, 1, INFINITY, 1);	//searchedNodes - initSearchedNodes == 0
 				if (depth == 1) {
-					FreeAllMoves(move, curr);
 					FullMove *fm = MALLOC(FullMove);
-					fm->m1 = curr;
-					fm->m2 = null;
+					fm->m1 = *curr;
+					fm->m2.from = NO_MOVE;
 					return fm;
 				} else {
-					FreeAllMovesWithoutException(move);
 					return null;
 				}
 			}
 			else {
-				GenerateAllMovesSorted(&move2);
-				curr2 = move2;
-				while (curr2 != null) {
+				i32 count2 = GenerateAllMovesSorted(&moves2);
+				for (Move *curr2 = moves2; curr2 < moves2 + count2; curr2++) {
 					ExecuteMove(curr2);
 					searchedNodes++;
 					u32 pn, dn, winningDepth, losingDep;	// pn and dn are swaped between tree layers
@@ -324,27 +355,20 @@ FullMove *dfpnsEpsTrick(u32 depth, u32 tpn, u32 tdn)
 							RevertLastMove();
 							DPRINT2("PNS: pruning fast, depth %d, minPN 0, sumDN INFTY",
 								depth);
-							if (minPNm2 != null) {
-								FreeMove(minPNm2);
-							}
 							AddPositionToTT2(0, INFINITY, 2, INFINITY, 2);	//searchedNodes - initSearchedNodes == 0; 2 is depth
 							if (depth == 1) {
-								FreeAllMovesWithoutException(curr2->next);
-								FreeAllMoves(move, curr);
 								FullMove *fm = MALLOC(FullMove);
-								fm->m1 = curr;
-								fm->m2 = curr2;
+								fm->m1 = *curr;
+								fm->m2 = *curr2;
 								return fm;
 							} else {
-								FreeAllMovesWithoutException(curr2);
-								FreeAllMovesWithoutException(move);
 								return null;
 							}
 						}
 					} else {
-						TT2Entry *entry2 = LookupPositionInTT2();
+						TT2Entry savedEntry2;
+						TT2Entry *entry2 = LookupPositionInTT2(&savedEntry2);
 						if (entry2 != null) {
-							DBG(tt2Found++);
 							pn = entry2->dn;
 							dn = entry2->pn;
 							winningDepth = entry2->maxLosingDepth + 2;
@@ -359,13 +383,14 @@ FullMove *dfpnsEpsTrick(u32 depth, u32 tpn, u32 tdn)
 						}
 					}
 					moveCount++;
+					u32 vpn = VirtualPN(pn);	// only for choosing the child, TT2 gets the real pn
 
 					if (winningDepth < minWinningDepth)
 						minWinningDepth = winningDepth;
 					if (losingDep > maxLosingDepth) {
 						maxLosingDepth = losingDep;
-						maxLooseMove1 = curr;
-						maxLooseMove2 = CloneMove(curr2);	// otherwise it will be deallocated
+						maxLooseMove1 = *curr;
+						maxLooseMove2 = *curr2;
 					}
 
 					ASSERT2(dn <= INFINITY && dn >= 0, "dn > INFINITY, dn = %d", dn);
@@ -374,13 +399,12 @@ FullMove *dfpnsEpsTrick(u32 depth, u32 tpn, u32 tdn)
 						sumDN = INFINITY;
 					else sumDN += dn; // not weak
 
-					if (pn < minPN || (pn == minPN && dn < minDN)) {
-						minPN2 = minPN;
+					if (pn < minPN)
 						minPN = pn;
+					if (vpn < minVPN || (vpn == minVPN && dn < minDN)) {
+						minVPN2 = minVPN;
+						minVPN = vpn;
 						minDN = dn;
-						if (minPNm2 != null) {
-							FreeMove(minPNm2);
-						}
 						if (minPN == 0) {	// pruning
 							RevertLastMove();
 							RevertLastMove();
@@ -390,63 +414,49 @@ FullMove *dfpnsEpsTrick(u32 depth, u32 tpn, u32 tdn)
 							AddPositionToTT2(minPN, sumDN, minWinningDepth, maxLosingDepth,
 									 searchedNodes - initSearchedNodes);
 							if (depth == 1) {
-								FreeAllMovesWithoutException(curr2->next);
-								FreeAllMoves(move, curr);
 								FullMove *fm = MALLOC(FullMove);
-								fm->m1 = curr;
-								fm->m2 = curr2;
+								fm->m1 = *curr;
+								fm->m2 = *curr2;
 								return fm;
 							} else {
-								FreeAllMovesWithoutException(curr2);
-								FreeAllMovesWithoutException(move);
 								return null;
 							}
 						}
 						minPNm1 = curr;
-						minPNm2 = curr2;
-					} else if (pn < minPN2)
-						minPN2 = pn;
+						minPNm2 = *curr2;
+					} else if (vpn < minVPN2)
+						minVPN2 = vpn;
 					RevertLastMove();
-					tmp = curr2;
-					curr2 = curr2->next;
-					if (tmp != minPNm2)
-						FreeMove(tmp);
 				}
 			}
 			RevertLastMove();
-			curr = curr->next;
 		}
 		ASSERT2(minPN > 0, "dfpns: minPN should be > 0, but it's %d", minPN);
-		if (sumDN == 0 || sumDN >= tdn || minPN >= tpn || searchedNodes > maxDfpnsSearchedNodes) {
+		if (sumDN == 0 || sumDN >= tdn || minPN >= tpn || searchedNodes > maxDfpnsSearchedNodes || SEARCH_ABORTED()) {
 			AddPositionToTT2(minPN, sumDN, minWinningDepth, maxLosingDepth, searchedNodes - initSearchedNodes);
 			if (depth == 1 && sumDN == 0) {
 				DPRINT("I'm loser and max losing depth is %d", maxLosingDepth);
-				DPRINT("move 1: f %d t %d", maxLooseMove1->from, maxLooseMove1->to);
-				DPRINT("move 2: f %d t %d", maxLooseMove2->from, maxLooseMove2->to);
-				FreeAllMoves(move, maxLooseMove1);
-				if (minPNm2 != null)
-					FreeMove(minPNm2);
+				DPRINT("move 1: f %d t %d", maxLooseMove1.from, maxLooseMove1.to);
+				DPRINT("move 2: f %d t %d", maxLooseMove2.from, maxLooseMove2.to);
 				FullMove *fm = MALLOC(FullMove);
 				fm->m1 = maxLooseMove1;
 				fm->m2 = maxLooseMove2;
 				return fm;
 			} else {
-				if (minPNm2 != null)
-					FreeMove(minPNm2);
 				ASSERT2(minPN > 0, "exiting dfpns and minPN %d", minPN);
-				FreeAllMovesWithoutException(move);
 				return null;
 			}
 		}
-		u32 ntdn = MIN(tpn, 1 + minPN2 + minPN2 / DFPNS_EPS_DIV);
-		if (minPN2 == INFINITY)
+		u32 ntdn = MIN(tpn, 1 + minVPN2 + minVPN2 / DFPNS_EPS_DIV);
+		if (minVPN2 == PNS_INFINITY)
 			ntdn = tpn;
 		ExecuteMove(minPNm1);
-		ExecuteMove(minPNm2);
+		ExecuteMove(&minPNm2);
+		MarkBusyInPNS(1);
 		dfpnsEpsTrick(depth + 1, tdn - sumDN + minDN, ntdn);
+		MarkBusyInPNS(-1);
 		RevertLastMove();
 		RevertLastMove();
-		FreeMove(minPNm2);
 	}
 }
 
@@ -456,16 +466,17 @@ FullMove *weakpns(u32 depth, u32 tpn, u32 tdn)
 	u32 initSearchedNodes = searchedNodes;
 	DPRINT2("PNS: player %d tpn %d tdn %d depth %d searched %u", player, tpn, tdn, depth, searchedNodes);
 	ASSERT2(!IsEndOfGame(), "pns starting in a final position, val %d, depth %d", value, depth);
-	Move *move, *move2, *curr, *curr2, *tmp;
-	Move *maxLooseMove1 = null, *maxLooseMove2 = null;	// for counting the best move in lost position
-	GenerateAllMovesSorted(&move);
-	int currVal = materialValue + StaticValue();
+	Move *moves, *moves2;
+	Move maxLooseMove1, maxLooseMove2;	// for counting the best move in lost position, copies of moves
+	maxLooseMove1.from = maxLooseMove2.from = NO_MOVE;
+	i32 count = GenerateAllMovesSorted(&moves);
+	int currVal = CachedStaticValue();
 	while (1) {
-		curr = move;
-		Move *minPNm1 = null, *minPNm2 = null;
-		u32 minPN = INFINITY, minPN2 = INFINITY, maxDN = 0, minDN = INFINITY, moveCount = 0;
+		Move *minPNm1 = null;
+		Move minPNm2;	// a copy, the second moves are generated again for the next first move
+		u32 minPN = INFINITY, minVPN = PNS_INFINITY, minVPN2 = PNS_INFINITY, maxDN = 0, minDN = INFINITY, moveCount = 0;
 		u32 minWinningDepth = INFINITY, maxLosingDepth = 0;	// for counting the best move in lost position
-		while (curr != null) {
+		for (Move *curr = moves; curr < moves + count; curr++) {
 			ExecuteMove(curr);
 			i32 plVal = player * value;
 			if (plVal == WIN) {
@@ -473,25 +484,19 @@ FullMove *weakpns(u32 depth, u32 tpn, u32 tdn)
 				//imediate pruning
 				RevertLastMove();
 				DPRINT2("PNS: pruning fast after one move, depth %d, minPN 0, maxDN INFTY", depth);
-				if (minPNm2 != null) {
-					FreeMove(minPNm2);
-				}
 				AddPositionToTT2(0, INFINITY, 1, INFINITY, 1);	//searchedNodes - initSearchedNodes == 0
 				if (depth == 1) {
-					FreeAllMoves(move, curr);
 					FullMove *fm = MALLOC(FullMove);
-					fm->m1 = curr;
-					fm->m2 = null;
+					fm->m1 = *curr;
+					fm->m2.from = NO_MOVE;
 					return fm;
 				} else {
-					FreeAllMovesWithoutException(move);
 					return null;
 				}
 			}
 			else {
-				GenerateAllMovesSorted(&move2);
-				curr2 = move2;
-				while (curr2 != null) {
+				i32 count2 = GenerateAllMovesSorted(&moves2);
+				for (Move *curr2 = moves2; curr2 < moves2 + count2; curr2++) {
 					ExecuteMove(curr2);
 					searchedNodes++;
 					u32 pn, dn, winningDepth, losingDep;	// pn and dn are swaped between tree layers
@@ -507,27 +512,20 @@ FullMove *weakpns(u32 depth, u32 tpn, u32 tdn)
 							RevertLastMove();
 							DPRINT2("PNS: pruning fast, depth %d, minPN 0, maxDN INFTY",
 								depth);
-							if (minPNm2 != null) {
-								FreeMove(minPNm2);
-							}
 							AddPositionToTT2(0, INFINITY, 2, INFINITY, 2);	//searchedNodes - initSearchedNodes == 0; 2 is depth
 							if (depth == 1) {
-								FreeAllMovesWithoutException(curr2->next);
-								FreeAllMoves(move, curr);
 								FullMove *fm = MALLOC(FullMove);
-								fm->m1 = curr;
-								fm->m2 = curr2;
+								fm->m1 = *curr;
+								fm->m2 = *curr2;
 								return fm;
 							} else {
-								FreeAllMovesWithoutException(curr2);
-								FreeAllMovesWithoutException(move);
 								return null;
 							}
 						}
 					} else {
-						TT2Entry *entry2 = LookupPositionInTT2();
+						TT2Entry savedEntry2;
+						TT2Entry *entry2 = LookupPositionInTT2(&savedEntry2);
 						if (entry2 != null) {
-							DBG(tt2Found++);
 							pn = entry2->dn;
 							dn = entry2->pn;
 							winningDepth = entry2->maxLosingDepth + 2;
@@ -542,13 +540,14 @@ FullMove *weakpns(u32 depth, u32 tpn, u32 tdn)
 						}
 					}
 					moveCount++;
+					u32 vpn = VirtualPN(pn);	// only for choosing the child, TT2 gets the real pn
 
 					if (winningDepth < minWinningDepth)
 						minWinningDepth = winningDepth;
 					if (losingDep > maxLosingDepth) {
 						maxLosingDepth = losingDep;
-						maxLooseMove1 = curr;
-						maxLooseMove2 = CloneMove(curr2);	// otherwise it will be deallocated
+						maxLooseMove1 = *curr;
+						maxLooseMove2 = *curr2;
 					}
 
 					ASSERT2(dn <= INFINITY && dn >= 0, "dn > INFINITY, dn = %d", dn);
@@ -559,13 +558,12 @@ FullMove *weakpns(u32 depth, u32 tpn, u32 tdn)
 						maxDN = MAX(maxDN, dn);	//weak
 					//else maxDN += dn; // not weak
 
-					if (pn < minPN || (pn == minPN && dn < minDN)) {
-						minPN2 = minPN;
+					if (pn < minPN)
 						minPN = pn;
+					if (vpn < minVPN || (vpn == minVPN && dn < minDN)) {
+						minVPN2 = minVPN;
+						minVPN = vpn;
 						minDN = dn;
-						if (minPNm2 != null) {
-							FreeMove(minPNm2);
-						}
 						if (minPN == 0) {	// pruning
 							RevertLastMove();
 							RevertLastMove();
@@ -575,31 +573,22 @@ FullMove *weakpns(u32 depth, u32 tpn, u32 tdn)
 							AddPositionToTT2(minPN, maxDN, minWinningDepth, maxLosingDepth,
 									 searchedNodes - initSearchedNodes);
 							if (depth == 1) {
-								FreeAllMovesWithoutException(curr2->next);
-								FreeAllMoves(move, curr);
 								FullMove *fm = MALLOC(FullMove);
-								fm->m1 = curr;
-								fm->m2 = curr2;
+								fm->m1 = *curr;
+								fm->m2 = *curr2;
 								return fm;
 							} else {
-								FreeAllMovesWithoutException(curr2);
-								FreeAllMovesWithoutException(move);
 								return null;
 							}
 						}
 						minPNm1 = curr;
-						minPNm2 = curr2;
-					} else if (pn < minPN2)
-						minPN2 = pn;
+						minPNm2 = *curr2;
+					} else if (vpn < minVPN2)
+						minVPN2 = vpn;
 					RevertLastMove();
-					tmp = curr2;
-					curr2 = curr2->next;
-					if (tmp != minPNm2)
-						FreeMove(tmp);
 				}
 			}
 			RevertLastMove();
-			curr = curr->next;
 		}
 		if (maxDN > 0) {
 			//maxDN += moveCount - 1;	//weak (usual)
@@ -612,36 +601,31 @@ FullMove *weakpns(u32 depth, u32 tpn, u32 tdn)
 			maxDN += (moveCount - 1) * (step * WPNS_H);	// + 1
 		}
 		ASSERT2(minPN > 0, "dfpns: minPN should be > 0, but it's %d", minPN);
-		if (maxDN == 0 || maxDN >= tdn || minPN >= tpn || searchedNodes > maxDfpnsSearchedNodes) {
+		if (maxDN == 0 || maxDN >= tdn || minPN >= tpn || searchedNodes > maxDfpnsSearchedNodes || SEARCH_ABORTED()) {
 			AddPositionToTT2(minPN, maxDN, minWinningDepth, maxLosingDepth, searchedNodes - initSearchedNodes);
 			if (depth == 1 && maxDN == 0) {
 				DPRINT("I'm loser and max losing depth is %d", maxLosingDepth);
-				DPRINT("move 1: f %d t %d", maxLooseMove1->from, maxLooseMove1->to);
-				DPRINT("move 2: f %d t %d", maxLooseMove2->from, maxLooseMove2->to);
-				FreeAllMoves(move, maxLooseMove1);
-				if (minPNm2 != null)
-					FreeMove(minPNm2);
+				DPRINT("move 1: f %d t %d", maxLooseMove1.from, maxLooseMove1.to);
+				DPRINT("move 2: f %d t %d", maxLooseMove2.from, maxLooseMove2.to);
 				FullMove *fm = MALLOC(FullMove);
 				fm->m1 = maxLooseMove1;
 				fm->m2 = maxLooseMove2;
 				return fm;
 			} else {
-				if (minPNm2 != null)
-					FreeMove(minPNm2);
 				ASSERT2(minPN > 0, "exiting dfpns and minPN %d", minPN);
-				FreeAllMovesWithoutException(move);
 				return null;
 			}
 		}
-		u32 ntdn = MIN(tpn, 1 + minPN2);
-		if (minPN2 == INFINITY)
+		u32 ntdn = MIN(tpn, 1 + minVPN2);
+		if (minVPN2 == PNS_INFINITY)
 			ntdn = tpn;
 		ExecuteMove(minPNm1);
-		ExecuteMove(minPNm2);
+		ExecuteMove(&minPNm2);
+		MarkBusyInPNS(1);
 		weakpns(depth + 1, tdn - maxDN + minDN, ntdn);
+		MarkBusyInPNS(-1);
 		RevertLastMove();
 		RevertLastMove();
-		FreeMove(minPNm2);
 	}
 }
 
@@ -651,15 +635,16 @@ FullMove *dfpnsEvalBased(u32 depth, u32 tpn, u32 tdn)
 	u32 initSearchedNodes = searchedNodes;
 	DPRINT2("PNS: player %d tpn %d tdn %d depth %d searched %u", player, tpn, tdn, depth, searchedNodes);
 	ASSERT2(!IsEndOfGame(), "pns starting in a final position, val %d, depth %d", value, depth);
-	Move *move, *move2, *curr, *curr2, *tmp;
-	Move *maxLooseMove1 = null, *maxLooseMove2 = null;	// for counting the best move in lost position
-	GenerateAllMovesSorted(&move);
+	Move *moves, *moves2;
+	Move maxLooseMove1, maxLooseMove2;	// for counting the best move in lost position, copies of moves
+	maxLooseMove1.from = maxLooseMove2.from = NO_MOVE;
+	i32 count = GenerateAllMovesSorted(&moves);
 	while (1) {
-		curr = move;
-		Move *minPNm1 = null, *minPNm2 = null;
-		u32 minPN = INFINITY, minPN2 = INFINITY, sumDN = 0, minDN = INFINITY, moveCount = 0;
+		Move *minPNm1 = null;
+		Move minPNm2;	// a copy, the second moves are generated again for the next first move
+		u32 minPN = INFINITY, minVPN = PNS_INFINITY, minVPN2 = PNS_INFINITY, sumDN = 0, minDN = INFINITY, moveCount = 0;
 		u32 minWinningDepth = INFINITY, maxLosingDepth = 0;	// for counting the best move in lost position
-		while (curr != null) {
+		for (Move *curr = moves; curr < moves + count; curr++) {
 			ExecuteMove(curr);
 			i32 plVal = player * value;
 			if (plVal == WIN) {
@@ -667,25 +652,19 @@ FullMove *dfpnsEvalBased(u32 depth, u32 tpn, u32 tdn)
 				//imediate pruning
 				RevertLastMove();
 				DPRINT2("PNS: pruning fast after one move, depth %d, minPN 0, sumDN INFTY", depth);
-				if (minPNm2 != null) {
-					FreeMove(minPNm2);
-				}
 				AddPositionToTT2(0, INFINITY, 1, INFINITY, 1);	//searchedNodes - initSearchedNodes == 0
 				if (depth == 1) {
-					FreeAllMoves(move, curr);
 					FullMove *fm = MALLOC(FullMove);
-					fm->m1 = curr;
-					fm->m2 = null;
+					fm->m1 = *curr;
+					fm->m2.from = NO_MOVE;
 					return fm;
 				} else {
-					FreeAllMovesWithoutException(move);
 					return null;
 				}
 			}
 			else {
-				GenerateAllMovesSorted(&move2);
-				curr2 = move2;
-				while (curr2 != null) {
+				i32 count2 = GenerateAllMovesSorted(&moves2);
+				for (Move *curr2 = moves2; curr2 < moves2 + count2; curr2++) {
 					ExecuteMove(curr2);
 					searchedNodes++;
 					u32 pn, dn, winningDepth, losingDep;	// pn and dn are swaped between tree layers
@@ -701,27 +680,20 @@ FullMove *dfpnsEvalBased(u32 depth, u32 tpn, u32 tdn)
 							RevertLastMove();
 							DPRINT2("PNS: pruning fast, depth %d, minPN 0, sumDN INFTY",
 								depth);
-							if (minPNm2 != null) {
-								FreeMove(minPNm2);
-							}
 							AddPositionToTT2(0, INFINITY, 2, INFINITY, 2);	//searchedNodes - initSearchedNodes == 0; 2 is depth
 							if (depth == 1) {
-								FreeAllMovesWithoutException(curr2->next);
-								FreeAllMoves(move, curr);
 								FullMove *fm = MALLOC(FullMove);
-								fm->m1 = curr;
-								fm->m2 = curr2;
+								fm->m1 = *curr;
+								fm->m2 = *curr2;
 								return fm;
 							} else {
-								FreeAllMovesWithoutException(curr2);
-								FreeAllMovesWithoutException(move);
 								return null;
 							}
 						}
 					} else {
-						TT2Entry *entry2 = LookupPositionInTT2();
+						TT2Entry savedEntry2;
+						TT2Entry *entry2 = LookupPositionInTT2(&savedEntry2);
 						if (entry2 != null) {
-							DBG(tt2Found++);
 							pn = entry2->dn;
 							dn = entry2->pn;
 							winningDepth = entry2->maxLosingDepth + 2;
@@ -731,7 +703,7 @@ FullMove *dfpnsEvalBased(u32 depth, u32 tpn, u32 tdn)
 						} else {
 							//step function
 							i32 step = 0;
-							i32 val = materialValue + StaticValue();
+							i32 val = CachedStaticValue();
 							if (val >= -EFBPNS_T)
 								step++;
 							if (val >= EFBPNS_T)
@@ -744,13 +716,14 @@ FullMove *dfpnsEvalBased(u32 depth, u32 tpn, u32 tdn)
 						}
 					}
 					moveCount++;
+					u32 vpn = VirtualPN(pn);	// only for choosing the child, TT2 gets the real pn
 
 					if (winningDepth < minWinningDepth)
 						minWinningDepth = winningDepth;
 					if (losingDep > maxLosingDepth) {
 						maxLosingDepth = losingDep;
-						maxLooseMove1 = curr;
-						maxLooseMove2 = CloneMove(curr2);	// otherwise it will be deallocated
+						maxLooseMove1 = *curr;
+						maxLooseMove2 = *curr2;
 					}
 
 					ASSERT2(dn <= INFINITY && dn >= 0, "dn > INFINITY, dn = %d", dn);
@@ -759,13 +732,12 @@ FullMove *dfpnsEvalBased(u32 depth, u32 tpn, u32 tdn)
 						sumDN = INFINITY;
 					else sumDN += dn; // not weak
 
-					if (pn < minPN || (pn == minPN && dn < minDN)) {
-						minPN2 = minPN;
+					if (pn < minPN)
 						minPN = pn;
+					if (vpn < minVPN || (vpn == minVPN && dn < minDN)) {
+						minVPN2 = minVPN;
+						minVPN = vpn;
 						minDN = dn;
-						if (minPNm2 != null) {
-							FreeMove(minPNm2);
-						}
 						if (minPN == 0) {	// pruning
 							RevertLastMove();
 							RevertLastMove();
@@ -775,63 +747,49 @@ FullMove *dfpnsEvalBased(u32 depth, u32 tpn, u32 tdn)
 							AddPositionToTT2(minPN, sumDN, minWinningDepth, maxLosingDepth,
 									 searchedNodes - initSearchedNodes);
 							if (depth == 1) {
-								FreeAllMovesWithoutException(curr2->next);
-								FreeAllMoves(move, curr);
 								FullMove *fm = MALLOC(FullMove);
-								fm->m1 = curr;
-								fm->m2 = curr2;
+								fm->m1 = *curr;
+								fm->m2 = *curr2;
 								return fm;
 							} else {
-								FreeAllMovesWithoutException(curr2);
-								FreeAllMovesWithoutException(move);
 								return null;
 							}
 						}
 						minPNm1 = curr;
-						minPNm2 = curr2;
-					} else if (pn < minPN2)
-						minPN2 = pn;
+						minPNm2 = *curr2;
+					} else if (vpn < minVPN2)
+						minVPN2 = vpn;
 					RevertLastMove();
-					tmp = curr2;
-					curr2 = curr2->next;
-					if (tmp != minPNm2)
-						FreeMove(tmp);
 				}
 			}
 			RevertLastMove();
-			curr = curr->next;
 		}
 		ASSERT2(minPN > 0, "dfpns: minPN should be > 0, but it's %d", minPN);
-		if (sumDN == 0 || sumDN >= tdn || minPN >= tpn || searchedNodes > maxDfpnsSearchedNodes) {
+		if (sumDN == 0 || sumDN >= tdn || minPN >= tpn || searchedNodes > maxDfpnsSearchedNodes || SEARCH_ABORTED()) {
 			AddPositionToTT2(minPN, sumDN, minWinningDepth, maxLosingDepth, searchedNodes - initSearchedNodes);
 			if (depth == 1 && sumDN == 0) {
 				DPRINT("I'm loser and max losing depth is %d", maxLosingDepth);
-				DPRINT("move 1: f %d t %d", maxLooseMove1->from, maxLooseMove1->to);
-				DPRINT("move 2: f %d t %d", maxLooseMove2->from, maxLooseMove2->to);
-				FreeAllMoves(move, maxLooseMove1);
-				if (minPNm2 != null)
-					FreeMove(minPNm2);
+				DPRINT("move 1: f %d t %d", maxLooseMove1.from, maxLooseMove1.to);
+				DPRINT("move 2: f %d t %d", maxLooseMove2.from, maxLooseMove2.to);
 				FullMove *fm = MALLOC(FullMove);
 				fm->m1 = maxLooseMove1;
 				fm->m2 = maxLooseMove2;
 				return fm;
 			} else {
-				if (minPNm2 != null)
-					FreeMove(minPNm2);
 				ASSERT2(minPN > 0, "exiting dfpns and minPN %d", minPN);
-				FreeAllMovesWithoutException(move);
 				return null;
 			}
 		}
-		u32 ntdn = MIN(tpn, 1 + minPN2);
-		if (minPN2 == INFINITY)
+		u32 ntdn = MIN(tpn, 1 + minVPN2);
+		if (minVPN2 == PNS_INFINITY)
 			ntdn = tpn;
 		ExecuteMove(minPNm1);
-		ExecuteMove(minPNm2);
+		ExecuteMove(&minPNm2);
+		MarkBusyInPNS(1);
 		dfpnsEvalBased(depth + 1, tdn - sumDN + minDN, ntdn);
+		MarkBusyInPNS(-1);
 		RevertLastMove();
 		RevertLastMove();
-		FreeMove(minPNm2);
 	}
 }
 
@@ -841,16 +799,17 @@ FullMove *dfpnsWeakEpsEval(u32 depth, u32 tpn, u32 tdn)
 	u32 initSearchedNodes = searchedNodes;
 	DPRINT2("PNS: player %d tpn %d tdn %d depth %d searched %u", player, tpn, tdn, depth, searchedNodes);
 	ASSERT2(!IsEndOfGame(), "pns starting in a final position, val %d, depth %d", value, depth);
-	Move *move, *move2, *curr, *curr2, *tmp;
-	Move *maxLooseMove1 = null, *maxLooseMove2 = null;	// for counting the best move in lost position
-	GenerateAllMovesSorted(&move);
-	int currVal = materialValue + StaticValue();
+	Move *moves, *moves2;
+	Move maxLooseMove1, maxLooseMove2;	// for counting the best move in lost position, copies of moves
+	maxLooseMove1.from = maxLooseMove2.from = NO_MOVE;
+	i32 count = GenerateAllMovesSorted(&moves);
+	int currVal = CachedStaticValue();
 	while (1) {
-		curr = move;
-		Move *minPNm1 = null, *minPNm2 = null;
-		u32 minPN = INFINITY, minPN2 = INFINITY, maxDN = 0, minDN = INFINITY, moveCount = 0;
+		Move *minPNm1 = null;
+		Move minPNm2;	// a copy, the second moves are generated again for the next first move
+		u32 minPN = INFINITY, minVPN = PNS_INFINITY, minVPN2 = PNS_INFINITY, maxDN = 0, minDN = INFINITY, moveCount = 0;
 		u32 minWinningDepth = INFINITY, maxLosingDepth = 0;	// for counting the best move in lost position
-		while (curr != null) {
+		for (Move *curr = moves; curr < moves + count; curr++) {
 			ExecuteMove(curr);
 			i32 plVal = player * value;
 			if (plVal == WIN) {
@@ -858,25 +817,19 @@ FullMove *dfpnsWeakEpsEval(u32 depth, u32 tpn, u32 tdn)
 				//imediate pruning
 				RevertLastMove();
 				DPRINT2("PNS: pruning fast after one move, depth %d, minPN 0, maxDN INFTY", depth);
-				if (minPNm2 != null) {
-					FreeMove(minPNm2);
-				}
 				AddPositionToTT2(0, INFINITY, 1, INFINITY, 1);	//searchedNodes - initSearchedNodes == 0
 				if (depth == 1) {
-					FreeAllMoves(move, curr);
 					FullMove *fm = MALLOC(FullMove);
-					fm->m1 = curr;
-					fm->m2 = null;
+					fm->m1 = *curr;
+					fm->m2.from = NO_MOVE;
 					return fm;
 				} else {
-					FreeAllMovesWithoutException(move);
 					return null;
 				}
 			}
 			else {
-				GenerateAllMovesSorted(&move2);
-				curr2 = move2;
-				while (curr2 != null) {
+				i32 count2 = GenerateAllMovesSorted(&moves2);
+				for (Move *curr2 = moves2; curr2 < moves2 + count2; curr2++) {
 					ExecuteMove(curr2);
 					searchedNodes++;
 					u32 pn, dn, winningDepth, losingDep;	// pn and dn are swaped between tree layers
@@ -892,27 +845,20 @@ FullMove *dfpnsWeakEpsEval(u32 depth, u32 tpn, u32 tdn)
 							RevertLastMove();
 							DPRINT2("PNS: pruning fast, depth %d, minPN 0, maxDN INFTY",
 								depth);
-							if (minPNm2 != null) {
-								FreeMove(minPNm2);
-							}
 							AddPositionToTT2(0, INFINITY, 2, INFINITY, 2);	//searchedNodes - initSearchedNodes == 0; 2 is depth
 							if (depth == 1) {
-								FreeAllMovesWithoutException(curr2->next);
-								FreeAllMoves(move, curr);
 								FullMove *fm = MALLOC(FullMove);
-								fm->m1 = curr;
-								fm->m2 = curr2;
+								fm->m1 = *curr;
+								fm->m2 = *curr2;
 								return fm;
 							} else {
-								FreeAllMovesWithoutException(curr2);
-								FreeAllMovesWithoutException(move);
 								return null;
 							}
 						}
 					} else {
-						TT2Entry *entry2 = LookupPositionInTT2();
+						TT2Entry savedEntry2;
+						TT2Entry *entry2 = LookupPositionInTT2(&savedEntry2);
 						if (entry2 != null) {
-							DBG(tt2Found++);
 							pn = entry2->dn;
 							dn = entry2->pn;
 							winningDepth = entry2->maxLosingDepth + 2;
@@ -922,7 +868,7 @@ FullMove *dfpnsWeakEpsEval(u32 depth, u32 tpn, u32 tdn)
 						} else {
 							//step function
 							i32 step = 0;
-							i32 val = materialValue + StaticValue();
+							i32 val = CachedStaticValue();
 							if (val >= -EFBPNS_T)
 								step++;
 							if (val >= EFBPNS_T)
@@ -935,13 +881,14 @@ FullMove *dfpnsWeakEpsEval(u32 depth, u32 tpn, u32 tdn)
 						}
 					}
 					moveCount++;
+					u32 vpn = VirtualPN(pn);	// only for choosing the child, TT2 gets the real pn
 
 					if (winningDepth < minWinningDepth)
 						minWinningDepth = winningDepth;
 					if (losingDep > maxLosingDepth) {
 						maxLosingDepth = losingDep;
-						maxLooseMove1 = curr;
-						maxLooseMove2 = CloneMove(curr2);	// otherwise it will be deallocated
+						maxLooseMove1 = *curr;
+						maxLooseMove2 = *curr2;
 					}
 
 					ASSERT2(dn <= INFINITY && dn >= 0, "dn > INFINITY, dn = %d", dn);
@@ -952,13 +899,12 @@ FullMove *dfpnsWeakEpsEval(u32 depth, u32 tpn, u32 tdn)
 						maxDN = MAX(maxDN, dn);	//weak
 					//else maxDN += dn; // not weak
 
-					if (pn < minPN || (pn == minPN && dn < minDN)) {
-						minPN2 = minPN;
+					if (pn < minPN)
 						minPN = pn;
+					if (vpn < minVPN || (vpn == minVPN && dn < minDN)) {
+						minVPN2 = minVPN;
+						minVPN = vpn;
 						minDN = dn;
-						if (minPNm2 != null) {
-							FreeMove(minPNm2);
-						}
 						if (minPN == 0) {	// pruning
 							RevertLastMove();
 							RevertLastMove();
@@ -968,31 +914,22 @@ FullMove *dfpnsWeakEpsEval(u32 depth, u32 tpn, u32 tdn)
 							AddPositionToTT2(minPN, maxDN, minWinningDepth, maxLosingDepth,
 									 searchedNodes - initSearchedNodes);
 							if (depth == 1) {
-								FreeAllMovesWithoutException(curr2->next);
-								FreeAllMoves(move, curr);
 								FullMove *fm = MALLOC(FullMove);
-								fm->m1 = curr;
-								fm->m2 = curr2;
+								fm->m1 = *curr;
+								fm->m2 = *curr2;
 								return fm;
 							} else {
-								FreeAllMovesWithoutException(curr2);
-								FreeAllMovesWithoutException(move);
 								return null;
 							}
 						}
 						minPNm1 = curr;
-						minPNm2 = curr2;
-					} else if (pn < minPN2)
-						minPN2 = pn;
+						minPNm2 = *curr2;
+					} else if (vpn < minVPN2)
+						minVPN2 = vpn;
 					RevertLastMove();
-					tmp = curr2;
-					curr2 = curr2->next;
-					if (tmp != minPNm2)
-						FreeMove(tmp);
 				}
 			}
 			RevertLastMove();
-			curr = curr->next;
 		}
 		if (maxDN > 0) {
 			//maxDN += moveCount - 1;	//weak (usual)
@@ -1005,36 +942,31 @@ FullMove *dfpnsWeakEpsEval(u32 depth, u32 tpn, u32 tdn)
 			maxDN += (moveCount - 1) * (step * WPNS_H);	// + 1
 		}
 		ASSERT2(minPN > 0, "dfpns: minPN should be > 0, but it's %d", minPN);
-		if (maxDN == 0 || maxDN >= tdn || minPN >= tpn || searchedNodes > maxDfpnsSearchedNodes) {
+		if (maxDN == 0 || maxDN >= tdn || minPN >= tpn || searchedNodes > maxDfpnsSearchedNodes || SEARCH_ABORTED()) {
 			AddPositionToTT2(minPN, maxDN, minWinningDepth, maxLosingDepth, searchedNodes - initSearchedNodes);
 			if (depth == 1 && maxDN == 0) {
 				DPRINT("I'm loser and max losing depth is %d", maxLosingDepth);
-				DPRINT("move 1: f %d t %d", maxLooseMove1->from, maxLooseMove1->to);
-				DPRINT("move 2: f %d t %d", maxLooseMove2->from, maxLooseMove2->to);
-				FreeAllMoves(move, maxLooseMove1);
-				if (minPNm2 != null)
-					FreeMove(minPNm2);
+				DPRINT("move 1: f %d t %d", maxLooseMove1.from, maxLooseMove1.to);
+				DPRINT("move 2: f %d t %d", maxLooseMove2.from, maxLooseMove2.to);
 				FullMove *fm = MALLOC(FullMove);
 				fm->m1 = maxLooseMove1;
 				fm->m2 = maxLooseMove2;
 				return fm;
 			} else {
-				if (minPNm2 != null)
-					FreeMove(minPNm2);
 				ASSERT2(minPN > 0, "exiting dfpns and minPN %d", minPN);
-				FreeAllMovesWithoutException(move);
 				return null;
 			}
 		}
-		u32 ntdn = MIN(tpn, 1 + minPN2 + minPN2 / DFPNS_EPS_DIV);
-		if (minPN2 == INFINITY)
+		u32 ntdn = MIN(tpn, 1 + minVPN2 + minVPN2 / DFPNS_EPS_DIV);
+		if (minVPN2 == PNS_INFINITY)
 			ntdn = tpn;
 		ExecuteMove(minPNm1);
-		ExecuteMove(minPNm2);
+		ExecuteMove(&minPNm2);
+		MarkBusyInPNS(1);
 		dfpnsWeakEpsEval(depth + 1, tdn - maxDN + minDN, ntdn);
+		MarkBusyInPNS(-1);
 		RevertLastMove();
 		RevertLastMove();
-		FreeMove(minPNm2);
 	}
 }
 
@@ -1044,20 +976,21 @@ FullMove *dfpnsDynWideningEpsEval(u32 depth, u32 tpn, u32 tdn)
 	u32 initSearchedNodes = searchedNodes;
 	DPRINT2("PNS: player %d tpn %d tdn %d depth %d searched %u", player, tpn, tdn, depth, searchedNodes);
 	ASSERT2(!IsEndOfGame(), "pns starting in a final position, val %d, depth %d", value, depth);
-	Move *move, *move2, *curr, *curr2, *tmp;
-	Move *maxLooseMove1 = null, *maxLooseMove2 = null;	// for counting the best move in lost position
+	Move *moves, *moves2;
+	Move maxLooseMove1, maxLooseMove2;	// for counting the best move in lost position, copies of moves
+	maxLooseMove1.from = maxLooseMove2.from = NO_MOVE;
 	u32 maxDNArray[DWPNS_J + 1], minPNArray[DWPNS_J + 1];
-	GenerateAllMovesSorted(&move);
+	i32 count = GenerateAllMovesSorted(&moves);
 	while (1) {
-		curr = move;
-		Move *minPNm1 = null, *minPNm2 = null;
-		u32 minPN = INFINITY, minPN2 = INFINITY, maxDN = 0, minDN = INFINITY, moveCount = 0;
+		Move *minPNm1 = null;
+		Move minPNm2;	// a copy, the second moves are generated again for the next first move
+		u32 minPN = INFINITY, minVPN = PNS_INFINITY, minVPN2 = PNS_INFINITY, maxDN = 0, minDN = INFINITY, moveCount = 0;
 		u32 minWinningDepth = INFINITY, maxLosingDepth = 0;	// for counting the best move in lost position
 		FOR(i, 0, DWPNS_J) maxDNArray[i] = 0;
 		FOR(i, 0, DWPNS_J) minPNArray[i] = INFINITY + 1;
 		maxDNArray[DWPNS_J] = INFINITY + 1; // stopper
 		minPNArray[DWPNS_J] = INFINITY + 1; // stopper
-		while (curr != null) {
+		for (Move *curr = moves; curr < moves + count; curr++) {
 			ExecuteMove(curr);
 			i32 plVal = player * value;
 			if (plVal == WIN) {
@@ -1065,25 +998,19 @@ FullMove *dfpnsDynWideningEpsEval(u32 depth, u32 tpn, u32 tdn)
 				//imediate pruning
 				RevertLastMove();
 				DPRINT2("PNS: pruning fast after one move, depth %d, minPN 0, maxDN INFTY", depth);
-				if (minPNm2 != null) {
-					FreeMove(minPNm2);
-				}
 				AddPositionToTT2(0, INFINITY, 1, INFINITY, 1);	//searchedNodes - initSearchedNodes == 0
 				if (depth == 1) {
-					FreeAllMoves(move, curr);
 					FullMove *fm = MALLOC(FullMove);
-					fm->m1 = curr;
-					fm->m2 = null;
+					fm->m1 = *curr;
+					fm->m2.from = NO_MOVE;
 					return fm;
 				} else {
-					FreeAllMovesWithoutException(move);
 					return null;
 				}
 			}
 			else {
-				GenerateAllMovesSorted(&move2);
-				curr2 = move2;
-				while (curr2 != null) {
+				i32 count2 = GenerateAllMovesSorted(&moves2);
+				for (Move *curr2 = moves2; curr2 < moves2 + count2; curr2++) {
 					ExecuteMove(curr2);
 					searchedNodes++;
 					u32 pn, dn, winningDepth, losingDep;	// pn and dn are swaped between tree layers
@@ -1099,27 +1026,20 @@ FullMove *dfpnsDynWideningEpsEval(u32 depth, u32 tpn, u32 tdn)
 							RevertLastMove();
 							DPRINT2("PNS: pruning fast, depth %d, minPN 0, maxDN INFTY",
 								depth);
-							if (minPNm2 != null) {
-								FreeMove(minPNm2);
-							}
 							AddPositionToTT2(0, INFINITY, 2, INFINITY, 2);	//searchedNodes - initSearchedNodes == 0; 2 is depth
 							if (depth == 1) {
-								FreeAllMovesWithoutException(curr2->next);
-								FreeAllMoves(move, curr);
 								FullMove *fm = MALLOC(FullMove);
-								fm->m1 = curr;
-								fm->m2 = curr2;
+								fm->m1 = *curr;
+								fm->m2 = *curr2;
 								return fm;
 							} else {
-								FreeAllMovesWithoutException(curr2);
-								FreeAllMovesWithoutException(move);
 								return null;
 							}
 						}
 					} else {
-						TT2Entry *entry2 = LookupPositionInTT2();
+						TT2Entry savedEntry2;
+						TT2Entry *entry2 = LookupPositionInTT2(&savedEntry2);
 						if (entry2 != null) {
-							DBG(tt2Found++);
 							pn = entry2->dn;
 							dn = entry2->pn;
 							winningDepth = entry2->maxLosingDepth + 2;
@@ -1129,7 +1049,7 @@ FullMove *dfpnsDynWideningEpsEval(u32 depth, u32 tpn, u32 tdn)
 						} else {
 							//step function
 							i32 step = 0;
-							i32 val = materialValue + StaticValue();
+							i32 val = CachedStaticValue();
 							if (val >= -EFBPNS_T)
 								step++;
 							if (val >= EFBPNS_T)
@@ -1142,13 +1062,14 @@ FullMove *dfpnsDynWideningEpsEval(u32 depth, u32 tpn, u32 tdn)
 						}
 					}
 					moveCount++;
+					u32 vpn = VirtualPN(pn);	// only for choosing the child, TT2 gets the real pn
 
 					if (winningDepth < minWinningDepth)
 						minWinningDepth = winningDepth;
 					if (losingDep > maxLosingDepth) {
 						maxLosingDepth = losingDep;
-						maxLooseMove1 = curr;
-						maxLooseMove2 = CloneMove(curr2);	// otherwise it will be deallocated
+						maxLooseMove1 = *curr;
+						maxLooseMove2 = *curr2;
 					}
 
 					ASSERT2(dn <= INFINITY && dn >= 0, "dn > INFINITY, dn = %d", dn);
@@ -1169,13 +1090,12 @@ FullMove *dfpnsDynWideningEpsEval(u32 depth, u32 tpn, u32 tdn)
 						}
 					}
 
-					if (pn < minPN || (pn == minPN && dn < minDN)) {
-						minPN2 = minPN;
+					if (pn < minPN)
 						minPN = pn;
+					if (vpn < minVPN || (vpn == minVPN && dn < minDN)) {
+						minVPN2 = minVPN;
+						minVPN = vpn;
 						minDN = dn;
-						if (minPNm2 != null) {
-							FreeMove(minPNm2);
-						}
 						if (minPN == 0) {	// pruning
 							RevertLastMove();
 							RevertLastMove();
@@ -1185,31 +1105,22 @@ FullMove *dfpnsDynWideningEpsEval(u32 depth, u32 tpn, u32 tdn)
 							AddPositionToTT2(minPN, maxDN, minWinningDepth, maxLosingDepth,
 									 searchedNodes - initSearchedNodes);
 							if (depth == 1) {
-								FreeAllMovesWithoutException(curr2->next);
-								FreeAllMoves(move, curr);
 								FullMove *fm = MALLOC(FullMove);
-								fm->m1 = curr;
-								fm->m2 = curr2;
+								fm->m1 = *curr;
+								fm->m2 = *curr2;
 								return fm;
 							} else {
-								FreeAllMovesWithoutException(curr2);
-								FreeAllMovesWithoutException(move);
 								return null;
 							}
 						}
 						minPNm1 = curr;
-						minPNm2 = curr2;
-					} else if (pn < minPN2)
-						minPN2 = pn;
+						minPNm2 = *curr2;
+					} else if (vpn < minVPN2)
+						minVPN2 = vpn;
 					RevertLastMove();
-					tmp = curr2;
-					curr2 = curr2->next;
-					if (tmp != minPNm2)
-						FreeMove(tmp);
 				}
 			}
 			RevertLastMove();
-			curr = curr->next;
 		}
 		// dynamic widening
 		u32 sumDN = 0;
@@ -1217,35 +1128,30 @@ FullMove *dfpnsDynWideningEpsEval(u32 depth, u32 tpn, u32 tdn)
 		  sumDN += maxDNArray[i];
 		}
 		ASSERT2(minPN > 0, "dfpns: minPN should be > 0, but it's %d", minPN);
-		if (sumDN == 0 || sumDN >= tdn || minPN >= tpn || searchedNodes > maxDfpnsSearchedNodes) {
+		if (sumDN == 0 || sumDN >= tdn || minPN >= tpn || searchedNodes > maxDfpnsSearchedNodes || SEARCH_ABORTED()) {
 			AddPositionToTT2(minPN, sumDN, minWinningDepth, maxLosingDepth, searchedNodes - initSearchedNodes);
 			if (depth == 1 && sumDN == 0) {
 				DPRINT("I'm loser and max losing depth is %d", maxLosingDepth);
-				DPRINT("move 1: f %d t %d", maxLooseMove1->from, maxLooseMove1->to);
-				DPRINT("move 2: f %d t %d", maxLooseMove2->from, maxLooseMove2->to);
-				FreeAllMoves(move, maxLooseMove1);
-				if (minPNm2 != null)
-					FreeMove(minPNm2);
+				DPRINT("move 1: f %d t %d", maxLooseMove1.from, maxLooseMove1.to);
+				DPRINT("move 2: f %d t %d", maxLooseMove2.from, maxLooseMove2.to);
 				FullMove *fm = MALLOC(FullMove);
 				fm->m1 = maxLooseMove1;
 				fm->m2 = maxLooseMove2;
 				return fm;
 			} else {
-				if (minPNm2 != null)
-					FreeMove(minPNm2);
 				ASSERT2(minPN > 0, "exiting dfpns and minPN %d", minPN);
-				FreeAllMovesWithoutException(move);
 				return null;
 			}
 		}
-		u32 ntdn = MIN(tpn, 1 + minPN2 + minPN2 / DFPNS_EPS_DIV);
-		if (minPN2 == INFINITY)
+		u32 ntdn = MIN(tpn, 1 + minVPN2 + minVPN2 / DFPNS_EPS_DIV);
+		if (minVPN2 == PNS_INFINITY)
 			ntdn = tpn;
 		ExecuteMove(minPNm1);
-		ExecuteMove(minPNm2);
+		ExecuteMove(&minPNm2);
+		MarkBusyInPNS(1);
 		dfpnsDynWideningEpsEval(depth + 1, tdn - sumDN + minDN, ntdn);
+		MarkBusyInPNS(-1);
 		RevertLastMove();
 		RevertLastMove();
-		FreeMove(minPNm2);
 	}
 }
@@ -11,9 +11,11 @@
 // array for hasing
 #include "hashedpositions.h"
 
-#define INFINITY 2000000000u
+#define PNS_INFINITY 2000000000u	// proof numbers, math.h redefines INFINITY as float in files including it later
+#define INFINITY PNS_INFINITY
 
-#define TT2SIZE (1 << 20)
+#define TT2SIZE (1 << 20)	//default number of buckets in TT2 (64 MB)
+#define TT2_BUCKET_SIZE 2	//entries in one 64-byte bucket
 #define DFPNS_EPS_DIV 8
 #define DFPNS_SEARCH_NODES 10000000	//for estimating search duration
 // for eval based PNS
@@ -25,26 +27,41 @@
 #define WPNS_H 1
 // for dynamic widening
 #define DWPNS_J 5
+// for parallel DFPNS
+#define PNS_BUSY_SIZE (1 << 16)	//counters of threads in positions, indexed by hash like TT2
 
-extern u32 maxDfpnsSearchedNodes;
+extern THREAD_LOCAL u32 maxDfpnsSearchedNodes;
+extern i32 pnsThreads;		// number of threads running DFPNS, busy children are counted when it's > 1
+extern THREAD_LOCAL bool pnsHelper;	// helper threads of DFPNS use virtual proof numbers
+extern volatile u8 pnsBusy[PNS_BUSY_SIZE];	// number of threads searching a position (collisions only add noise)
 
 typedef struct tt2Entry {
-	thash hash;
-	u32 pn, dn;
+	thash hash;		// xored with TT2EntryChecksum
+	u32 pn, dn;		// pn == dn == 0 for an empty entry
 	u32 minWinningDepth, maxLosingDepth;
 	u32 searchedNodes;
-
+	u32 generation;		// searchGeneration of the last search which saved the entry
 } TT2Entry;
-TT2Entry *DFPNSTranspositionTable[2 * TT2SIZE];	//2* because of replacement schema Twobig
 
+typedef struct tt2Bucket {	// one cache line, a position can be saved only in the bucket given by its hash
+	TT2Entry entries[TT2_BUCKET_SIZE];
+} __attribute__ ((aligned(64))) TT2Bucket;
+extern THREAD_LOCAL TT2Bucket *DFPNSTranspositionTable;	// tt2Size buckets, helper threads use the table of the main one
+extern size_t tt2Size;		// power of two, set by SetTT2Size before the first search
+
+void SetTT2Size(u32 megabytes);
+bool InitTT2();
+void ClearTT2();
 FullMove *dfpns(u32 depth, u32 tpn, u32 tdn);
 FullMove *dfpnsEpsTrick(u32 depth, u32 tpn, u32 tdn);
 FullMove *weakpns(u32 depth, u32 tpn, u32 tdn);
 FullMove *dfpnsEvalBased(u32 depth, u32 tpn, u32 tdn);
 FullMove *dfpnsWeakEpsEval(u32 depth, u32 tpn, u32 tdn);
 FullMove *dfpnsDynWideningEpsEval(u32 depth, u32 tpn, u32 tdn);
-TT2Entry *LookupPositionInTT2();
-void FreeTT2Entry(TT2Entry * entry);
+thash TT2EntryChecksum(TT2Entry * entry);
+TT2Entry *LookupPositionInTT2(TT2Entry * entry);
+void MarkBusyInPNS(i32 busy);
+u32 VirtualPN(u32 pn);
 void AddPositionToTT2(u32 pn, u32 dn, u32 minWinningDepth, u32 maxLosingDepth, u32 searchedNodes);
 
 #endif				// PNS_H_INCLUDED
@@ -0,0 +1,125 @@
+/*
+ * The module telemetry writes counters of searches as JSON lines, see telemetry.h.
+ *
+ * Author: Pavel Veselý
+ * License: GPL v3, see license.txt
+*/
+#include "telemetry.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+
+THREAD_LOCAL TelemetryCounters telemetry;
+THREAD_LOCAL TelemetryCounters searchTelemetry;
+i32 telemetryLevel = TELEMETRY_OFF;
+FILE *telemetryFile;
+
+#ifdef TELEMETRY
+static TelemetryCounters helpersTelemetry;	// added by helper threads when they end
+static pthread_mutex_t telemetryMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/// Opens the file for telemetry lines (appending), returns false if it cannot be opened
+bool OpenTelemetryFile(const char *fileName)
+{
+	telemetryFile = fopen(fileName, "a");
+	return telemetryFile != null;
+}
+
+#ifdef TELEMETRY
+static void AddCounters(TelemetryCounters * to, TelemetryCounters * from)
+{
+	to->nodes += from->nodes;
+	to->ttProbes += from->ttProbes;
+	to->ttHits += from->ttHits;
+	to->ttCutoffs += from->ttCutoffs;
+	to->cutoffs += from->cutoffs;
+	to->firstMoveCutoffs += from->firstMoveCutoffs;
+	to->evalCalls += from->evalCalls;
+	to->evalCacheHits += from->evalCacheHits;
+	to->genCalls += from->genCalls;
+	to->aspirationFailLows += from->aspirationFailLows;
+	to->aspirationFailHighs += from->aspirationFailHighs;
+	to->mtdfPasses += from->mtdfPasses;
+	to->qsNodes += from->qsNodes;
+	to->lmrReductions += from->lmrReductions;
+	to->lmrReSearches += from->lmrReSearches;
+	to->futilityPrunes += from->futilityPrunes;
+}
+
+/// Writes the line beginning with the event and its fields (a JSON fragment) followed by the counters.
+/// The line is written by one call, so lines of threads don't mix.
+static void WriteLine(const char *event, const char *fields, TelemetryCounters * c)
+{
+	char line[1024];
+	snprintf(line, sizeof(line), "{\"event\":\"%s\",%s,\"nodes\":%llu,\"ttProbes\":%llu,\"ttHits\":%llu,"
+		 "\"ttCutoffs\":%llu,\"cutoffs\":%llu,\"firstMoveCutoffs\":%llu,\"evalCalls\":%llu,"
+		 "\"evalCacheHits\":%llu,\"genCalls\":%llu,\"aspirationFailLows\":%llu,\"aspirationFailHighs\":%llu,"
+		 "\"mtdfPasses\":%llu,\"qsNodes\":%llu,\"lmrReductions\":%llu,\"lmrReSearches\":%llu,\"futilityPrunes\":%llu}\n",
+		 event, fields, c->nodes, c->ttProbes, c->ttHits, c->ttCutoffs, c->cutoffs, c->firstMoveCutoffs,
+		 c->evalCalls, c->evalCacheHits, c->genCalls, c->aspirationFailLows, c->aspirationFailHighs,
+		 c->mtdfPasses, c->qsNodes, c->lmrReductions, c->lmrReSearches, c->futilityPrunes);
+	fputs(line, telemetryFile != null ? telemetryFile : stderr);
+}
+#endif
+
+/// Zeroes the counters of the thread and of its helpers, called at the beginning of GetBestMove
+void TelemetryStartSearch()
+{
+#ifdef TELEMETRY
+	memset(&telemetry, 0, sizeof(telemetry));
+	memset(&searchTelemetry, 0, sizeof(searchTelemetry));
+	pthread_mutex_lock(&telemetryMutex);
+	memset(&helpersTelemetry, 0, sizeof(helpersTelemetry));
+	pthread_mutex_unlock(&telemetryMutex);
+#endif
+}
+
+/// Ends the iteration of the main thread which searched nodes: writes its line and adds its counters to the search
+void TelemetryIteration(i32 ai __attribute__ ((unused)), i32 depth __attribute__ ((unused)),
+			u32 nodes __attribute__ ((unused)), double time __attribute__ ((unused)), i32 value __attribute__ ((unused)),
+			bool aborted __attribute__ ((unused)))
+{
+#ifdef TELEMETRY
+	telemetry.nodes += nodes;
+	if (telemetryLevel >= TELEMETRY_ITERATION) {
+		char fields[128];
+		snprintf(fields, sizeof(fields), "\"ai\":%d,\"depth\":%d,\"time\":%0.3f,\"value\":%d,\"aborted\":%s", ai,
+			 depth, time, value, aborted ? "true" : "false");
+		WriteLine("iteration", fields, &telemetry);
+	}
+	AddCounters(&searchTelemetry, &telemetry);
+	memset(&telemetry, 0, sizeof(telemetry));
+#endif
+}
+
+/// Ends the search after helper threads were stopped: adds their counters and writes the line of the search
+void TelemetrySearch(i32 ai __attribute__ ((unused)), double time __attribute__ ((unused)),
+		     i32 threads __attribute__ ((unused)))
+{
+#ifdef TELEMETRY
+	pthread_mutex_lock(&telemetryMutex);
+	AddCounters(&searchTelemetry, &helpersTelemetry);
+	memset(&helpersTelemetry, 0, sizeof(helpersTelemetry));
+	pthread_mutex_unlock(&telemetryMutex);
+	if (telemetryLevel >= TELEMETRY_SEARCH) {
+		char fields[128];
+		snprintf(fields, sizeof(fields), "\"ai\":%d,\"time\":%0.3f,\"threads\":%d,\"stones\":%d", ai, time, threads,
+			 stoneSum);
+		WriteLine("search", fields, &searchTelemetry);
+		fflush(telemetryFile != null ? telemetryFile : stderr);
+	}
+#endif
+}
+
+/// Adds the counters of a helper thread (or a YBWC worker) to the search of the main thread, called when it ends
+void TelemetryAddHelper()
+{
+#ifdef TELEMETRY
+	pthread_mutex_lock(&telemetryMutex);
+	AddCounters(&helpersTelemetry, &telemetry);
+	pthread_mutex_unlock(&telemetryMutex);
+	memset(&telemetry, 0, sizeof(telemetry));
+#endif
+}
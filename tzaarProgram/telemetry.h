@@ -0,0 +1,69 @@
+/*
+ * The header file for module telemetry which counts events of the search and
+ * writes them as JSON lines. Counters are thread-local and compiled in only with
+ * TELEMETRY (see tzaarlib.h):
+ *   nodes             nodes searched (added at the end of iterations, not in the search)
+ *   ttProbes, ttHits  lookups in TT (TT2 for DFPNS) and lookups which found the position
+ *   ttCutoffs         Alpha-beta nodes which returned the value from TT
+ *   cutoffs           Alpha-beta nodes which failed high after searching a move
+ *   firstMoveCutoffs  cutoffs by the first move searched (the PV move if there was one)
+ *   evalCalls         static evaluations computed, evalCacheHits evaluations found in the eval cache
+ *   genCalls          calls of move generators
+ *   aspirationFailLows, aspirationFailHighs  ID iterations searched again with a wider aspiration window
+ *   mtdfPasses        zero-window searches of MTD(f)
+ *   qsNodes           captures searched by the quiescence search (also counted in nodes)
+ *   lmrReductions, lmrReSearches  pairs searched to a lower depth by LMR and those of them searched again
+ *   futilityPrunes    second moves skipped by futility pruning
+ * With telemetryLevel TELEMETRY_SEARCH a line {"event":"search",...} with counters
+ * of all threads is written after every search, TELEMETRY_ITERATION adds a line
+ * {"event":"iteration",...} with counters of the main thread after every iteration
+ * of ID (every chunk of DFPNS, which has depth 0). Lines go to telemetryFile or to
+ * the standard error output; they are flushed only at the end of a search.
+ *
+ * Author: Pavel Veselý
+ * License: GPL v3, see license.txt
+*/
+#ifndef TELEMETRY_H_INCLUDED
+#define TELEMETRY_H_INCLUDED
+
+#include "tzaarlib.h"
+#include <stdio.h>
+
+// levels of telemetry output
+#define TELEMETRY_OFF 0
+#define TELEMETRY_SEARCH 1
+#define TELEMETRY_ITERATION 2
+
+typedef struct telemetryCounters {
+	unsigned long long nodes;
+	unsigned long long ttProbes, ttHits, ttCutoffs;
+	unsigned long long cutoffs, firstMoveCutoffs;
+	unsigned long long evalCalls, evalCacheHits;
+	unsigned long long genCalls;
+	unsigned long long aspirationFailLows, aspirationFailHighs;
+	unsigned long long mtdfPasses, qsNodes;
+	unsigned long long lmrReductions, lmrReSearches, futilityPrunes;
+} TelemetryCounters;
+
+extern THREAD_LOCAL TelemetryCounters telemetry;	// counters of the thread since the last iteration
+extern THREAD_LOCAL TelemetryCounters searchTelemetry;	// the last search of the thread, helper threads included
+extern i32 telemetryLevel;
+extern FILE *telemetryFile;	// null for the standard error output
+
+#ifdef TELEMETRY
+	#define TCOUNT(counter) { telemetry.counter++; }
+	// the node failed high, first is true if no move was searched before the one causing the cutoff
+	#define TCUTOFF(first) { telemetry.cutoffs++; if (first) telemetry.firstMoveCutoffs++; }
+#else
+	#define TCOUNT(counter) { }
+	#define TCUTOFF(first) { }
+#endif
+
+// FUNCTIONS
+bool OpenTelemetryFile(const char *fileName);
+void TelemetryStartSearch();
+void TelemetryIteration(i32 ai, i32 depth, u32 nodes, double time, i32 value, bool aborted);
+void TelemetrySearch(i32 ai, double time, i32 threads);
+void TelemetryAddHelper();
+
+#endif				// TELEMETRY_H_INCLUDED
@@ -0,0 +1,392 @@
+/*
+ * The tournament runner plays games between two configurations of the engine,
+ * see tournament.h. Every finished game is printed as a line "game ..." with
+ * the score so far, the match ends with the summary of the score, Elo, timeouts,
+ * average depths and nodes per second of both configurations.
+ *
+ * Author: Pavel Veselý
+ * License: GPL v3, see license.txt
+*/
+#define _GNU_SOURCE		// for sysconf
+#include "tournament.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+static PlayerConfig configs[2];	// A and B
+static PlayerStats stats[2];
+static i32 wins[2], draws;	// wins of A and B
+static i32 games = TOURNAMENT_GAMES, nextGame, finishedGames;
+static i32 openings = OPENINGS_BOTH;
+static u32 seed = 1;		// the random board of the pair p is given by seed + p
+static bool sprt;
+static double elo0, elo1;
+static volatile bool matchDecided;	// by SPRT, games not started yet are not played
+static pthread_mutex_t matchMutex = PTHREAD_MUTEX_INITIALIZER;	// guards the variables above and the output
+
+// tables of the configurations in the game of the thread, they are swapped into the tables of the search
+static THREAD_LOCAL TTBucket *sideTables[2];
+static THREAD_LOCAL TT2Bucket *sidePnsTables[2];
+static THREAD_LOCAL i32 sideHistory[2][BOARD_ARRAY_SIZE][BOARD_ARRAY_SIZE];
+
+static double Now()
+{
+	struct timeval tv;
+	gettimeofday(&tv, null);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+void printHelp()
+{
+	printf("Plays games between configurations A and B of the engine: tournament [options] A B\n");
+	printf("A configuration is a comma separated list of ai=N, time=SECONDS, nodes=N, depth=N and eval=standard|beginner,\n");
+	printf("for example \"ai=9,time=2\", see tournament.h.\n");
+	printf("\t-g N --games=N\t Number of games, pairs of games start from the same opening with colours swapped (default is %d).\n",
+	       TOURNAMENT_GAMES);
+	printf("\t-c N --concurrency=N\t Number of games played in parallel (default is the number of processors).\n");
+	printf("\t-o SETUP --openings=SETUP\t Openings: standard, random or both (default, pairs alternate them).\n");
+	printf("\t-s SEED --seed=SEED\t Seed of random openings (default is 1).\n");
+	printf("\t--sprt=ELO0,ELO1\t Stop when SPRT accepts that Elo of A - B is ELO0 or ELO1 (alpha %0.2f, beta %0.2f).\n",
+	       SPRT_ALPHA, SPRT_BETA);
+	printf("\t-H MB --hash=MB\t Size of each alpha-beta transposition table in megabytes (every game has two).\n");
+	printf("\t-P MB --pnshash=MB\t Size of each DFPNS transposition table in megabytes (every game has two).\n");
+}
+
+/// Parses the configuration string (see tournament.h), returns false if it's not valid
+bool ParsePlayerConfig(const char *s, PlayerConfig * config)
+{
+	config->name = s;
+	config->ai = MAIN_AI;
+	config->time = AI_TIME_LIMIT;
+	config->depth = 0;
+	config->nodes = 0;
+	config->evalParameters = EVAL_STANDARD;
+	while (*s != '\0') {
+		char key[16], val[32];
+		i32 len;
+		if (sscanf(s, "%15[^=,]=%31[^,]%n", key, val, &len) != 2)
+			return false;
+		s += len;
+		if (*s == ',')
+			s++;
+		i32 n;
+		if (strcmp(key, "eval") == 0) {
+			if (strcmp(val, "standard") == 0)
+				config->evalParameters = EVAL_STANDARD;
+			else if (strcmp(val, "beginner") == 0)
+				config->evalParameters = EVAL_BEGINNER;
+			else
+				return false;
+			continue;
+		}
+		if (sscanf(val, "%d", &n) != 1 || n <= 0)
+			return false;
+		if (strcmp(key, "ai") == 0)
+			config->ai = n;
+		else if (strcmp(key, "time") == 0)
+			config->time = n;
+		else if (strcmp(key, "nodes") == 0)
+			config->nodes = n;
+		else if (strcmp(key, "depth") == 0)
+			config->depth = n;
+		else
+			return false;
+	}
+	return true;
+}
+
+/// Elo difference of a player with the expected score against the opponent
+double EloFromScore(double score)
+{
+	return -400.0 * log10(1.0 / score - 1.0);
+}
+
+/// Computes the score of A, Elo of A - B with the margin of 95 % confidence and the log-likelihood ratio of SPRT
+static void MatchStatistics(double *score, double *elo, double *margin, double *llr)
+{
+	i32 n = wins[0] + wins[1] + draws;
+	*score = *elo = *margin = *llr = 0;
+	if (n == 0)
+		return;
+	double s = (wins[0] + draws / 2.0) / n;
+	double variance = (wins[0] * (1 - s) * (1 - s) + wins[1] * s * s + draws * (0.5 - s) * (0.5 - s)) / n;	// of one game
+	double deviation = sqrt(variance / n);
+	*score = s;
+	*elo = EloFromScore(s);
+	*margin = HUGE_VAL;	// Elo of score 0 or 1 is infinite
+	if (s > 0 && s < 1)
+		*margin = (EloFromScore(MIN(s + 1.96 * deviation, 1)) - EloFromScore(MAX(s - 1.96 * deviation, 0))) / 2;
+	if (variance > 0) {	// normal approximation of the trinomial SPRT
+		double s0 = 1 / (1 + pow(10, -elo0 / 400)), s1 = 1 / (1 + pow(10, -elo1 / 400));
+		*llr = n * (s1 - s0) * (2 * s - s0 - s1) / (2 * variance);
+	}
+}
+
+/// Makes the tables and settings of the configuration the ones of the search in the thread
+static void SelectSide(i32 side, u32 randomGameSeed)
+{
+	PlayerConfig *config = &configs[side];
+	TranspositionTable = sideTables[side];
+	DFPNSTranspositionTable = sidePnsTables[side];
+	memcpy(historyPruneMoves, sideHistory[side], sizeof(historyPruneMoves));
+	searchDepthLimit = config->depth;
+	searchNodeLimit = config->nodes;
+	randomSeed = randomGameSeed;
+	SetEvalParameters(config->evalParameters);
+}
+
+/// Keeps the tables of the configuration after its search (the search may allocate them)
+static void DeselectSide(i32 side)
+{
+	sideTables[side] = TranspositionTable;
+	sidePnsTables[side] = DFPNSTranspositionTable;
+	memcpy(sideHistory[side], historyPruneMoves, sizeof(historyPruneMoves));
+}
+
+/// Frees the tables of both configurations, the next game starts with empty ones
+static void ClearSides()
+{
+	FOR(side, 0, 2) {
+		TranspositionTable = sideTables[side];
+		DFPNSTranspositionTable = sidePnsTables[side];
+		ClearTT();
+		ClearTT2();
+		sideTables[side] = null;
+		sidePnsTables[side] = null;
+		memset(sideHistory[side], 0, sizeof(sideHistory[side]));
+	}
+}
+
+/// Plays the game from the current position, configuration whiteSide (0 for A, 1 for B) plays white.
+/// Returns the colour of the winner or 0 for a draw, statistics of the turns are added to gameStats.
+static i32 PlayGame(i32 game, i32 whiteSide, PlayerStats * gameStats, i32 * turns)
+{
+	Move turnMoves[2];	// the history of the game points to them, moves of the game are never reverted
+	for (*turns = 0; *turns < TOURNAMENT_MAX_TURNS; (*turns)++) {
+		i32 side = player == WHITE ? whiteSide : 1 - whiteSide;
+		PlayerConfig *config = &configs[side];
+		bool firstTurn = stoneSum == TOTAL_STONES;	// white captures only once in the first turn
+		SelectSide(side, (seed + game) * TOURNAMENT_MAX_TURNS + *turns + 1);
+		memset(&searchStats, 0, sizeof(searchStats));
+		value = 0;
+		Move *m1, *m2;
+		i32 time = config->nodes > 0 || config->depth > 0 ? TOURNAMENT_NO_TIME_LIMIT : config->time;
+		double start = Now();
+		bool found = GetBestMove(config->ai, time, &m1, &m2, true);
+		double duration = Now() - start;
+		DeselectSide(side);
+		PlayerStats *st = &gameStats[side];
+		st->turns++;
+		st->nodes += searchStats.nodes;
+		st->time += duration;
+		if (searchStats.depth > 0) {
+			st->depthSum += searchStats.depth;
+			st->depthTurns++;
+		}
+		if (time == config->time && duration > config->time * TOURNAMENT_TIMEOUT_MULT + 1)
+			st->timeouts++;
+		value = 0;
+		bool legal = found && m1 != null && IsMovePossible(m1);
+		if (legal) {
+			turnMoves[0] = *m1;
+			ExecuteMove(&turnMoves[0]);
+			if (value == 0) {
+				if (firstTurn || m2 == null)
+					turnMoves[1].from = turnMoves[1].to = -1;	// pass
+				else
+					turnMoves[1] = *m2;
+				legal = turnMoves[1].from == -1 || IsMovePossible(&turnMoves[1]);
+				if (legal)
+					ExecuteMove(&turnMoves[1]);
+			}
+		}
+		if (found) {
+			free(m1);
+			free(m2);
+		}
+		if (!legal) {
+			st->forfeits++;
+			return -player;	// the player to move forfeits
+		}
+		turnNumber = 1;	// plies of the search start from the beginning, like in the daemon
+		if (value != 0)
+			return SIGN(value);
+	}
+	return 0;
+}
+
+/// Plays games until all are started or the match is decided, runs in all threads of the tournament
+static void *GameThread(void *unused __attribute__ ((unused)))
+{
+	while (true) {
+		pthread_mutex_lock(&matchMutex);
+		i32 game = nextGame++;
+		pthread_mutex_unlock(&matchMutex);
+		if (game >= games || matchDecided)
+			break;
+		i32 pair = game / 2;
+		i32 whiteSide = game % 2;	// A is white in the first game of the pair
+		bool standard = openings == OPENINGS_STANDARD || (openings == OPENINGS_BOTH && pair % 2 == 0);
+		InitBoardSeeded(standard ? STANDARD : RANDOM, seed + pair);
+		PlayerStats gameStats[2];
+		memset(gameStats, 0, sizeof(gameStats));
+		i32 turns;
+		i32 winner = PlayGame(game, whiteSide, gameStats, &turns);
+		ClearSides();
+		i32 winnerSide = winner == WHITE ? whiteSide : 1 - whiteSide;
+
+		pthread_mutex_lock(&matchMutex);
+		if (winner == 0)
+			draws++;
+		else
+			wins[winnerSide]++;
+		FOR(side, 0, 2) {
+			stats[side].nodes += gameStats[side].nodes;
+			stats[side].time += gameStats[side].time;
+			stats[side].turns += gameStats[side].turns;
+			stats[side].timeouts += gameStats[side].timeouts;
+			stats[side].forfeits += gameStats[side].forfeits;
+			stats[side].depthSum += gameStats[side].depthSum;
+			stats[side].depthTurns += gameStats[side].depthTurns;
+		}
+		finishedGames++;
+		double score, elo, margin, llr;
+		MatchStatistics(&score, &elo, &margin, &llr);
+		printf("game %d (%s %u): white %c, black %c, %s in %d turns%s; score A-B %d-%d-%d, Elo %+0.1f +/- %0.1f",
+		       game + 1, standard ? "standard" : "random", seed + pair, whiteSide == 0 ? 'A' : 'B', whiteSide == 0 ? 'B' : 'A',
+		       winner == WHITE ? "1-0" : winner == BLACK ? "0-1" : "1/2-1/2", turns,
+		       gameStats[0].forfeits + gameStats[1].forfeits > 0 ? " (forfeit)" : "", wins[0], wins[1], draws, elo, margin);
+		if (sprt) {
+			printf(", LLR %0.2f", llr);
+			if (llr <= log(SPRT_BETA / (1 - SPRT_ALPHA)) || llr >= log((1 - SPRT_BETA) / SPRT_ALPHA))
+				matchDecided = true;
+		}
+		printf("\n");
+		fflush(stdout);
+		pthread_mutex_unlock(&matchMutex);
+	}
+	return null;
+}
+
+static void PrintSummary()
+{
+	double score, elo, margin, llr;
+	MatchStatistics(&score, &elo, &margin, &llr);
+	printf("\nA: %s\nB: %s\n", configs[0].name, configs[1].name);
+	printf("games %d: A wins %d, B wins %d, draws %d (longer than %d turns)\n", finishedGames, wins[0], wins[1], draws,
+	       TOURNAMENT_MAX_TURNS);
+	printf("score of A %0.3f, Elo of A - B %+0.1f +/- %0.1f (95 %%)\n", score, elo, margin);
+	FOR(side, 0, 2) {
+		PlayerStats *st = &stats[side];
+		printf("%c: turns %d, timeouts %d, forfeits %d, average depth ", 'A' + side, st->turns, st->timeouts,
+		       st->forfeits);
+		if (st->depthTurns > 0)
+			printf("%0.2f", (double) st->depthSum / st->depthTurns);
+		else
+			printf("-");
+		printf(", nodes %llu, time %0.1f s, nps %0.0f\n", st->nodes, st->time, st->nodes / MAX(st->time, 1e-6));
+	}
+	if (sprt) {
+		double lower = log(SPRT_BETA / (1 - SPRT_ALPHA)), upper = log((1 - SPRT_BETA) / SPRT_ALPHA);
+		printf("SPRT elo0 %0.1f, elo1 %0.1f: LLR %0.2f (%0.2f, %0.2f), %s\n", elo0, elo1, llr, lower, upper,
+		       llr >= upper ? "elo1 accepted" : llr <= lower ? "elo0 accepted" : "undecided");
+	}
+	fflush(stdout);
+}
+
+i32 main(i32 argc, char *argv[])
+{
+	i32 concurrency = (i32) sysconf(_SC_NPROCESSORS_ONLN);
+	i32 megabytes;
+	i32 c, option_index;
+	while ((c = getopt_long(argc, argv, options, long_options, &option_index)) >= 0) {
+		switch (c) {
+		case 'g':
+			if (sscanf(optarg, "%d", &games) != 1 || games <= 0 || games > TOURNAMENT_MAX_GAMES) {
+				printf("Bad number of games '%s' (1-%d).\n", optarg, TOURNAMENT_MAX_GAMES);
+				return 0;
+			}
+			break;
+		case 'c':
+			if (sscanf(optarg, "%d", &concurrency) != 1 || concurrency <= 0) {
+				printf("Bad number of parallel games '%s'.\n", optarg);
+				return 0;
+			}
+			break;
+		case 'o':
+			if (strcmp(optarg, "standard") == 0)
+				openings = OPENINGS_STANDARD;
+			else if (strcmp(optarg, "random") == 0)
+				openings = OPENINGS_RANDOM;
+			else if (strcmp(optarg, "both") == 0)
+				openings = OPENINGS_BOTH;
+			else {
+				printf("Bad openings '%s' (standard, random or both).\n", optarg);
+				return 0;
+			}
+			break;
+		case 's':
+			sscanf(optarg, "%u", &seed);
+			break;
+		case 'S':
+			if (sscanf(optarg, "%lf,%lf", &elo0, &elo1) != 2 || elo0 >= elo1) {
+				printf("Bad SPRT bounds '%s', ELO0,ELO1 with ELO0 < ELO1.\n", optarg);
+				return 0;
+			}
+			sprt = true;
+			break;
+		case 'H':
+			if (sscanf(optarg, "%d", &megabytes) != 1 || megabytes <= 0) {
+				printf("Bad size of the transposition table '%s'.\n", optarg);
+				return 0;
+			}
+			SetTTSize(megabytes);
+			break;
+		case 'P':
+			if (sscanf(optarg, "%d", &megabytes) != 1 || megabytes <= 0) {
+				printf("Bad size of the DFPNS transposition table '%s'.\n", optarg);
+				return 0;
+			}
+			SetTT2Size(megabytes);
+			break;
+		case 'h':
+			printHelp();
+			return 0;
+		default:
+			printf("Not known argument '%c'. Type tournament -h for help.\n", c);
+			break;
+		}
+	}
+	if (argc - optind != 2) {
+		printHelp();
+		return 0;
+	}
+	FOR(side, 0, 2) {
+		if (!ParsePlayerConfig(argv[optind + side], &configs[side])) {
+			printf("Bad configuration '%s', see tournament -h.\n", argv[optind + side]);
+			return 0;
+		}
+	}
+	searchThreads = 1;	// games are parallel instead
+	concurrency = MIN(concurrency, games);
+	printf("A: %s\nB: %s\ngames %d, parallel %d\n", configs[0].name, configs[1].name, games, concurrency);
+	fflush(stdout);
+	InitMoveTables();	// before game threads, they set up positions concurrently
+	pthread_t threads[concurrency];
+	i32 started = 0;
+	FOR(i, 0, concurrency) {
+		if (pthread_create(&threads[started], null, GameThread, null) != 0)
+			break;
+		started++;
+	}
+	if (started == 0)
+		GameThread(null);
+	FOR(i, 0, started) pthread_join(threads[i], null);
+	PrintSummary();
+	return OK;
+}
@@ -0,0 +1,75 @@
+/*
+ * The header file for the tournament runner, a separate program (make tournament)
+ * linked with all modules except main. It plays games between two configurations
+ * of the engine and reports the result as Elo with an error margin. A configuration
+ * is a comma separated list of settings:
+ *   ai=N      AI number for GetBestMove (default MAIN_AI)
+ *   time=S    time limit of a turn in seconds (default AI_TIME_LIMIT)
+ *   nodes=N   node budget of a turn instead of the time (ID Alpha-beta and DFPNS AIs)
+ *   depth=N   fixed depth of Alpha-beta AIs instead of the time
+ *   eval=standard|beginner   the eval parameter set (EVAL_STANDARD or EVAL_BEGINNER)
+ * for example "ai=9,time=2" or "ai=24,nodes=200000,eval=beginner".
+ * Games are played in pairs from the same opening (the standard board or a random
+ * board given by the seed), the configurations swap colours in the second game.
+ * Games run in parallel, every game in one thread with one search thread; each
+ * configuration has its own transposition tables and history table within a game.
+ * With --sprt the match stops once the sequential probability ratio test accepts
+ * one of the hypotheses "Elo of A - B is elo0" and "it's elo1".
+ *
+ * Author: Pavel Veselý
+ * License: GPL v3, see license.txt
+*/
+#ifndef TOURNAMENT_H_INCLUDED
+#define TOURNAMENT_H_INCLUDED
+
+#include "tzaarlib.h"
+#include <getopt.h>
+
+#define TOURNAMENT_GAMES 100
+#define TOURNAMENT_MAX_GAMES 100000
+#define TOURNAMENT_MAX_TURNS 100	// every turn captures a stone, so a game should end within 60 turns; a longer one is a draw
+#define TOURNAMENT_NO_TIME_LIMIT 1000000	// the time limit of configurations with a node budget or a fixed depth
+#define TOURNAMENT_TIMEOUT_MULT 2	// a turn longer than the time limit * TOURNAMENT_TIMEOUT_MULT + 1 s is a timeout (not a loss)
+#define SPRT_ALPHA 0.05		// probability of accepting elo1 when elo0 holds
+#define SPRT_BETA 0.05		// probability of accepting elo0 when elo1 holds
+
+// openings
+#define OPENINGS_BOTH 0		// pairs alternate the standard and random boards
+#define OPENINGS_STANDARD 1
+#define OPENINGS_RANDOM 2
+
+typedef struct playerConfig {
+	const char *name;	// the configuration string
+	i32 ai, time, depth;
+	u32 nodes;
+	i32 evalParameters;
+} PlayerConfig;
+
+typedef struct playerStats {	// totals of the turns of a configuration
+	unsigned long long nodes;
+	double time;
+	i32 turns, timeouts, forfeits;	// forfeits are games lost because the AI returned no legal move
+	unsigned long long depthSum;	// finished depths of Alpha-beta turns
+	i32 depthTurns;
+} PlayerStats;
+
+static __attribute__ ((unused))
+struct option long_options[] = {
+	{"games", 1, 0, 'g'},
+	{"concurrency", 1, 0, 'c'},
+	{"openings", 1, 0, 'o'},
+	{"seed", 1, 0, 's'},
+	{"sprt", 1, 0, 'S'},	// only the long option
+	{"hash", 1, 0, 'H'},
+	{"pnshash", 1, 0, 'P'},
+	{"help", 0, 0, 'h'},
+	{0, 0, 0, 0}
+};
+
+static __attribute__ ((unused))
+const char *options = "g:c:o:s:H:P:h";
+
+bool ParsePlayerConfig(const char *s, PlayerConfig * config);
+double EloFromScore(double score);
+
+#endif				// TOURNAMENT_H_INCLUDED
@@ -85,7 +85,7 @@ i32 SavePosition(const char *fileName)
 	return OK;
 }
 
-/// Save basic information about the position
+/// Load basic information about the position
 i32 LoadPosition(const char *fileName)
 {
 	ASSERT(fileName != null, "open: fileName null");
@@ -94,7 +94,19 @@ i32 LoadPosition(const char *fileName)
 		printf("Cannot open file '%s'\n", fileName);
 		return ERROR;
 	}
-	fscanf(f, "%d", &player);
+	i32 err = ReadPosition(f);
+	if (fclose(f) == EOF) {
+		DPRINT("error closing file %s", fileName);
+		return ERROR;
+	}
+	return err;
+}
+
+/// Read the position in the format of position files from the stream (used also by the daemon)
+i32 ReadPosition(FILE * f)
+{
+	if (fscanf(f, "%d", &player) != 1 || (player != WHITE && player != BLACK))
+		return ERROR;
 	DPRINT2("player %d", player);
 	FOR(i, 0, STONE_TYPES) {
 		counts[i] = 0;
@@ -105,7 +117,10 @@ i32 LoadPosition(const char *fileName)
 	}
 	i32 cnt = 0;
 	FOR(i, 0, BOARD_ARRAY_SIZE) {
-		fscanf(f, "%d", &(board[i]));
+		if (fscanf(f, "%d", &(board[i])) != 1)
+			return ERROR;
+		if (board[i] != BORDER && abs(board[i]) > 3)
+			return BAD_STONE;
 		if (board[i] != 100) {
 			counts[board[i] + 3]++;
 			cnt++;
@@ -113,7 +128,8 @@ i32 LoadPosition(const char *fileName)
 	}
 	FOR(i, 0, BOARD_ARRAY_SIZE) {
 		i32 c;
-		fscanf(f, "%d", &c);
+		if (fscanf(f, "%d", &c) != 1 || c < 0 || c >= MAX_STACK_HEIGHT)
+			return ERROR;
 		stackHeights[i] = c;
 		if (board[i] != BORDER) {
 			countsByHeight[board[i] + 3][c]++;
@@ -128,15 +144,13 @@ i32 LoadPosition(const char *fileName)
 	stoneSum -= counts[3];
 	turnNumber = 1;	//no special handeling for the first move
 	moveNumber = 1;
+	CountBitboards();	// before ZOC, generating moves uses bitboards and line tables
+	CountLineOccupancy();
 	CountZoneOfControl();
 	CountMaterialValue();
 	CountHash();
 	DBG2(printZOCDebug());
 	DBG2(printHighestDebug());
-	if (fclose(f) == EOF) {
-		DPRINT("error closing file %s", fileName);
-		return ERROR;
-	}
 	ASSERT(!IsEndOfGame(), "LOAD END POSITION!!!")
 	return OK;
 }
@@ -8,9 +8,11 @@
 #define TZAARSAVELOAD_H_INCLUDED
 
 #include "main.h"
+#include <stdio.h>
 
 i32 SavePosition(const char *fileName);
 i32 LoadPosition(const char *fileName);
+i32 ReadPosition(FILE * f);
 i32 SaveBestMoves(const char *fileName, Move * m1, Move * m2);
 
 #endif				// TZAARSAVELOAD_H_INCLUDED
@@ -5,6 +5,7 @@
  * Author: Pavel Veselý
  * License: GPL v3, see license.txt
 */
+#define _GNU_SOURCE		// for rand_r
 #include "tzaarinit.h"
 
 #include <math.h>
@@ -26,27 +27,19 @@ void CountZoneOfControl()
 	i32 mv = moveNumber, pl = player;
 	moveNumber = 1;
 	player = WHITE;
-	Move *m, *tmp;
-	GenerateAllMoves(&m);
-	while (m != null) {
-		if (threatenByCounts[m->to] == 0)
-			zoneOfControl[board[m->to] + 3]++;
-		threatenByCounts[m->to]++;
-
-		tmp = m;
-		m = m->next;
-		FreeMove(tmp);
+	Move *m;
+	i32 count = GenerateAllMoves(&m);
+	for (Move *n = m; n < m + count; n++) {
+		if (threatenByCounts[n->to] == 0)
+			zoneOfControl[board[n->to] + 3]++;
+		threatenByCounts[n->to]++;
 	}
-	m = null;
 	player = BLACK;
-	GenerateAllMoves(&m);
-	while (m != null) {
-		if (threatenByCounts[m->to] == 0)
-			zoneOfControl[board[m->to] + 3]++;
-		threatenByCounts[m->to]++;
-		tmp = m;
-		m = m->next;
-		FreeMove(tmp);
+	count = GenerateAllMoves(&m);
+	for (Move *n = m; n < m + count; n++) {
+		if (threatenByCounts[n->to] == 0)
+			zoneOfControl[board[n->to] + 3]++;
+		threatenByCounts[n->to]++;
 	}
 	moveNumber = mv;
 	player = pl;
@@ -75,13 +68,58 @@ void CountHash()
 		hash ^= 1;
 }
 
-void InitBoard(i32 setup)
-{				//not used
+/// Precomputes the tables of move generation shared by all threads. The first position also initializes them
+/// lazily, but that isn't thread-safe, so programs setting up positions in several threads call this before
+void InitMoveTables()
+{
+#ifdef BITBOARDS
+	InitRayMasks();
+#endif
+#ifdef LINE_TABLES
+	InitLineTables();
+#endif
+}
+
+void CountBitboards()
+{
+#ifdef BITBOARDS
+	InitRayMasks();
+	occupiedBitboard = 0;
+	colourBitboards[0] = colourBitboards[1] = 0;
+	FOR(i, 0, STONE_TYPES) {
+		stoneBitboards[i] = 0;
+	}
+	FOR(i, 0, BOARD_ARRAY_SIZE) {
+		if (board[i] != BORDER && board[i] != EMPTY) {
+			occupiedBitboard |= BIT(i);
+			colourBitboards[COLOUR_INDEX(SIGN(board[i]))] |= BIT(i);
+			stoneBitboards[board[i] + 3] |= BIT(i);
+		}
+	}
+#endif
+}
+
+void CountLineOccupancy()
+{
+#ifdef LINE_TABLES
+	InitLineTables();
+	FOR(i, 0, LINE_COUNT) {
+		lineOccupancy[i] = 0;
+	}
+	FOR(i, 0, BOARD_ARRAY_SIZE) {
+		if (board[i] != BORDER && board[i] != EMPTY)
+			ToggleFieldInLines(i);
+	}
+#endif
+}
+
+/// Sets up the initial position, RANDOM shuffles the stones of the standard board randomly by the seed
+void InitBoardSeeded(i32 setup, u32 seed)
+{
 	if (setup == STANDARD) {
 		for (i32 i = 0; i < BOARD_ARRAY_SIZE; i++)
 			board[i] = StandardBoard[i];
 	} else if (setup == RANDOM) {
-		srand(time(NULL));
 		i32 rnd[BOARD_ARRAY_SIZE];
 		for (i32 i = 0; i < BOARD_ARRAY_SIZE; i++) {
 			rnd[i] = StandardBoard[i];
@@ -89,7 +127,7 @@ void InitBoard(i32 setup)
 		i32 st = TOTAL_STONES;
 		for (i32 i = 0; i < BOARD_ARRAY_SIZE; i++) {
 			if (StandardBoard[i] != BORDER) {
-				i32 j = rand() % st, k = 0;
+				i32 j = rand_r(&seed) % st, k = 0;
 				while (j > -1) {
 					if (rnd[k] != BORDER)
 						j--;
@@ -105,18 +143,28 @@ void InitBoard(i32 setup)
 	}
 	// for every board setup, stack heights are equally 1
 	for (i32 i = 0; i < BOARD_ARRAY_SIZE; i++) {
-		stackHeights[i] = 1;
+		stackHeights[i] = board[i] != BORDER ? 1 : 0;	// like in position files
 	}
 	for (i32 i = 0; i < STONE_TYPES; i++) {
-		counts[i] = countsByHeight[1][i] = InitialStoneCounts[i];
-		highestStack[i] = 1;
+		FOR(j, 0, MAX_STACK_HEIGHT) {
+			countsByHeight[i][j] = 0;
+		}
+		counts[i] = countsByHeight[i][1] = InitialStoneCounts[i];
+		highestStack[i] = counts[i] > 0 ? 1 : 0;
 	}
 	player = WHITE;
 	moveNumber = 1;
 	turnNumber = 1;
 	stoneSum = 60;
+	CountBitboards();	// before ZOC, generating moves uses bitboards and line tables
+	CountLineOccupancy();
 	CountZoneOfControl();
 	CountMaterialValue();
 	CountHash();
 	value = 0;
 }
+
+void InitBoard(i32 setup)
+{
+	InitBoardSeeded(setup, (u32) time(NULL));
+}
@@ -38,7 +38,11 @@ i32 StandardBoard[] = {
 
 void CountMaterialValue();
 void CountHash();
+void CountBitboards();
+void CountLineOccupancy();
 void CountZoneOfControl();
+void InitMoveTables();
+void InitBoardSeeded(i32 setup, u32 seed);
 void InitBoard(i32 setup);
 
 #endif	// TZAARINIT_H_INCLUDED
@@ -7,6 +7,7 @@
  * Author: Pavel Veselý
  * License: GPL v3, see license.txt
 */
+#define _GNU_SOURCE		// for mmap and madvise
 #include "tzaarlib.h"
 
 #include <math.h>
@@ -17,40 +18,91 @@
 #include <sys/time.h>
 #include <time.h>
 #include <stdint.h>
+#include <sys/mman.h>
+#include <pthread.h>
 
 // Position reprezentation
-i32 board[BOARD_ARRAY_SIZE];
-i32 stackHeights[BOARD_ARRAY_SIZE];
-i32 player, moveNumber;
+THREAD_LOCAL i32 board[BOARD_ARRAY_SIZE];
+THREAD_LOCAL i32 stackHeights[BOARD_ARRAY_SIZE];
+THREAD_LOCAL i32 player, moveNumber;
+#ifdef BITBOARDS
+THREAD_LOCAL tbitboard occupiedBitboard;
+THREAD_LOCAL tbitboard colourBitboards[2];
+THREAD_LOCAL tbitboard stoneBitboards[STONE_TYPES];
+#endif
+#ifdef LINE_TABLES
+THREAD_LOCAL u8 lineOccupancy[LINE_COUNT];
+#endif
 
 // History
-i32 turnNumber;
-Move *history[MAX_MOVES];
+THREAD_LOCAL i32 turnNumber;
+THREAD_LOCAL Move *history[MAX_MOVES];
 
 // Position properties useful for the evaluation function and the Move Ordering
-i32 counts[STONE_TYPES];
-i32 stoneSum;
-i32 value;
-i32 materialValue;
-thash hash;
-i32 highestStack[STONE_TYPES];
-i32 countsByHeight[STONE_TYPES][MAX_STACK_HEIGHT];
-i32 zoneOfControl[STONE_TYPES], threatenByCounts[BOARD_ARRAY_SIZE];
+THREAD_LOCAL i32 counts[STONE_TYPES];
+THREAD_LOCAL i32 stoneSum;
+THREAD_LOCAL i32 value;
+THREAD_LOCAL i32 materialValue;
+THREAD_LOCAL thash hash;
+THREAD_LOCAL i32 highestStack[STONE_TYPES];
+THREAD_LOCAL i32 countsByHeight[STONE_TYPES][MAX_STACK_HEIGHT];
+THREAD_LOCAL i32 zoneOfControl[STONE_TYPES], threatenByCounts[BOARD_ARRAY_SIZE];
 
 // For saving
-double searchDuration;
+THREAD_LOCAL double searchDuration;
 
 // For searching (AB and PNS)
-i32 currDepth;	//for test
-u32 searchedNodes;
+THREAD_LOCAL i32 currDepth;	//for test
+THREAD_LOCAL u32 searchedNodes;
+THREAD_LOCAL u32 searchGeneration;
+volatile bool stopSearch;
+volatile bool pondering;
+volatile double ponderTimeShift;
+THREAD_LOCAL bool searchAborted;
+THREAD_LOCAL volatile bool *abortFlag;
+THREAD_LOCAL u32 abortCheckNodes;
+THREAD_LOCAL i32 searchDepthLimit;
+THREAD_LOCAL u32 searchNodeLimit;
+THREAD_LOCAL u32 randomSeed;
+THREAD_LOCAL SearchStats searchStats;
 
 // Debug constants
 #ifdef DEBUG
-i32 moveAlive, entryAlive, ttHit, ttFound, ttKick, prunedCount, entry2Alive, tt2Kick, tt2Hit, tt2Found, ttCollision;
+THREAD_LOCAL i32 entryAlive, entry2Alive, ttKick, tt2Kick, ttCollision;
 #endif
 
 typedef int_fast64_t ttimestamp;
 
+#define HUGE_PAGE_SIZE (2 << 20)
+
+/// Allocates zeroed memory for a hash table aligned to huge pages, returns null if there is not enough memory.
+/// The memory is marked for transparent huge pages where available, as random accesses to large tables
+/// cause many TLB misses otherwise. Pages are zeroed by the system lazily on first touch.
+void *AllocateTable(size_t size)
+{
+	size = (size + HUGE_PAGE_SIZE - 1) & ~((size_t) HUGE_PAGE_SIZE - 1);
+	size_t mapped = size + HUGE_PAGE_SIZE;
+	char *mem = mmap(null, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (mem == MAP_FAILED)
+		return null;
+	char *table = (char *) (((uintptr_t) mem + HUGE_PAGE_SIZE - 1) & ~((uintptr_t) HUGE_PAGE_SIZE - 1));
+	if (table > mem)
+		munmap(mem, table - mem);
+	if (table + size < mem + mapped)
+		munmap(table + size, mem + mapped - (table + size));
+#ifdef MADV_HUGEPAGE
+	madvise(table, size, MADV_HUGEPAGE);	// only advice, failure is not an error
+#endif
+	return table;
+}
+
+/// Frees the table allocated by AllocateTable with the same size
+void FreeTable(void *table, size_t size)
+{
+	size = (size + HUGE_PAGE_SIZE - 1) & ~((size_t) HUGE_PAGE_SIZE - 1);
+	munmap(table, size);
+}
+
 /// Returns current time in microseconds
 static ttimestamp get_timer()
 {
@@ -68,6 +120,237 @@ double getDurationInSecs(ttimestamp tStart, ttimestamp tEnd)
 	return res;
 }
 
+// The deadline of the running search, set by GetBestMove
+static THREAD_LOCAL bool searchAbortable;	// false until there is a move to fall back to
+static THREAD_LOCAL ttimestamp searchStart;
+static THREAD_LOCAL double searchTimeLimit;
+static THREAD_LOCAL bool helperThread;	// for -j, see HelperSearch
+static volatile bool helpersStop;	// set by the main thread when its search ends
+
+/// Sets searchAborted when stopSearch or *abortFlag is set or the time limit of the search passed (unless pondering).
+/// Called by SEARCH_ABORTED() once per ABORT_CHECK_NODES + 1 nodes, returns the new value of searchAborted.
+bool CheckSearchAbort()
+{
+	abortCheckNodes = searchedNodes;
+	if (!searchAborted && abortFlag != null && *abortFlag)
+		searchAborted = true;
+	if (searchAbortable && !searchAborted
+	    && (stopSearch || (helperThread && helpersStop) || (!pondering && getDurationInSecs(searchStart, get_timer()) > searchTimeLimit + ponderTimeShift))) {
+		searchAborted = true;
+		if (!helperThread)
+			DPRINT("search aborted after %d nodes", searchedNodes);
+	}
+	return searchAborted;
+}
+
+// Lazy SMP -- helper threads run their own ID on copies of the position and share only TT with the main thread
+typedef struct helperThreadData {
+	pthread_t thread;
+	i32 id, ai;		// helpers are numbered from 1, the main thread is 0
+	PositionState *position;
+	TTBucket *table;
+	TT2Bucket *pnsTable;
+	i32 evalParameters;
+	u32 generation;
+	ttimestamp start;
+	double timeLimit;
+} HelperThreadData;
+
+i32 searchThreads = 1;
+static PositionState helpersPosition;
+static HelperThreadData helpersData[MAX_SEARCH_THREADS];
+
+/// Copies the position of the current thread to state
+void SavePositionState(PositionState * state)
+{
+	memcpy(state->board, board, sizeof(board));
+	memcpy(state->stackHeights, stackHeights, sizeof(stackHeights));
+	state->player = player, state->moveNumber = moveNumber, state->turnNumber = turnNumber;
+#ifdef BITBOARDS
+	state->occupiedBitboard = occupiedBitboard;
+	memcpy(state->colourBitboards, colourBitboards, sizeof(colourBitboards));
+	memcpy(state->stoneBitboards, stoneBitboards, sizeof(stoneBitboards));
+#endif
+#ifdef LINE_TABLES
+	memcpy(state->lineOccupancy, lineOccupancy, sizeof(lineOccupancy));
+#endif
+	memcpy(state->counts, counts, sizeof(counts));
+	state->value = value, state->materialValue = materialValue, state->stoneSum = stoneSum;
+	state->hash = hash;
+	memcpy(state->highestStack, highestStack, sizeof(highestStack));
+	memcpy(state->countsByHeight, countsByHeight, sizeof(countsByHeight));
+	memcpy(state->zoneOfControl, zoneOfControl, sizeof(zoneOfControl));
+	memcpy(state->threatenByCounts, threatenByCounts, sizeof(threatenByCounts));
+}
+
+/// Sets the position of the current thread from state, history is not copied (searches don't revert the root)
+void RestorePositionState(PositionState * state)
+{
+	memcpy(board, state->board, sizeof(board));
+	memcpy(stackHeights, state->stackHeights, sizeof(stackHeights));
+	player = state->player, moveNumber = state->moveNumber, turnNumber = state->turnNumber;
+#ifdef BITBOARDS
+	occupiedBitboard = state->occupiedBitboard;
+	memcpy(colourBitboards, state->colourBitboards, sizeof(colourBitboards));
+	memcpy(stoneBitboards, state->stoneBitboards, sizeof(stoneBitboards));
+#endif
+#ifdef LINE_TABLES
+	memcpy(lineOccupancy, state->lineOccupancy, sizeof(lineOccupancy));
+#endif
+	memcpy(counts, state->counts, sizeof(counts));
+	value = state->value, materialValue = state->materialValue, stoneSum = state->stoneSum;
+	hash = state->hash;
+	memcpy(highestStack, state->highestStack, sizeof(highestStack));
+	memcpy(countsByHeight, state->countsByHeight, sizeof(countsByHeight));
+	memcpy(zoneOfControl, state->zoneOfControl, sizeof(zoneOfControl));
+	memcpy(threatenByCounts, state->threatenByCounts, sizeof(threatenByCounts));
+}
+
+/// ID of a helper thread, runs until the main thread stops it or the deadline passes.
+/// Helpers with odd id search only odd depths from 3 and the history table of each helper starts with
+/// a little noise, so that the threads don't search the same tree in the same order.
+static void *HelperSearch(void *arg)
+{
+	HelperThreadData *data = (HelperThreadData *) arg;
+	SetEvalParameters(data->evalParameters);	// before the position, it recounts the material
+	RestorePositionState(data->position);
+	TranspositionTable = data->table;
+	searchGeneration = data->generation;
+	helperThread = true;
+	searchStart = data->start;
+	searchTimeLimit = data->timeLimit;
+	searchAborted = false;
+	searchAbortable = true;	// the main thread returns the moves
+	u32 seed = data->id;
+	FOR(i, 0, BOARD_ARRAY_SIZE) FOR(j, 0, BOARD_ARRAY_SIZE) historyPruneMoves[i][j] = rand_r(&seed) % HELPER_HISTORY_NOISE;
+	ClearKillerMoves();
+	SetSelectiveSearch(data->ai);
+	i32 ret = 0;
+	for (i32 depth = 2 + data->id % 2; depth <= MAX_PONDER_DEPTH && abs(ret) < WIN; depth += 1 + data->id % 2) {
+		currDepth = depth;
+		searchedNodes = 0;
+		if (data->ai == AIALPHABETA_ID)
+			ret = AlphaBeta(depth, -WIN, WIN);
+		else if (data->ai == AIALPHABETA_ID_PV)
+			ret = AlphaBetaPV(depth, -WIN, WIN);
+		else if (data->ai == AIALPHABETA_ID_PV_MO)
+			ret = AlphaBetaPVMO(depth, -WIN, WIN);
+		else if (data->ai == AIALPHABETA_ID_PV_MO_SCOUT)
+			ret = AlphaBetaPVMONegascout(depth, -WIN, WIN);
+		else if (data->ai == AIALPHABETA_ID_PV_MO_HISTORY)
+			ret = AlphaBetaPVMOHistory(depth, -WIN, WIN);
+		else if (data->ai == AIALPHABETA_ID_PV_MO_SCOUT_HISTORY)
+			ret = AlphaBetaPVMOHistoryNegascout(depth, -WIN, WIN);
+		else if (data->ai == AIALPHABETA_ID_MTDF)
+			ret = MTDF(depth, ret);
+		else if (SelectiveSearchOfAI(data->ai) != 0)
+			ret = AlphaBetaPVMOSelective(depth, -WIN, WIN);
+		telemetry.nodes += searchedNodes;
+		if (searchAborted)
+			break;
+		DPRINT2("helper %d finished depth %d, return %d", data->id, depth, ret);
+	}
+	TelemetryAddHelper();
+	return null;
+}
+
+/// Searches the root by DFPNS of the ai, returns the best moves when the root is solved, otherwise null
+static FullMove *RunDFPNS(i32 ai)
+{
+	if (ai == DFPNS)
+		return dfpns(1, PNS_INFINITY, PNS_INFINITY);
+	if (ai == DFPNS_EPS_TRICK)
+		return dfpnsEpsTrick(1, PNS_INFINITY, PNS_INFINITY);
+	if (ai == WEAK_PNS)
+		return weakpns(1, PNS_INFINITY, PNS_INFINITY);
+	if (ai == DFPNS_EVAL_BASED)
+		return dfpnsEvalBased(1, PNS_INFINITY, PNS_INFINITY);
+	if (ai == DFPNS_WEAK_EPS_EVAL)
+		return dfpnsWeakEpsEval(1, PNS_INFINITY, PNS_INFINITY);
+	if (ai == DFPNS_DYNAMIC_WIDENING_EPS_EVAL)
+		return dfpnsDynWideningEpsEval(1, PNS_INFINITY, PNS_INFINITY);
+	return null;
+}
+
+/// Parallel DFPNS -- helper threads search the root by the same DFPNS as the main thread with shared TT2,
+/// virtual proof numbers of positions searched by other threads make them select different children.
+/// Only the main thread splits the search into chunks, helpers run until the root is solved or they are stopped.
+static void *PNSHelperSearch(void *arg)
+{
+	HelperThreadData *data = (HelperThreadData *) arg;
+	SetEvalParameters(data->evalParameters);	// before the position, it recounts the material
+	RestorePositionState(data->position);
+	DFPNSTranspositionTable = data->pnsTable;
+	searchGeneration = data->generation;
+	helperThread = pnsHelper = true;
+	searchStart = data->start;
+	searchTimeLimit = data->timeLimit;
+	searchAborted = false;
+	searchAbortable = true;
+	searchedNodes = 0;
+	maxDfpnsSearchedNodes = UINT32_MAX;
+	TT2Entry rootEntry;
+	TT2Entry *root = null;
+	do {
+		FullMove *fm = RunDFPNS(data->ai);
+		if (fm != null)
+			free(fm);
+		root = LookupPositionInTT2(&rootEntry);
+	} while (!CheckSearchAbort() && (root == null || (root->pn > 0 && root->dn > 0 && root->pn < PNS_INFINITY
+							     && root->dn < PNS_INFINITY)));	// checked here also because a chunk may search no nodes
+	DPRINT2("DFPNS helper %d searched %u", data->id, searchedNodes);
+	telemetry.nodes += searchedNodes;
+	TelemetryAddHelper();
+	return null;
+}
+
+/// Starts searchThreads - 1 helper threads running search (HelperSearch or PNSHelperSearch) for the current
+/// position with the ai, returns their number
+static i32 StartHelperThreads(i32 ai, void *(*search) (void *))
+{
+#ifndef THREAD_LOCAL_STATE
+	return 0;		// threads would share the position
+#endif
+	if (searchThreads <= 1)
+		return 0;
+	SavePositionState(&helpersPosition);
+	helpersStop = false;
+	i32 started = 0;
+	FOR(i, 1, searchThreads) {
+		HelperThreadData *data = &helpersData[started];
+		data->id = i;
+		data->ai = ai;
+		data->position = &helpersPosition;
+		data->table = TranspositionTable;
+		data->pnsTable = DFPNSTranspositionTable;
+		data->evalParameters = evalParameters;
+		data->generation = searchGeneration;
+		data->start = searchStart;
+		data->timeLimit = searchTimeLimit;
+		if (pthread_create(&data->thread, null, search, data) != 0) {
+			DPRINT("Error: cannot start helper thread %d", i);
+			break;
+		}
+		started++;
+	}
+	DPRINT("started %d helper threads", started);
+	return started;
+}
+
+/// Stops the helper threads and waits for them
+static void StopHelperThreads(i32 count)
+{
+	helpersStop = true;
+	FOR(i, 0, count) pthread_join(helpersData[i].thread, null);
+}
+
+/// Time limit of Alpha-beta called by DFPNS which started at start, it keeps the deadline of the whole search
+/// (the called GetBestMove adds ponderTimeShift itself), but Alpha-beta gets at least DFPNS_FALLBACK_MIN_TIME
+static i32 FallbackTime(i32 time, ttimestamp start)
+{
+	return MAX(DFPNS_FALLBACK_MIN_TIME, time - (i32) ceil(getDurationInSecs(start, get_timer())));
+}
+
 /// Searches for the best move in a given position using algorithm determined by the parameter ai.
 /// RecallAI is a parameter for DFPNS -- when it's not able to prove or disprove position, it calls Alpha-beta if recallAI is true.
 /// Returns false when an error occurred, otherwise true.
@@ -75,99 +358,184 @@ i32 GetBestMove(i32 ai, i32 time, Move ** move1, Move ** move2, bool recallAI)
 {
 	ASSERT2(moveNumber == 1, "GetBest: moveNumber should be 1");
 	if (moveNumber == 2) return false;
+	if (!InitTT() || !InitTT2()) {
+		DPRINT("Error: cannot allocate transposition tables");
+		return false;
+	}
+	searchGeneration++;
+	TelemetryStartSearch();
+	ClearKillerMoves();
+	searchAborted = searchAbortable = false;
+	searchStart = get_timer();
+	searchTimeLimit = time;
 	*move1 = null;
 	*move2 = null;
 	if (ai == -1)
 		ai = MAIN_AI;
+	SetSelectiveSearch(ai);
 	// switch between different search methods or AIs
 	if (ai == AIALPHABETA) {	// Alpha-beta without iterative deepening (ID)
 		searchedNodes = 0;
 		// set debug counters
-		DBG(moveAlive = entryAlive = ttHit = ttFound = ttKick = prunedCount = ttCollision = 0);
+		DBG(entryAlive = ttKick = ttCollision = 0);
 		i32 ret = 0;
 		ttimestamp tStart = get_timer();
 		DPRINT("ALPHA BETA WITH TT, sum of stones: %d", stoneSum);
-		ret = AlphaBeta(ALPHABETA_DEPTH, -WIN - 1, WIN + 1);
+		i32 depth = searchDepthLimit > 0 ? searchDepthLimit : ALPHABETA_DEPTH;
+		ret = AlphaBeta(depth, -WIN - 1, WIN + 1);
 		ttimestamp tEnd = get_timer();
 		searchDuration = getDurationInSecs(tStart, tEnd);
+		searchStats.nodes += searchedNodes;
+		searchStats.depth = depth;
+		TelemetryIteration(ai, depth, searchedNodes, searchDuration, ret, false);
+		TelemetrySearch(ai, searchDuration, 1);
 		value = ret;	// because of saving
-		DPRINT("Alpha-Beta: time %0.3f s, searched: %d, return: %d, pruned %d", searchDuration, searchedNodes,
-		       ret, prunedCount);
-		DPRINT("Alive: move %d, entries %d, kicks from TT %d, ttHits %d, ttFound %d", moveAlive,
-		       entryAlive, ttKick, ttHit, ttFound);
+		DPRINT("Alpha-Beta: time %0.3f s, searched: %d, return: %d", searchDuration, searchedNodes,
+		       ret);
+		DPRINT("Alive: entries %d, kicks from TT %d", entryAlive, ttKick);
 		ASSERT(ttCollision == 0 || ttCollision > 1000000, "FOUND TT COLLISION: %d", ttCollision);
-		TTEntry *saved = LookupPositionInTT();
+		TTEntry savedEntry;
+		TTEntry *saved = LookupPositionInTT(&savedEntry);
 		if (saved == null) {
 			DPRINT("Error: cannot find position in TT!!!\n");
 			return false;
 		}
-		*move1 = CloneMove(saved->bestMove1);
-		if (stoneSum < 60)
-			*move2 = CloneMove(saved->bestMove2);
+		*move1 = CloneMove(&saved->bestMove1);
+		if (stoneSum < 60 && saved->bestMove2.from != NO_MOVE)
+			*move2 = CloneMove(&saved->bestMove2);
 		else
 			*move2 = null;
 	} else if (ai >= AIALPHABETA_ID && ai <= AIALPHABETA_MAX) {	//Alpha-beta with ID
-		i32 ret = 0;
+		i32 ret = 0, lastRet = 0;
 		ttimestamp tStart = get_timer();
 		ttimestamp tID;
 		i32 depth = 2;
 		double lastTime, currTime = 0;
 		Move *m1 = null, *m2 = null, *lastm1, *lastm2;	//for better moves in losen positions (when using TT)
 		i32 mult;
+		i32 helpers = 0, workers = 0;
+		unsigned long long nodes = 0;	// in all iterations, for searchNodeLimit
+		if (ai == AIALPHABETA_ID_PV_MO_YBWC || ai == AIALPHABETA_RANDOM)	// the random AI splits its root
+			workers = StartYBWCWorkers();
+		else if (ai != AIALPHABETA_ID_MO)	// it doesn't share results through TT
+			helpers = StartHelperThreads(ai, HelperSearch);
 		do { // iterative deepening
 			lastm1 = m1, lastm2 = m2;
 			currDepth = depth;	// for getting branching factor on top level of the search
 			searchedNodes = 0;
-			// set debug counters
-			DBG(moveAlive = entryAlive = ttHit = ttFound = ttKick = prunedCount = ttCollision = 0);
-			if (ai == AIALPHABETA_ID) {	// alpha beta with TT and iterative deepening
-				DPRINT("ALPHA BETA WITH TT and ID, sum of stones: %d", stoneSum);
-				ret = AlphaBeta(depth, -WIN, WIN);
-			} else if (ai == AIALPHABETA_ID_PV) {	// alpha beta with TT, iterative deepening and move from TT
-				DPRINT("ALPHA BETA WITH TT and ID and PV, sum of stones: %d", stoneSum);
-				ret = AlphaBetaPV(depth, -WIN, WIN);
-			} else if (ai == AIALPHABETA_ID_PV_MO) {
-				DPRINT("ALPHA BETA WITH TT and ID and PV and MO, sum of stones: %d", stoneSum);
-				ret = AlphaBetaPVMO(depth, -WIN, WIN);
-			} else if (ai == AIALPHABETA_ID_MO) {
-				DPRINT("ALPHA BETA WITH ID and MO, sum of stones: %d", stoneSum);
-				ret = AlphaBetaMO(depth, -WIN, WIN, &m1, &m2);
-			} else if (ai == AIALPHABETA_RANDOM) {	// alpha beta with random move selecting
-				DPRINT("ALPHA BETA RANDOM WITH TT and ID and PV and MO, sum of stones: %d, pl %d",
-				       stoneSum, player);
-				ttCollision = 0;
-				ret = AlphaBetaPVMORandom(depth, AI_RANDOM_MARGIN);
-			} else if (ai == AIALPHABETA_ID_PV_MO_SCOUT) {
-				DPRINT("ALPHA BETA WITH TT and ID and PV and MO and NEGASCOUT, sum of stones: %d",
-				       stoneSum);
-				ret = AlphaBetaPVMONegascout(depth, -WIN, WIN);
-			} else if (ai == AIALPHABETA_ID_PV_MO_HISTORY) {
-				DPRINT("ALPHA BETA WITH TT and ID and PV and MO and HISTORY, sum of stones: %d",
-				       stoneSum);
-				ret = AlphaBetaPVMOHistory(depth, -WIN, WIN);
-			} else if (ai == AIALPHABETA_ID_PV_MO_SCOUT_HISTORY) {
-				DPRINT("ALPHA BETA WITH TT and ID, PV, MO, NEGASCOUT and HISTORY, sum of stones: %d",
-				       stoneSum);
-				ret = AlphaBetaPVMOHistoryNegascout(depth, -WIN, WIN);
+			lastRet = ret;
+			// aspiration window around the value of the previous iteration, AIs without TT, the random AI
+			// and MTD(f) use the full window
+			i32 alpha = -WIN, beta = WIN, delta = ASPIRATION_WINDOW;
+			if (depth >= ASPIRATION_MIN_DEPTH && abs(ret) < WIN && ai != AIALPHABETA_ID_MO && ai != AIALPHABETA_RANDOM
+			    && ai != AIALPHABETA_ID_MTDF) {
+				alpha = ret - delta;
+				beta = ret + delta;
+			}
+			while (true) {
+				rootBestFound = rootBestValid = false;
+				// set debug counters
+				DBG(entryAlive = ttKick = ttCollision = 0);
+				if (ai == AIALPHABETA_ID) {	// alpha beta with TT and iterative deepening
+					DPRINT("ALPHA BETA WITH TT and ID, sum of stones: %d", stoneSum);
+					ret = AlphaBeta(depth, alpha, beta);
+				} else if (ai == AIALPHABETA_ID_PV) {	// alpha beta with TT, iterative deepening and move from TT
+					DPRINT("ALPHA BETA WITH TT and ID and PV, sum of stones: %d", stoneSum);
+					ret = AlphaBetaPV(depth, alpha, beta);
+				} else if (ai == AIALPHABETA_ID_PV_MO) {
+					DPRINT("ALPHA BETA WITH TT and ID and PV and MO, sum of stones: %d", stoneSum);
+					ret = AlphaBetaPVMO(depth, alpha, beta);
+				} else if (ai == AIALPHABETA_ID_MO) {
+					DPRINT("ALPHA BETA WITH ID and MO, sum of stones: %d", stoneSum);
+					Move best1, best2;
+					ret = AlphaBetaMO(depth, alpha, beta, &best1, &best2);
+					if (!searchAborted) {
+						m1 = CloneMove(&best1);
+						m2 = best2.from != NO_MOVE ? CloneMove(&best2) : null;
+					}
+				} else if (ai == AIALPHABETA_RANDOM) {	// alpha beta with random move selecting
+					DPRINT("ALPHA BETA RANDOM WITH TT and ID and PV and MO, sum of stones: %d, pl %d",
+					       stoneSum, player);
+					DBG(ttCollision = 0);
+					ret = AlphaBetaPVMORandom(depth, AI_RANDOM_MARGIN);
+				} else if (ai == AIALPHABETA_ID_PV_MO_SCOUT) {
+					DPRINT("ALPHA BETA WITH TT and ID and PV and MO and NEGASCOUT, sum of stones: %d",
+					       stoneSum);
+					ret = AlphaBetaPVMONegascout(depth, alpha, beta);
+				} else if (ai == AIALPHABETA_ID_PV_MO_HISTORY) {
+					DPRINT("ALPHA BETA WITH TT and ID and PV and MO and HISTORY, sum of stones: %d",
+					       stoneSum);
+					ret = AlphaBetaPVMOHistory(depth, alpha, beta);
+				} else if (ai == AIALPHABETA_ID_PV_MO_SCOUT_HISTORY) {
+					DPRINT("ALPHA BETA WITH TT and ID, PV, MO, NEGASCOUT and HISTORY, sum of stones: %d",
+					       stoneSum);
+					ret = AlphaBetaPVMOHistoryNegascout(depth, alpha, beta);
+				} else if (ai == AIALPHABETA_ID_PV_MO_YBWC) {
+					DPRINT("ALPHA BETA WITH TT and ID and PV and MO and YBWC, sum of stones: %d", stoneSum);
+					ret = AlphaBetaPVMOYBWC(depth, alpha, beta);
+				} else if (ai == AIALPHABETA_ID_MTDF) {
+					DPRINT("MTD(f) WITH TT and ID, PV, MO and HISTORY, sum of stones: %d, guess %d", stoneSum, ret);
+					ret = MTDF(depth, ret);	// the value of the previous iteration is the guess
+				} else if (selectiveSearch != 0) {
+					DPRINT("ALPHA BETA WITH TT and ID, PV, MO, NEGASCOUT, HISTORY and SELECTIVE SEARCH %d, sum of stones: %d",
+					       selectiveSearch, stoneSum);
+					ret = AlphaBetaPVMOSelective(depth, alpha, beta);
+				}
+				if (searchAborted)
+					break;
+				delta = delta < WIN / ASPIRATION_WIDEN ? delta * ASPIRATION_WIDEN : WIN;
+				if (ret <= alpha && alpha > -WIN) {	// fail-low, search again with the lower bound widened
+					TCOUNT(aspirationFailLows);
+					DPRINT("AB: depth %d failed low (%d <= %d)", depth, ret, alpha);
+					alpha = ret > -WIN + delta ? ret - delta : -WIN;
+				} else if (ret >= beta && beta < WIN) {	// fail-high
+					TCOUNT(aspirationFailHighs);
+					DPRINT("AB: depth %d failed high (%d >= %d)", depth, ret, beta);
+					beta = ret < WIN - delta ? ret + delta : WIN;
+				} else {
+					break;
+				}
 			}
 			DBG2(printZOCDebug());
 			tID = get_timer();
 			lastTime = currTime;
 			currTime = getDurationInSecs(tStart, tID);
-			DPRINT("Alpha-Beta: pl %d, depth %d, time %0.3f s, searched: %d, return: %d, pruned %d", player,
-			       depth, currTime, searchedNodes, ret, prunedCount);
-			DPRINT("Alive: move %d, entries %d, kicks from TT %d, ttHits %d, ttFound %d",
-			       moveAlive, entryAlive, ttKick, ttHit, ttFound);
+			searchStats.nodes += searchedNodes;
+			nodes += searchedNodes;
+			TelemetryIteration(ai, depth, searchedNodes, currTime, ret, searchAborted);
+			DPRINT("Alpha-Beta: pl %d, depth %d, time %0.3f s, searched: %d, return: %d", player,
+			       depth, currTime, searchedNodes, ret);
+			DPRINT("Alive: entries %d, kicks from TT %d", entryAlive, ttKick);
 			ASSERT(ttCollision == 0 || ttCollision > 1000000, "FOUND TT COLLISION: %d", ttCollision);
-			if (ai != AIALPHABETA_ID_MO) {
-				TTEntry *saved = LookupPositionInTT();
+			if (searchAborted) {	// the iteration is not finished, the root of TT may hold an old entry
+				if (rootBestValid) {	// the previous best moves were searched first, so the best moves found are not worse
+					m1 = CloneMove(&rootBest1);
+					m2 = rootBest2.from != NO_MOVE ? CloneMove(&rootBest2) : null;
+					ret = rootBestValue;
+				} else {
+					ret = lastRet;
+				}
+				DPRINT("AB: iteration of depth %d aborted, using %s moves", depth, rootBestValid ? "its best" : "previous");
+				break;
+			}
+			searchAbortable = true;	// now there is a move to return
+			searchStats.depth = depth;
+			if (rootBestFound && ai != AIALPHABETA_ID_MO) {	// the root entry in TT may be overwritten by helper threads
+				m1 = CloneMove(&rootBest1);
+				if (rootBest2.from != NO_MOVE)
+					m2 = CloneMove(&rootBest2);
+			} else if (ai != AIALPHABETA_ID_MO) {
+				TTEntry savedEntry;
+				TTEntry *saved = LookupPositionInTT(&savedEntry);
 				if (saved == null) {
 					DPRINT("Error: cannot find position in TT!!!\n");
+					StopHelperThreads(helpers);
+					StopYBWCWorkers(workers);
 					return false;
 				}
-				m1 = CloneMove(saved->bestMove1); // the clone is needed because of possible kicks from TT
-				if (saved->bestMove2 != null)
-					m2 = CloneMove(saved->bestMove2);
+				m1 = CloneMove(&saved->bestMove1); // the clone is needed because of possible kicks from TT
+				if (saved->bestMove2.from != NO_MOVE)
+					m2 = CloneMove(&saved->bestMove2);
 			}
 			if (abs(ret) == WIN) {
 				if (ret == -WIN && lastm1 != null && lastm2 != null) {
@@ -179,12 +547,18 @@ i32 GetBestMove(i32 ai, i32 time, Move ** move1, Move ** move2, bool recallAI)
 				break;
 			}
 			// estimate time for the next depth -- it's mult * current duration
-			mult = AB_ID_timeMultByFreeFieldsEvenDepth[TOTAL_STONES - stoneSum + depth];
+			i32 multIndex = MIN(TOTAL_STONES - stoneSum + depth, (i32) (sizeof(AB_ID_timeMultByFreeFieldsEvenDepth) / sizeof(i32)) - 1);	// deep ID when pondering
+			mult = AB_ID_timeMultByFreeFieldsEvenDepth[multIndex];
 			if (depth % 2 == 0)
-				mult = AB_ID_timeMultByFreeFieldsOddDepth[TOTAL_STONES - stoneSum + depth];
+				mult = AB_ID_timeMultByFreeFieldsOddDepth[multIndex];
 			DPRINT("mult for next depth: %d", mult);
 			depth += 1;
-		} while ((depth <= MIN_AB_DEPTH || currTime + (currTime - lastTime) * mult < time) && abs(ret) < WIN);
+		} while ((searchDepthLimit > 0 ? depth <= searchDepthLimit : searchNodeLimit > 0 ? nodes < searchNodeLimit
+			  : (pondering && depth <= MAX_PONDER_DEPTH) || depth <= MIN_AB_DEPTH
+			  || currTime + (currTime - lastTime) * mult < time + ponderTimeShift) && abs(ret) < WIN && !stopSearch);
+		StopHelperThreads(helpers);
+		StopYBWCWorkers(workers);
+		TelemetrySearch(ai, currTime, 1 + helpers + workers);
 		searchDuration = currTime;
 		value = ret;	// because of saving
 		*move1 = m1;
@@ -193,74 +567,79 @@ i32 GetBestMove(i32 ai, i32 time, Move ** move1, Move ** move2, bool recallAI)
 	} else if (ai >= DFPNS && ai <= DFPNS_MAX) { // depth-first proof-number search
 		ASSERT(abs(value) != WIN, "dfpns cannot be called when someone won");
 		searchedNodes = 0;
-		ttimestamp tStart;
-		DBG(tStart = get_timer());
+		ttimestamp tStart = searchStart;
 		ttimestamp tID;
-		maxDfpnsSearchedNodes = DFPNS_SEARCH_NODES;
+		maxDfpnsSearchedNodes = searchNodeLimit > 0 ? searchNodeLimit : DFPNS_SEARCH_NODES;
+		searchAbortable = true;	// a chunk ended by the deadline is the same as a chunk ended by the node limit
+		TT2Entry savedEntry2;
 		TT2Entry *saved = null;
+		i32 helpers = StartHelperThreads(ai, PNSHelperSearch);
+		pnsThreads = 1 + helpers;
 		searchDuration = 0;
 		FullMove *fm = null;
+		bool solved = false;
+		u32 chunkNodes = 0;	// searchedNodes before the chunk
 		do {
 			// set debug counters
-			DBG(moveAlive = entry2Alive = tt2Hit = tt2Found = tt2Kick = prunedCount = ttCollision = 0);
-			if (ai == DFPNS) {
-				DPRINT("DFPNS obycejne, sum of stones %d:", stoneSum);
-				fm = dfpns(1, INFINITY, INFINITY);
-			} else if (ai == DFPNS_EPS_TRICK) {
-				DPRINT("DFPNS s EPSILON TRIKEM, sum of stones %d:", stoneSum);
-				fm = dfpnsEpsTrick(1, INFINITY, INFINITY);
-			} else if (ai == WEAK_PNS) {
-				DPRINT("DFPNS WEAK, sum of stones %d:", stoneSum);
-				fm = weakpns(1, INFINITY, INFINITY);
-			} else if (ai == DFPNS_EVAL_BASED) {
-				DPRINT("DFPNS EVAL BASED, sum of stones %d:", stoneSum);
-				fm = dfpnsEvalBased(1, INFINITY, INFINITY);
-			} else if (ai == DFPNS_WEAK_EPS_EVAL) {
-				DPRINT("DFPNS + WEAK, EPS. TRICK, EVAL BASED INIT, sum of stones %d:", stoneSum);
-				fm = dfpnsWeakEpsEval(1, INFINITY, INFINITY);
-			} else if (ai == DFPNS_DYNAMIC_WIDENING_EPS_EVAL) {
-				DPRINT("DFPNS + DYNAMIC WIDENING, EPS. TRICK, EVAL BASED INIT, sum of stones %d:", stoneSum);
-				fm = dfpnsDynWideningEpsEval(1, INFINITY, INFINITY);
-			}
-			DBG(tID = get_timer());
+			DBG(entry2Alive = tt2Kick = ttCollision = 0);
+			if (fm != null)	// from the previous iteration
+				free(fm);
+			DPRINT("DFPNS AI %d, sum of stones %d:", ai, stoneSum);
+			fm = RunDFPNS(ai);
+			tID = get_timer();
 			float tm = (float) getDurationInSecs(tStart, tID);
 			i32 ff = 0, tt = 0;
 			if (fm != null) {	//fm null in not solved position
-				ff = fm->m1->from, tt = fm->m1->to;
+				ff = fm->m1.from, tt = fm->m1.to;
 			}
 			DPRINT("DFPNS: time %0.3f s, searched: %d", tm, searchedNodes);
 			if (fm != null) {
-				ASSERT(fm->m1->from != fm->m1->to, "fm->m1->from %d, fm->m1->to %d SE ROVNA",
-				       fm->m1->from, fm->m1->to);
-				fm->m1->from = ff;
-				fm->m1->to = tt;
+				ASSERT(fm->m1.from != fm->m1.to, "fm->m1.from %d, fm->m1.to %d SE ROVNA",
+				       fm->m1.from, fm->m1.to);
+				fm->m1.from = ff;
+				fm->m1.to = tt;
 			}
 			searchDuration = tm;
-			DPRINT("Alive: pl %d, move %d, entries %d, kicks from TT %d, ttHits %d, ttFound %d", player, moveAlive, entry2Alive, tt2Kick, tt2Hit, tt2Found);
-			maxDfpnsSearchedNodes = (i32) (((time - searchDuration) * searchedNodes * 1.1f) / searchDuration) + searchedNodes;	//* 1.1f because the estimation is too pesimistic
+			TelemetryIteration(ai, 0, searchedNodes - chunkNodes, tm, 0, searchAborted);
+			chunkNodes = searchedNodes;
+			DPRINT("Alive: pl %d, entries %d, kicks from TT %d", player, entry2Alive, tt2Kick);
+			maxDfpnsSearchedNodes = (i32) (((time + ponderTimeShift - searchDuration) * searchedNodes * 1.1f) / searchDuration) + searchedNodes;	//* 1.1f because the estimation is too pesimistic
 			if (maxDfpnsSearchedNodes < 1000) maxDfpnsSearchedNodes = 1000;
+			if (pondering)	// the time limit is not known yet, search the next chunk
+				maxDfpnsSearchedNodes = searchedNodes + DFPNS_SEARCH_NODES;
+			if (searchNodeLimit > 0)	// the budget is searched by the first chunk, the next one is only to find the moves
+				maxDfpnsSearchedNodes = searchedNodes + searchNodeLimit;	// when a helper solved the root
 			DPRINT("next max dfpns searched nodes: %d", maxDfpnsSearchedNodes);
-			saved = LookupPositionInTT2();
+			saved = LookupPositionInTT2(&savedEntry2);
 			if (saved == null) {
 				DPRINT("Error: cannot find position in TT2!!!\n");
+				StopHelperThreads(helpers);
+				pnsThreads = 1;
 				return false;
 			}
 			DPRINT("DFPNS: pn = %d, dn = %d, searched %d", saved->pn, saved->dn, saved->searchedNodes);
-		} while (searchDuration < time * 4 / 5.0f && saved->pn > 0 && saved->dn > 0 && saved->pn < INFINITY && saved->dn < INFINITY);	//AI_TIME_LIMIT * 4 / 5 -- because sometimes a few seconds are missing to time limit
+			solved = saved->pn == 0 || saved->dn == 0 || saved->pn >= PNS_INFINITY || saved->dn >= PNS_INFINITY;
+		} while (!searchAborted && (solved ? fm == null : searchNodeLimit > 0 ? searchedNodes <= searchNodeLimit
+					    : pondering || searchDuration < (time + ponderTimeShift) * 4 / 5.0f));	//AI_TIME_LIMIT * 4 / 5 -- because sometimes a few seconds are missing to time limit; when a helper solved the root, the main thread finds the moves in the next chunk
+		StopHelperThreads(helpers);
+		pnsThreads = 1;
+		searchStats.nodes += searchedNodes;	// counted through all chunks
+		TelemetrySearch(ai, searchDuration, 1 + helpers);
 		value = 0;
-		if (saved->pn == 0 || saved->dn >= INFINITY) {
+		if (fm == null)	// not solved by the main thread in time
+			solved = false;
+		if (solved && (saved->pn == 0 || saved->dn >= PNS_INFINITY)) {
 			ASSERT(fm != null, "fm in win pos null");
-			const char *f1f = IndexToFieldName(fm->m1->from);
-			const char *f1t = IndexToFieldName(fm->m1->to);
-			DPRINT("saving move 1: from %s (%d), to %s (%d)", f1f, fm->m1->from, f1t, fm->m1->to);
-			*move1 = fm->m1;
-			*move2 = fm->m2;
+			DPRINT("saving move 1: from %s (%d), to %s (%d)", IndexToFieldName(fm->m1.from), fm->m1.from,
+			       IndexToFieldName(fm->m1.to), fm->m1.to);
+			*move1 = CloneMove(&fm->m1);
+			*move2 = fm->m2.from != NO_MOVE ? CloneMove(&fm->m2) : null;
 			value = WIN;
 			DPRINT("DFPNS: I am winner!!!");
-		} else if (saved->dn == 0 || saved->pn >= INFINITY) {	//moves from TT are moves to pos with lost in highest depth
+		} else if (solved) {	// saved->dn == 0 || saved->pn >= PNS_INFINITY, moves from TT are moves to pos with lost in highest depth
 			ASSERT(fm != null, "fm in lost pos null");
-			*move1 = fm->m1;
-			*move2 = fm->m2;
+			*move1 = CloneMove(&fm->m1);
+			*move2 = fm->m2.from != NO_MOVE ? CloneMove(&fm->m2) : null;
 			DPRINT("DFPNS: I'm looser :(");
 			value = -WIN;
 			if (recallAI) {
@@ -268,7 +647,7 @@ i32 GetBestMove(i32 ai, i32 time, Move ** move1, Move ** move2, bool recallAI)
 				value = 0;
 				DPRINT("calling alpha-beta:");
 				//call alpha-beta
-				GetBestMove(AIALPHABETA_BEST, time, move1, move2, false);
+				GetBestMove(AIALPHABETA_BEST, FallbackTime(time, tStart), move1, move2, false);
 				DPRINT("end call alpha-beta");
 				searchDuration += getDurationInSecs(tStart, tID);
 				value = oldVal;
@@ -280,46 +659,53 @@ i32 GetBestMove(i32 ai, i32 time, Move ** move1, Move ** move2, bool recallAI)
 				value = 0;
 				DPRINT("calling alpha-beta:");
 				//call alpha-beta
-				GetBestMove(AIALPHABETA_BEST, time, move1, move2, false);
+				GetBestMove(AIALPHABETA_BEST, FallbackTime(time, tStart), move1, move2, false);
 				DPRINT("end call alpha-beta");
 				searchDuration += getDurationInSecs(tStart, tID);
 				value = oldVal;
 			}
 		}
+		if (fm != null)
+			free(fm);
 	} else if (ai == BEGINNERS_AI) { // AI for beginners
 		DPRINT("AI FOR BEGINNERS: AB PVMO beginner");
-		FOR(i,0,15) { // set beginner material value constants
-				StackHeightValue[i] = StackHeightValueBeginner[i];
-		}
+		i32 oldParameters = evalParameters;	// restored after the search, the constants are set for the thread
+		SetEvalParameters(EVAL_BEGINNER);
 		i32 ret = 0;
 		ttimestamp tStart = get_timer();
 		ttimestamp tID;
 		i32 depth = 2;
 		double lastTime, currTime = 0;
 		Move *m1 = null, *m2 = null, *lastm1, *lastm2;	//for better moves in losen positions (when using TT)
+		i32 workers = StartYBWCWorkers();	// for the root of the random search
 		do {
 			lastm1 = m1, lastm2 = m2;
 			currDepth = depth;
 			searchedNodes = 0;
-			DBG(moveAlive = entryAlive = ttHit = ttFound = ttKick = prunedCount = ttCollision = 0);
+			DBG(entryAlive = ttKick = ttCollision = 0);
 			ret = AlphaBetaPVMORandomBeginner(depth, AI_RANDOM_MARGIN_BIGGER);
 			DBG2(printZOCDebug());
 			tID = get_timer();
 			lastTime = currTime;
 			currTime = getDurationInSecs(tStart, tID);
-			DPRINT("Alpha-Beta: pl %d, depth %d, time %0.3f s, searched: %d, return: %d, pruned %d", player,
-			       depth, currTime, searchedNodes, ret, prunedCount);
-			DPRINT("Alive: move %d, entries %d, kicks from TT %d, ttHits %d, ttFound %d",
-			       moveAlive, entryAlive, ttKick, ttHit, ttFound);
+			searchStats.nodes += searchedNodes;
+			searchStats.depth = depth;
+			TelemetryIteration(ai, depth, searchedNodes, currTime, ret, false);
+			DPRINT("Alpha-Beta: pl %d, depth %d, time %0.3f s, searched: %d, return: %d", player,
+			       depth, currTime, searchedNodes, ret);
+			DPRINT("Alive: entries %d, kicks from TT %d", entryAlive, ttKick);
 			ASSERT(ttCollision == 0 || ttCollision > 1000000, "FOUND TT COLLISION: %d", ttCollision);
-			TTEntry *saved = LookupPositionInTT();
+			TTEntry savedEntry;
+			TTEntry *saved = LookupPositionInTT(&savedEntry);
 			if (saved == null) {
 				DPRINT("Error: cannot find position in TT!!!\n");
+				StopYBWCWorkers(workers);
+				SetEvalParameters(oldParameters);
 				return false;
 			}
-			m1 = CloneMove(saved->bestMove1);
-			if (saved->bestMove2 != null)
-				m2 = CloneMove(saved->bestMove2);
+			m1 = CloneMove(&saved->bestMove1);
+			if (saved->bestMove2.from != NO_MOVE)
+				m2 = CloneMove(&saved->bestMove2);
 			if (abs(ret) == WIN) {
 				if (ret == -WIN && lastm1 != null && lastm2 != null) {
 					DPRINT("AB: I am looser :(");
@@ -331,6 +717,9 @@ i32 GetBestMove(i32 ai, i32 time, Move ** move1, Move ** move2, bool recallAI)
 			}
 			depth += 1;
 		} while (depth <= BEGINNER_AB_DEPTH && abs(ret) < WIN);
+		StopYBWCWorkers(workers);
+		SetEvalParameters(oldParameters);
+		TelemetrySearch(ai, currTime, 1 + workers);
 		searchDuration = currTime;
 		value = ret;	// because of saving
 		*move1 = m1;
@@ -344,29 +733,34 @@ i32 GetBestMove(i32 ai, i32 time, Move ** move1, Move ** move2, bool recallAI)
 		i32 depth = 2;
 		double lastTime, currTime = 0;
 		Move *m1 = null, *m2 = null, *lastm1, *lastm2;	//for better moves in losen positions (when using TT)
+		i32 workers = StartYBWCWorkers();	// for the root of the random search
 		do {
 			lastm1 = m1, lastm2 = m2;
 			currDepth = depth;
 			searchedNodes = 0;
-			DBG(moveAlive = entryAlive = ttHit = ttFound = ttKick = prunedCount = ttCollision = 0);
+			DBG(entryAlive = ttKick = ttCollision = 0);
 			ret = AlphaBetaPVMORandom(depth, AI_RANDOM_MARGIN);
 			DBG2(printZOCDebug());
 			tID = get_timer();
 			lastTime = currTime;
 			currTime = getDurationInSecs(tStart, tID);
-			DPRINT("Alpha-Beta: pl %d, depth %d, time %0.3f s, searched: %d, return: %d, pruned %d", player,
-			       depth, currTime, searchedNodes, ret, prunedCount);
-			DPRINT("Alive: move %d, entries %d, kicks from TT %d, ttHits %d, ttFound %d",
-			       moveAlive, entryAlive, ttKick, ttHit, ttFound);
+			searchStats.nodes += searchedNodes;
+			searchStats.depth = depth;
+			TelemetryIteration(ai, depth, searchedNodes, currTime, ret, false);
+			DPRINT("Alpha-Beta: pl %d, depth %d, time %0.3f s, searched: %d, return: %d", player,
+			       depth, currTime, searchedNodes, ret);
+			DPRINT("Alive: entries %d, kicks from TT %d", entryAlive, ttKick);
 			ASSERT(ttCollision == 0 || ttCollision > 1000000, "FOUND TT COLLISION: %d", ttCollision);
-			TTEntry *saved = LookupPositionInTT();
+			TTEntry savedEntry;
+			TTEntry *saved = LookupPositionInTT(&savedEntry);
 			if (saved == null) {
 				DPRINT("Error: cannot find position in TT!!!\n");
+				StopYBWCWorkers(workers);
 				return false;
 			}
-			m1 = CloneMove(saved->bestMove1); // the clone is needed because of possible kicks from transposition table
-			if (saved->bestMove2 != null)
-				m2 = CloneMove(saved->bestMove2);
+			m1 = CloneMove(&saved->bestMove1); // the clone is needed because of possible kicks from transposition table
+			if (saved->bestMove2.from != NO_MOVE)
+				m2 = CloneMove(&saved->bestMove2);
 			if (abs(ret) == WIN) {
 				if (ret == -WIN && lastm1 != null && lastm2 != null) {
 					DPRINT("AB: I am looser :(");
@@ -378,6 +772,8 @@ i32 GetBestMove(i32 ai, i32 time, Move ** move1, Move ** move2, bool recallAI)
 			}
 			depth += 1;
 		} while (depth <= INTERMEDIATE_AB_DEPTH && abs(ret) < WIN);
+		StopYBWCWorkers(workers);
+		TelemetrySearch(ai, currTime, 1 + workers);
 		searchDuration = currTime;
 		value = ret;	//because of saving
 		*move1 = m1;
@@ -11,6 +11,7 @@
 // TYPES
 //#include <stdio.h>
 #include <stdint.h>
+#include <stddef.h>
 
 //typedef uint_fast64_t thash;
 typedef unsigned long long thash;
@@ -18,12 +19,61 @@ typedef unsigned long long thash;
 typedef int i32;
 //typedef uint_fast32_t u32;
 typedef unsigned u32;
+typedef unsigned short u16;
+typedef unsigned char u8;
+typedef signed char i8;
 
-// DEBUG -- full (could slow down program) and fast 
-#define DEBUG
+// DEBUG -- full (could slow down program) and fast; prints of the search go to the standard output
+//#define DEBUG
+
+// TELEMETRY -- thread-local counters of the search (TT, cutoffs, evaluations, move generation) written
+// as JSON lines when asked for, see telemetry.h; without it the counters are not compiled in
+#define TELEMETRY
 
 //#define SEARCHFORBUG
 
+// BITBOARDS -- alternate position backend: occupancy of the board is held also in 128-bit bitboards
+// (stack heights stay in stackHeights) and rays are scanned using precomputed masks
+#define BITBOARDS
+
+#ifdef BITBOARDS
+typedef unsigned __int128 tbitboard;	// one bit per field of the board array
+#endif
+
+// LINE_TABLES -- the first stack in a direction is looked up in precomputed tables indexed by
+// a hex line, a position on the line and the occupancy of the line (like rotated bitboards in chess)
+#define LINE_TABLES
+
+// INCREMENTAL_EVAL -- StaticValue keeps its terms from the last evaluation in the thread and recomputes
+// only those whose inputs (highest stacks, ZOC or count of a stone type) have changed since
+#define INCREMENTAL_EVAL
+
+// CHECK_INCREMENTAL_EVAL -- every incremental static value is compared with the full computation (slow),
+// mismatches are printed and counted also without DEBUG
+//#define CHECK_INCREMENTAL_EVAL
+
+// EVAL_CACHE -- leaves look up their static value in a small direct-mapped cache keyed by hash first, because
+// the same position is often reached by different orders of half-moves
+#define EVAL_CACHE
+
+// QUIESCENCE -- leaves of Alpha-beta AIs built on AlphaBetaPVMO (4, 6-11, 41) search loud captures (of stacks or of the last
+// stones of a type) further, see Quiescence in alphaBeta.c
+#define QUIESCENCE
+
+// KILLER_MOVES -- AlphaBetaPVMO* save half-moves of turns causing cutoffs as killer moves of their plies and as
+// countermoves to the last move of the opponent, the sorted generators order them first, see SaveKillerMoves in alphaBeta.c
+#define KILLER_MOVES
+
+// THREAD_LOCAL_STATE -- the position and the search state (transposition tables included) are separate
+// for every thread, so several positions can be searched concurrently in one process; required by -j
+#define THREAD_LOCAL_STATE
+
+#ifdef THREAD_LOCAL_STATE
+#define THREAD_LOCAL __thread
+#else
+#define THREAD_LOCAL
+#endif
+
 //helpful macros
 #define null NULL
 #define true 1
@@ -35,6 +85,8 @@ typedef unsigned u32;
 #define SIGN(a) ((a) > 0 ? 1 : ((a) < 0 ? -1 : 0))
 #define MAX(a,b) ((a) >= (b) ? (a) : (b))
 #define MIN(a,b) ((a) <= (b) ? (a) : (b))
+#define COLOUR_INDEX(pl) ((1 - (pl)) / 2)	// WHITE -> 0, BLACK -> 1
+#define BIT(i) (((tbitboard) 1) << (i))
 
 #ifdef DEBUG
 	// Prints a message to the output. Flushing the buffer is because of program termination.
@@ -69,6 +121,8 @@ typedef unsigned u32;
 // CONSTANTS
 // ----------------
 #define BOARD_ARRAY_SIZE 81
+#define LINE_COUNT 30		// hex lines of the board, the lines through the center are split into two
+#define MAX_LINE_LENGTH 8
 #define INVALID_INPUT -1
 
 // types of fields
@@ -87,6 +141,7 @@ typedef unsigned u32;
 #define MAX_STACK_HEIGHT 15
 #define MAX_MOVES 121		//per moveNumber -- it's 60 * 2 (capture + pass)
 #define MAX_POSSIBILITIES 200	// per move of a player, it's 30*6 (max. 30 stones per player and 6 directions)
+#define NO_MOVE -2		// from of a move that is not set (ie. the second best move when the first one wins)
 
 // players
 #define WHITE 1
@@ -110,8 +165,17 @@ typedef unsigned u32;
 #define AI_RANDOM_MARGIN 20
 #define AI_RANDOM_MARGIN_BIGGER 5000
 #define MIN_AB_DEPTH 5
+#define DFPNS_FALLBACK_MIN_TIME 1	// seconds for Alpha-beta called by DFPNS after the DFPNS chunks used the time limit
+#define MAX_PONDER_DEPTH 30	// ID stops at this depth when it's not limited by time because of pondering
+#define MAX_SEARCH_THREADS 64	// maximum for -j, the main thread included
+#define HELPER_HISTORY_NOISE 8	// initial values of the history table of helper threads are random below this
+#define ABORT_CHECK_NODES 1023	// the clock is checked when more than ABORT_CHECK_NODES nodes were searched since the last check
 #define BEGINNER_AB_DEPTH 4
 #define INTERMEDIATE_AB_DEPTH 5
+#define ASPIRATION_WINDOW 10000	// ID Alpha-beta searches an iteration in (value - this, value + this) around the value of the previous one
+#define ASPIRATION_WIDEN 4	// after a fail-low or fail-high the distance of the failed bound is multiplied by this
+#define ASPIRATION_MIN_DEPTH 3	// iterations with a lower depth are searched with the full window
+#define MTDF_STEP 100	// the first step of MTD(f) from the bound returned by a zero-window search
 
 //types of AI
 #define HUMAN 0			// not supported :)
@@ -124,7 +188,12 @@ typedef unsigned u32;
 #define AIALPHABETA_ID_PV_MO_SCOUT 7
 #define AIALPHABETA_ID_PV_MO_HISTORY 8
 #define AIALPHABETA_ID_PV_MO_SCOUT_HISTORY 9
-#define AIALPHABETA_MAX 9
+#define AIALPHABETA_ID_PV_MO_YBWC 10		// parallel by YBWC with -j
+#define AIALPHABETA_ID_MTDF 11	// MTD(f) on AIALPHABETA_ID_PV_MO_HISTORY
+#define AIALPHABETA_ID_LMR 12	// AIALPHABETA_ID_PV_MO_SCOUT_HISTORY with late move reductions, see SelectiveSearchOfAI
+#define AIALPHABETA_ID_FUTILITY 13	// with futility pruning, it loses to AIALPHABETA_ID_PV_MO_SCOUT_HISTORY
+#define AIALPHABETA_ID_SELECTIVE 14	// with both
+#define AIALPHABETA_MAX 14
 #define AIALPHABETA_BEST 9
 #define DFPNS 20
 #define DFPNS_EPS_TRICK 21
@@ -153,53 +222,106 @@ static __attribute__ ((unused))
 i32 InitialStoneCounts[] = { CTZAARS, CTZARRAS, CTOTTS, 0, CTOTTS, CTZARRAS, CTZAARS };
 
 typedef struct move {
-	i32 from, to;		//pass move <=> from == -1 and to == -1;
-	struct move *next;	//for generating, not history
+	i32 from, to;		//pass move <=> from == -1 and to == -1; from == NO_MOVE for no move
 	i32 oldStackHeight, oldStone;
 	i32 value;		// value
 } Move;
 
 typedef struct fullMove {	//for pns
-	Move *m1, *m2;
+	Move m1, m2;		// m2.from == NO_MOVE if m1 wins
 } FullMove;
 
 // Position reprezentation
-extern i32 board[BOARD_ARRAY_SIZE];
-extern i32 stackHeights[BOARD_ARRAY_SIZE];
-extern i32 player, moveNumber;
+extern THREAD_LOCAL i32 board[BOARD_ARRAY_SIZE];
+extern THREAD_LOCAL i32 stackHeights[BOARD_ARRAY_SIZE];
+extern THREAD_LOCAL i32 player, moveNumber;
+#ifdef BITBOARDS
+extern THREAD_LOCAL tbitboard occupiedBitboard;		// all stacks on the board
+extern THREAD_LOCAL tbitboard colourBitboards[2];		// stacks by colour, indexed by COLOUR_INDEX
+extern THREAD_LOCAL tbitboard stoneBitboards[STONE_TYPES];	// stacks by type, indexed by board[i] + 3
+#endif
+#ifdef LINE_TABLES
+extern THREAD_LOCAL u8 lineOccupancy[LINE_COUNT];		// bit k is set when k-th field of the line is not empty
+#endif
 
 // History
-extern i32 turnNumber;
-extern Move *history[MAX_MOVES];
+extern THREAD_LOCAL i32 turnNumber;
+extern THREAD_LOCAL Move *history[MAX_MOVES];
 
 // Position properties useful for evaluation function and moves sorting
-extern i32 counts[STONE_TYPES];
-extern i32 value, materialValue, stoneSum;
-extern thash hash;
-extern i32 highestStack[STONE_TYPES];
-extern i32 countsByHeight[STONE_TYPES][MAX_STACK_HEIGHT];
-extern i32 zoneOfControl[STONE_TYPES], threatenByCounts[BOARD_ARRAY_SIZE];
+extern THREAD_LOCAL i32 counts[STONE_TYPES];
+extern THREAD_LOCAL i32 value, materialValue, stoneSum;
+extern THREAD_LOCAL thash hash;
+extern THREAD_LOCAL i32 highestStack[STONE_TYPES];
+extern THREAD_LOCAL i32 countsByHeight[STONE_TYPES][MAX_STACK_HEIGHT];
+extern THREAD_LOCAL i32 zoneOfControl[STONE_TYPES], threatenByCounts[BOARD_ARRAY_SIZE];
 
 // For saving
-extern double searchDuration;
+extern THREAD_LOCAL double searchDuration;
+
+typedef struct positionState {	// a copy of the position with all properties counted for it, for other threads
+	i32 board[BOARD_ARRAY_SIZE];
+	i32 stackHeights[BOARD_ARRAY_SIZE];
+	i32 player, moveNumber, turnNumber;
+#ifdef BITBOARDS
+	tbitboard occupiedBitboard, colourBitboards[2], stoneBitboards[STONE_TYPES];
+#endif
+#ifdef LINE_TABLES
+	u8 lineOccupancy[LINE_COUNT];
+#endif
+	i32 counts[STONE_TYPES];
+	i32 value, materialValue, stoneSum;
+	thash hash;
+	i32 highestStack[STONE_TYPES];
+	i32 countsByHeight[STONE_TYPES][MAX_STACK_HEIGHT];
+	i32 zoneOfControl[STONE_TYPES], threatenByCounts[BOARD_ARRAY_SIZE];
+} PositionState;
 
 // For searching (AB and PNS)
-extern i32 currDepth;		//for tests on AB
-extern u32 searchedNodes;
+extern THREAD_LOCAL i32 currDepth;		//for tests on AB
+extern THREAD_LOCAL u32 searchedNodes;
+extern THREAD_LOCAL u32 searchGeneration;	//increased by each GetBestMove, for aging TT entries
+extern volatile bool stopSearch;	//set by another thread (the daemon), the running search is aborted
+extern volatile bool pondering;	//set by the daemon, the time limit is ignored while it's true
+extern volatile double ponderTimeShift;	//seconds added to the time limit after pondering ends (ie. time spent by pondering)
+extern i32 searchThreads;	//number of threads of the alpha-beta search including the main one, set by -j
+extern THREAD_LOCAL i32 searchDepthLimit;	//if > 0, Alpha-beta searches exactly to this depth regardless of the time limit (for benchmarks)
+extern THREAD_LOCAL u32 searchNodeLimit;	//if > 0, DFPNS searches one chunk of this many nodes and ID Alpha-beta starts iterations until it searched this many nodes, both regardless of the time limit
+extern THREAD_LOCAL u32 randomSeed;	//if > 0, random AIs seed rand by it instead of the time, so that they are reproducible
+extern THREAD_LOCAL bool searchAborted;	//set when the deadline passes or stopSearch is set, searches unwind and return 0
+extern THREAD_LOCAL volatile bool *abortFlag;	//if not null, the search is aborted also when *abortFlag is set (by another thread)
+
+typedef struct searchStats {	// totals of searches of the thread since the caller zeroed them (ie. all iterations of ID)
+	unsigned long long nodes;
+	i32 depth;		// the last finished iteration of Alpha-beta, 0 for DFPNS
+} SearchStats;
+extern THREAD_LOCAL SearchStats searchStats;
+
+extern THREAD_LOCAL u32 abortCheckNodes;	//searchedNodes at the last check, DFPNS adds many nodes between two checks
+
+/// true if the search should be aborted, checks the clock only once per ABORT_CHECK_NODES + 1 nodes
+#define SEARCH_ABORTED() (searchAborted || (searchedNodes - abortCheckNodes > ABORT_CHECK_NODES && CheckSearchAbort()))
 
 // Debug constants
 #ifdef DEBUG
-extern i32 moveAlive, entryAlive, ttHit, ttFound, ttKick, prunedCount, entry2Alive, tt2Kick, tt2Hit, tt2Found, ttCollision;
+extern THREAD_LOCAL i32 entryAlive, entry2Alive, ttKick, tt2Kick, ttCollision;
 #endif
 
 // ---------------
 // FUNCTIONS -- TZAAR LIB
 // ---------------
 i32 GetBestMove(i32 ai, i32 time, Move **move1, Move **move2, bool recallAI);
+bool CheckSearchAbort();
+void SavePositionState(PositionState * state);
+void RestorePositionState(PositionState * state);
+void *AllocateTable(size_t size);
+void FreeTable(void *table, size_t size);
 
 #include "tzaarmoves.h"
 #include "tzaarinit.h"
 #include "pns.h"
 #include "alphaBeta.h"
+#include "ybwc.h"
+#include "telemetry.h"
 
 #endif				// TZAARLIB_H_INCLUDED
@@ -26,20 +26,176 @@ i32 StackQuality(i32 stackHeight, i32 stone, i32 fieldTo)
 	    StackValueByField[stackHeight][fieldTo] * FIELD_VALUE_MULT;
 }
 
+#ifdef BITBOARDS
+tbitboard RayMasks[BOARD_ARRAY_SIZE][DIRECTION_COUNT];
+
+/// Precomputes masks of fields on rays from every field, the ray ends before the first border field
+void InitRayMasks()
+{
+	static bool initialized = false;
+	if (initialized)
+		return;
+	FOR(i, 0, BOARD_ARRAY_SIZE) {
+		FOR(j, 0, DIRECTION_COUNT) {
+			RayMasks[i][j] = 0;
+			if (StandardBoard[i] == BORDER)
+				continue;
+			// the same walk as in the board array, the 9x9 embedding is surrounded by border fields
+			i32 cx = i % 9 + dxs[j];
+			i32 cy = i / 9 + dys[j];
+			i32 curr = cy * 9 + cx;
+			while (curr >= 0 && curr < BOARD_ARRAY_SIZE && StandardBoard[curr] != BORDER) {
+				RayMasks[i][j] |= BIT(curr);
+				cx += dxs[j];
+				cy += dys[j];
+				curr = cy * 9 + cx;
+			}
+		}
+	}
+	initialized = true;
+}
+
+/// Returns the lowest index of a field in a non-empty bitboard
+inline __attribute__ ((always_inline))
+i32 BitboardLowest(tbitboard b)
+{
+	uint64_t low = (uint64_t) b;
+	if (low != 0)
+		return __builtin_ctzll(low);
+	return 64 + __builtin_ctzll((uint64_t) (b >> 64));
+}
+
+/// Returns the highest index of a field in a non-empty bitboard
+inline __attribute__ ((always_inline))
+i32 BitboardHighest(tbitboard b)
+{
+	uint64_t high = (uint64_t) (b >> 64);
+	if (high != 0)
+		return 127 - __builtin_clzll(high);
+	return 63 - __builtin_clzll((uint64_t) b);
+}
+
+/// Moves a stack between fields from and to in bitboards; the same call reverts it (everything is xor)
+/// movedStone is the stack on the field from, oldStone was on the field to before the move
+inline __attribute__ ((always_inline))
+void ToggleMoveInBitboards(i32 from, i32 to, i32 movedStone, i32 oldStone)
+{
+	tbitboard bFrom = BIT(from), bTo = BIT(to);
+	occupiedBitboard ^= bFrom;
+	colourBitboards[COLOUR_INDEX(SIGN(movedStone))] ^= bFrom | bTo;
+	colourBitboards[COLOUR_INDEX(SIGN(oldStone))] ^= bTo;
+	stoneBitboards[movedStone + 3] ^= bFrom | bTo;
+	stoneBitboards[oldStone + 3] ^= bTo;
+}
+#endif
+
+#ifdef LINE_TABLES
+u8 LineOfField[BOARD_ARRAY_SIZE][DIRECTION_COUNT / 2];
+u8 PositionOnLine[BOARD_ARRAY_SIZE][DIRECTION_COUNT / 2];
+u8 LineFields[LINE_COUNT][MAX_LINE_LENGTH];
+u8 LineBlockers[MAX_LINE_LENGTH][1 << MAX_LINE_LENGTH][2];
+
+/// Splits the board into hex lines and precomputes the first blockers for every occupancy of a line
+void InitLineTables()
+{
+	static bool initialized = false;
+	if (initialized)
+		return;
+	FOR(i, 0, BOARD_ARRAY_SIZE) {
+		FOR(axis, 0, DIRECTION_COUNT / 2) {
+			LineOfField[i][axis] = PositionOnLine[i][axis] = LINE_NONE;
+		}
+	}
+	i32 lines = 0;
+	FOR(axis, 0, DIRECTION_COUNT / 2) {
+		i32 dir = 2 * axis;	// the direction to higher indices
+		FOR(i, 0, BOARD_ARRAY_SIZE) {
+			if (StandardBoard[i] == BORDER || LineOfField[i][axis] != LINE_NONE)
+				continue;
+			// i is the first field of a new line, because fields are visited by increasing index
+			ASSERT(lines < LINE_COUNT, "InitLineTables: too many lines");
+			i32 cx = i % 9, cy = i / 9, curr = i, length = 0;
+			while (curr >= 0 && curr < BOARD_ARRAY_SIZE && StandardBoard[curr] != BORDER) {
+				ASSERT(length < MAX_LINE_LENGTH, "InitLineTables: too long line");
+				LineOfField[curr][axis] = lines;
+				PositionOnLine[curr][axis] = length;
+				LineFields[lines][length++] = curr;
+				cx += dxs[dir];
+				cy += dys[dir];
+				curr = cy * 9 + cx;
+			}
+			lines++;
+		}
+	}
+	ASSERT(lines == LINE_COUNT, "InitLineTables: %d lines instead of %d", lines, LINE_COUNT);
+	FOR(pos, 0, MAX_LINE_LENGTH) {
+		FOR(occ, 0, 1 << MAX_LINE_LENGTH) {
+			LineBlockers[pos][occ][0] = LineBlockers[pos][occ][1] = LINE_NONE;
+			for (i32 k = pos + 1; k < MAX_LINE_LENGTH; k++) {
+				if (occ & (1 << k)) {
+					LineBlockers[pos][occ][0] = k;
+					break;
+				}
+			}
+			for (i32 k = pos - 1; k >= 0; k--) {
+				if (occ & (1 << k)) {
+					LineBlockers[pos][occ][1] = k;
+					break;
+				}
+			}
+		}
+	}
+	initialized = true;
+}
+
+/// Changes the occupancy of the field in all three lines going through it
+inline __attribute__ ((always_inline))
+void ToggleFieldInLines(i32 field)
+{
+	FOR(axis, 0, DIRECTION_COUNT / 2) {
+		lineOccupancy[LineOfField[field][axis]] ^= 1 << PositionOnLine[field][axis];
+	}
+}
+#endif
+
+/// Returns the index of the first stack on the ray from the field in the direction dir, or -1 when there is none
+inline __attribute__ ((always_inline))
+i32 NextStoneInDirection(i32 field, i32 dir)
+{
+#if defined(LINE_TABLES)
+	i32 axis = dir >> 1;
+	i32 line = LineOfField[field][axis];
+	i32 pos = LineBlockers[PositionOnLine[field][axis]][lineOccupancy[line]][dir & 1];
+	if (pos == LINE_NONE)
+		return -1;
+	return LineFields[line][pos];
+#elif defined(BITBOARDS)
+	tbitboard ray = RayMasks[field][dir] & occupiedBitboard;
+	if (ray == 0)
+		return -1;
+	return (dir & 1) ? BitboardHighest(ray) : BitboardLowest(ray);
+#else
+	i32 cx = field % 9 + dxs[dir];
+	i32 cy = field / 9 + dys[dir];
+	i32 curr = cy * 9 + cx;
+	while (curr >= 0 && curr < BOARD_ARRAY_SIZE && board[curr] == EMPTY) {
+		cx += dxs[dir];
+		cy += dys[dir];
+		curr = cy * 9 + cx;
+	}
+	if (curr < 0 || curr >= BOARD_ARRAY_SIZE || board[curr] == BORDER)
+		return -1;
+	return curr;
+#endif
+}
+
 /// Updating ZOC after removing a stone on the field to
 inline __attribute__ ((always_inline))
 void ZOCRemovingStoneTo(i32 field)
 {				// supposing that stone is still on its old place ...
 	FOR(j, 0, DIRECTION_COUNT) {
-		i32 cx = field % 9 + dxs[j];
-		i32 cy = field / 9 + dys[j];
-		i32 curr = cy * 9 + cx;
-		while (curr >= 0 && curr < BOARD_ARRAY_SIZE && board[curr] == EMPTY) {
-			cx += dxs[j];
-			cy += dys[j];
-			curr = cy * 9 + cx;
-		}
-		if (curr >= 0 && curr < BOARD_ARRAY_SIZE && board[curr] != BORDER && board[field] * board[curr] < 0) {
+		i32 curr = NextStoneInDirection(field, j);
+		if (curr >= 0 && board[field] * board[curr] < 0) {
 			if (stackHeights[field] >= stackHeights[curr]) {
 				threatenByCounts[curr]--;
 				if (threatenByCounts[curr] == 0) {
@@ -63,15 +219,8 @@ void ZOCRemovingStoneFrom(i32 field, i32 to)
 	i32 opposites[DIRECTION_COUNT / 2];
 	FOR(j, 0, DIRECTION_COUNT / 2) opposites[j] = -1;
 	FOR(j, 0, DIRECTION_COUNT) {
-		i32 cx = field % 9 + dxs[j];
-		i32 cy = field / 9 + dys[j];
-		i32 curr = cy * 9 + cx;
-		while (curr >= 0 && curr < BOARD_ARRAY_SIZE && board[curr] == EMPTY) {
-			cx += dxs[j];
-			cy += dys[j];
-			curr = cy * 9 + cx;
-		}
-		if (curr >= 0 && curr < BOARD_ARRAY_SIZE && board[curr] != BORDER) {
+		i32 curr = NextStoneInDirection(field, j);
+		if (curr >= 0) {
 			i32 o = opposites[j / 2];
 			if (o == -1)
 				opposites[j / 2] = curr;
@@ -114,15 +263,8 @@ void ZOCAddedStoneFrom(i32 field, i32 to)
 	i32 opposites[DIRECTION_COUNT / 2];
 	FOR(j, 0, DIRECTION_COUNT / 2) opposites[j] = -1;
 	FOR(j, 0, DIRECTION_COUNT) {
-		i32 cx = field % 9 + dxs[j];
-		i32 cy = field / 9 + dys[j];
-		i32 curr = cy * 9 + cx;
-		while (curr >= 0 && curr < BOARD_ARRAY_SIZE && board[curr] == EMPTY) {
-			cx += dxs[j];
-			cy += dys[j];
-			curr = cy * 9 + cx;
-		}
-		if (curr >= 0 && curr < BOARD_ARRAY_SIZE && board[curr] != BORDER) {
+		i32 curr = NextStoneInDirection(field, j);
+		if (curr >= 0) {
 			i32 o = opposites[j / 2];
 			if (o == -1)
 				opposites[j / 2] = curr;
@@ -163,15 +305,8 @@ inline __attribute__ ((always_inline))
 void ZOCAddedStoneTo(i32 field)
 {				// supposing stone is already on its place 
 	FOR(j, 0, DIRECTION_COUNT) {
-		i32 cx = field % 9 + dxs[j];
-		i32 cy = field / 9 + dys[j];
-		i32 curr = cy * 9 + cx;
-		while (curr >= 0 && curr < BOARD_ARRAY_SIZE && board[curr] == EMPTY) {
-			cx += dxs[j];
-			cy += dys[j];
-			curr = cy * 9 + cx;
-		}
-		if (curr >= 0 && curr < BOARD_ARRAY_SIZE && board[curr] != BORDER && board[field] * board[curr] < 0) {
+		i32 curr = NextStoneInDirection(field, j);
+		if (curr >= 0 && board[field] * board[curr] < 0) {
 			if (stackHeights[field] >= stackHeights[curr]) {
 				if (threatenByCounts[curr] == 0) {
 					zoneOfControl[board[curr] + 3]++;
@@ -188,39 +323,12 @@ void ZOCAddedStoneTo(i32 field)
 	}
 }
 
-/// Free a move and update counters
+/// Free a move allocated by CloneMove
 inline __attribute__ ((always_inline))
 void FreeMove(Move * move)
 {
 	ASSERT2(move != null, "move to free null");
 	free(move);
-	DBG(moveAlive--);
-}
-
-/// Free linked list of moves, but only the ones that are different from exception
-/// Note: exception == null may occure
-inline __attribute__ ((always_inline))
-void FreeAllMoves(Move * move, Move * exception)
-{
-	Move *tmp;
-	while (move != NULL) {
-		tmp = move;
-		move = move->next;
-		if (tmp != exception)
-			FreeMove(tmp);
-	}
-}
-
-/// Free linked list of moves
-inline __attribute__ ((always_inline))
-void FreeAllMovesWithoutException(Move * move)
-{
-	Move *tmp;
-	while (move != NULL) {
-		tmp = move;
-		move = move->next;
-		FreeMove(tmp);
-	}
 }
 
 /// Returns whether a given move is possible in the current position
@@ -245,6 +353,19 @@ i32 IsMovePossible(Move * move)
 		return false;	// empty target
 	if (board[from] == EMPTY)
 		return false;	// empty source  
+#ifdef LINE_TABLES
+	// source and target have to be on the same line and there cannot be any stack between them
+	bool freeLine = false;
+	FOR(axis, 0, DIRECTION_COUNT / 2) {
+		if (LineOfField[from][axis] == LineOfField[to][axis]) {
+			i32 dir = 2 * axis + (PositionOnLine[to][axis] < PositionOnLine[from][axis]);
+			freeLine = NextStoneInDirection(from, dir) == to;
+			break;
+		}
+	}
+	if (!freeLine)
+		return false;
+#else
 	i32 sx = from % 9;
 	i32 sy = from / 9;	// source in the x, y coordinates
 	i32 tx = to % 9;
@@ -258,6 +379,12 @@ i32 IsMovePossible(Move * move)
 		return false;
 
 	// ensure that all lines between source and target are empty
+#ifdef BITBOARDS
+	FOR(j, 0, DIRECTION_COUNT) {
+		if (dxs[j] == dx && dys[j] == dy && NextStoneInDirection(from, j) != to)
+			return false;
+	}
+#else
 	i32 cx = sx, cy = sy;
 	while (true) {
 		cx += dx;
@@ -271,6 +398,8 @@ i32 IsMovePossible(Move * move)
 			return false;
 
 	}
+#endif
+#endif
 	if (board[from] * board[to] > 0) {	// stacking
 		if (counts[board[to] + 3] == 1)
 			return false;	// don't stack on last piece
@@ -303,19 +432,17 @@ bool HasLegalMoves()
 {
 	ASSERT2(moveNumber == 1, "hasLegalMoves is useless when moveNumber == 2");
 	ASSERT(false, "calling has legal moves");
+#ifdef BITBOARDS
+	for (tbitboard stones = colourBitboards[COLOUR_INDEX(player)]; stones != 0; stones &= stones - 1) {
+		i32 i = BitboardLowest(stones);
+#else
 	for (i32 i = 0; i < BOARD_ARRAY_SIZE; i++) {
 		if (board[i] == BORDER || board[i] == EMPTY || board[i] * player < 0)
 			continue;
+#endif
 		for (i32 j = 0; j < DIRECTION_COUNT; j++) {
-			i32 cx = i % 9 + dxs[j];
-			i32 cy = i / 9 + dys[j];
-			i32 curr = cy * 9 + cx;
-			while (curr >= 0 && curr < BOARD_ARRAY_SIZE && board[curr] == EMPTY) {
-				cx += dxs[j];
-				cy += dys[j];
-				curr = cy * 9 + cx;
-			}
-			if (curr < 0 || curr >= BOARD_ARRAY_SIZE || board[curr] == BORDER)
+			i32 curr = NextStoneInDirection(i, j);
+			if (curr < 0)
 				continue;
 			if (board[i] * board[curr] > 0)
 				continue;
@@ -436,6 +563,12 @@ void ExecuteMove(Move * move)
 			highestStack[stoneIndexFrom] = hNew;
 		}
 		counts[board[to] + 3]--;
+#ifdef BITBOARDS
+		ToggleMoveInBitboards(from, to, board[from], board[to]);
+#endif
+#ifdef LINE_TABLES
+		ToggleFieldInLines(from);	// the field to stays occupied
+#endif
 		board[to] = board[from];
 		// clear from field
 		board[from] = EMPTY;
@@ -524,6 +657,12 @@ void RevertLastMove()
 			highestStack[stoneIndexTo] = hFrom;
 		}
 		// update board
+#ifdef BITBOARDS
+		ToggleMoveInBitboards(from, to, board[to], move->oldStone);
+#endif
+#ifdef LINE_TABLES
+		ToggleFieldInLines(from);
+#endif
 		board[from] = board[to];
 		board[to] = move->oldStone;
 		stackHeights[to] = move->oldStackHeight;
@@ -580,23 +719,26 @@ const char *IndexToFieldName(i32 index)
 	return FieldNames[index];
 }
 
-/// Generate all moves and return linked list of them (moveNumber could be 1 or 2)
-inline void GenerateAllMoves(Move ** moves)
+THREAD_LOCAL Move moveStack[MAX_MOVES][MAX_POSSIBILITIES];	// generated moves for each ply, indexed like history
+
+/// Generate all moves into the move stack of the current ply (moveNumber could be 1 or 2), returns their count
+/// Note: moves are in the reverse order of generating with the pass move first
+inline i32 GenerateAllMoves(Move ** moves)
 {
-	Move *m = null;
+	TCOUNT(genCalls);
+	Move *end = moveStack[turnNumber * 2 + moveNumber] + MAX_POSSIBILITIES;
+	Move *m = end;		// filled from the end of the array
+#ifdef BITBOARDS
+	for (tbitboard stones = colourBitboards[COLOUR_INDEX(player)]; stones != 0; stones &= stones - 1) {
+		i32 i = BitboardLowest(stones);
+#else
 	for (i32 i = 0; i < BOARD_ARRAY_SIZE; i++) {
 		if (board[i] == BORDER || board[i] == EMPTY || board[i] * player < 0)
 			continue;
+#endif
 		for (i32 j = 0; j < DIRECTION_COUNT; j++) {
-			i32 cx = i % 9 + dxs[j];
-			i32 cy = i / 9 + dys[j];
-			i32 curr = cy * 9 + cx;
-			while (curr >= 0 && curr < BOARD_ARRAY_SIZE && board[curr] == EMPTY) {
-				cx += dxs[j];
-				cy += dys[j];
-				curr = cy * 9 + cx;
-			}
-			if (curr < 0 || curr >= BOARD_ARRAY_SIZE || board[curr] == BORDER)
+			i32 curr = NextStoneInDirection(i, j);
+			if (curr < 0)
 				continue;
 			bool capt = board[i] * board[curr] < 0;
 			if (!capt) {
@@ -606,53 +748,95 @@ inline void GenerateAllMoves(Move ** moves)
 					continue;	//dont stack on the last piece, better is to pass
 			} else if (stackHeights[i] < stackHeights[curr])
 				continue;
-			Move *n = (Move *) malloc(sizeof(Move));
-			DBG(moveAlive++);
-			n->from = i;
-			n->to = curr;
-			n->next = m;
-			ASSERT2(IsMovePossible(n), "Gen all moves: move not possible");
-			m = n;
+			m--;
+			m->from = i;
+			m->to = curr;
+			ASSERT2(IsMovePossible(m), "Gen all moves: move not possible");
 		}
 	}
 	if (moveNumber == 2) {
-		Move *n = (Move *) malloc(sizeof(Move));
-		DBG(moveAlive++);
-		n->from = -1;	//n->to = 
-		n->next = m;
-		m = n;
+		m--;
+		m->from = m->to = -1;
 	}
 	*moves = m;
+	return end - m;
 }
 
-Move *moveArrayToSort[MAX_POSSIBILITIES]; // array for sorting moves
+THREAD_LOCAL Move moveSortBuffer[MAX_POSSIBILITIES];	// auxiliary array for merging in SortMoves
 
-/// Helping method for qsort from stdlib.h
-i32 compareMoves(const void *a, const void *b)
+/// Sort moves by their value, moves with the same value keep their order
+/// Note: bottom-up merge sort, so that nothing is allocated
+inline __attribute__ ((always_inline))
+void SortMoves(Move * moves, i32 count)
 {
-	return (*(Move **) a)->value - (*(Move **) b)->value;
+	Move *src = moves, *dst = moveSortBuffer;
+	for (i32 width = 1; width < count; width *= 2) {
+		for (i32 lo = 0; lo < count; lo += 2 * width) {
+			i32 mid = MIN(lo + width, count), hi = MIN(lo + 2 * width, count);
+			i32 a = lo, b = mid, k = lo;
+			while (a < mid && b < hi)
+				dst[k++] = src[b].value < src[a].value ? src[b++] : src[a++];
+			while (a < mid)
+				dst[k++] = src[a++];
+			while (b < hi)
+				dst[k++] = src[b++];
+		}
+		Move *tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+	if (src != moves)
+		memcpy(moves, src, count * sizeof(Move));
 }
 
-/// Generate all moves, sort them heuristically and return linked list of them (moveNumber could be 1 or 2)
-inline void GenerateAllMovesSorted(Move ** moves)
+#ifdef KILLER_MOVES
+/// Lowers values of generated moves which are killer moves of the current ply or the countermove to the last move
+/// of the opponent, so that SortMoves puts them before the other moves
+inline __attribute__ ((always_inline))
+void AddKillerBonuses(Move * moves, i32 count)
 {
+	u16 *killers = killerMoves[turnNumber * 2 + moveNumber];
+	u16 counter = 0;
+	if (turnNumber * 2 >= killerRootPly) {	// the last move of the opponent was executed by the search
+		Move *last = history[turnNumber * 2];
+		counter = counterMoves[moveNumber - 1][last->from + 1][last->to + 1];
+	}
+	if (killers[0] == 0 && counter == 0)
+		return;
+	for (Move *m = moves; m < moves + count; m++) {
+		u16 code = EncodeMove(m);
+		FOR(slot, 0, KILLER_SLOTS) {
+			if (killers[slot] == code) {
+				m->value -= SORT_KILLER_BONUS >> slot;
+				break;
+			}
+		}
+		if (code == counter)
+			m->value -= SORT_COUNTERMOVE_BONUS;
+	}
+}
+#endif
+
+/// Generate all moves into the move stack of the current ply and sort them heuristically, returns their count (moveNumber could be 1 or 2)
+inline i32 GenerateAllMovesSorted(Move ** moves)
+{
+	TCOUNT(genCalls);
 	ASSERT2(abs(value) < WIN, " -- generating moves in winning position!!, moveNumber %d", moveNumber);
 	DPRINT2("gen moves sorted, pl %d", player);
+	Move *m = moveStack[turnNumber * 2 + moveNumber];
 	i32 count = 0;		//captures = 0, 
+#ifdef BITBOARDS
+	for (tbitboard stones = colourBitboards[COLOUR_INDEX(player)]; stones != 0; stones &= stones - 1) {
+		i32 i = BitboardLowest(stones);
+#else
 	for (i32 i = 0; i < BOARD_ARRAY_SIZE; i++) {
 		if (board[i] == BORDER || board[i] == EMPTY || board[i] * player < 0)
 			continue;
+#endif
 		//DPRINT2("field %d, pl %d", i, player);
 		for (i32 j = 0; j < DIRECTION_COUNT; j++) {
-			i32 cx = i % 9 + dxs[j];
-			i32 cy = i / 9 + dys[j];
-			i32 curr = cy * 9 + cx;
-			while (curr >= 0 && curr < BOARD_ARRAY_SIZE && board[curr] == EMPTY) {
-				cx += dxs[j];
-				cy += dys[j];
-				curr = cy * 9 + cx;
-			}
-			if (curr < 0 || curr >= BOARD_ARRAY_SIZE || board[curr] == BORDER)
+			i32 curr = NextStoneInDirection(i, j);
+			if (curr < 0)
 				continue;
 			bool capt = board[i] * board[curr] < 0;
 			if (!capt) {
@@ -662,8 +846,7 @@ inline void GenerateAllMovesSorted(Move ** moves)
 					continue;	//dont stack on last piece
 			} else if (stackHeights[i] < stackHeights[curr])
 				continue;
-			Move *n = (Move *) malloc(sizeof(Move));
-			DBG(moveAlive++);
+			Move *n = &m[count++];
 			n->from = i;
 			n->to = curr;
 			if (capt) {
@@ -672,60 +855,48 @@ inline void GenerateAllMovesSorted(Move ** moves)
 				n->value = SORT_STACK_BONUS + SORT_STACK_COUNT_MULT * counts[board[i] + 3];
 			}
 			ASSERT2(IsMovePossible(n), "Gen all moves sorted: move not possible");
-			moveArrayToSort[count++] = n;
 		}
 	}
+	*moves = m;
 	if (count == 0) {
-		Move *n = (Move *) malloc(sizeof(Move));
-		DBG(moveAlive++);
-		n->from = n->to = -1;
-		n->next = null;
-		*moves = n;
-		return;
-	}
-	qsort(moveArrayToSort, count, sizeof(Move *), compareMoves);
-	for (i32 i = 1; i < count; i++) {
-		moveArrayToSort[i - 1]->next = moveArrayToSort[i];
+		m[0].from = m[0].to = -1;
+		return 1;
 	}
+	SortMoves(m, count);
 	if (moveNumber == 2) {	//pass move
-		Move *n = (Move *) malloc(sizeof(Move));
-		DBG(moveAlive++);
-		n->from = n->to = -1;
-		n->next = null;
-		moveArrayToSort[count - 1]->next = n;
-	} else
-		moveArrayToSort[count - 1]->next = null;
-	*moves = moveArrayToSort[0];
+		m[count].from = m[count].to = -1;
+		count++;
+	}
+	return count;
 }
 
-/// When the position is in moveNumber 1, generate all moves, sort them by heuristics and return a linked list of them
-inline void GenerateAllMovesSortedMove1(Move ** moves)
+/// When the position is in moveNumber 1, generate all moves into the move stack of the current ply and sort them by heuristics, returns their count
+/// (in moveNumber 2 it generates only captures, the quiescence search uses it so)
+inline i32 GenerateAllMovesSortedMove1(Move ** moves)
 {
+	TCOUNT(genCalls);
 	ASSERT2(abs(value) < WIN, " -- generating moves in winning position!!, moveNumber %d", moveNumber);
 	DPRINT2("gen moves sorted, pl %d", player);
-	ASSERT2(moveNumber == 1, "gen all moves sorted moveNumber NOT 1, but %d", moveNumber);
+	Move *m = moveStack[turnNumber * 2 + moveNumber];
 	i32 count = 0;
+#ifdef BITBOARDS
+	for (tbitboard stones = colourBitboards[COLOUR_INDEX(player)]; stones != 0; stones &= stones - 1) {
+		i32 i = BitboardLowest(stones);
+#else
 	for (i32 i = 0; i < BOARD_ARRAY_SIZE; i++) {
 		if (board[i] == BORDER || board[i] == EMPTY || board[i] * player < 0)
 			continue;
+#endif
 		for (i32 j = 0; j < DIRECTION_COUNT; j++) {
-			i32 cx = i % 9 + dxs[j];
-			i32 cy = i / 9 + dys[j];
-			i32 curr = cy * 9 + cx;
-			while (curr >= 0 && curr < BOARD_ARRAY_SIZE && board[curr] == EMPTY) {
-				cx += dxs[j];
-				cy += dys[j];
-				curr = cy * 9 + cx;
-			}
-			if (curr < 0 || curr >= BOARD_ARRAY_SIZE || board[curr] == BORDER)
+			i32 curr = NextStoneInDirection(i, j);
+			if (curr < 0)
 				continue;
 			bool capt = board[i] * board[curr] < 0;
 			if (!capt) {
 				continue;
 			} else if (stackHeights[i] < stackHeights[curr])
 				continue;
-			Move *n = (Move *) malloc(sizeof(Move));
-			DBG(moveAlive++);
+			Move *n = &m[count++];
 			n->from = i;
 			n->to = curr;
 			n->value =
@@ -733,39 +904,38 @@ inline void GenerateAllMovesSortedMove1(Move ** moves)
 			    CapturingStackHeightAdvantage[stackHeights[curr]]
 			    - (SORT_HISTORY_PRUNES_MULT * historyPruneMoves[i][curr]);
 			ASSERT2(IsMovePossible(n), "Gen all moves sorted: move not possible");
-			moveArrayToSort[count++] = n;
 		}
 	}
 	DPRINT2("sorting, pl %d", player);
-	ASSERT2(count > 0, "gen all moves sorted moveNumber 1, count %d", count);
-	qsort(moveArrayToSort, count, sizeof(Move *), compareMoves);
-	for (i32 i = 1; i < count; i++) {
-		moveArrayToSort[i - 1]->next = moveArrayToSort[i];
-	}
-	moveArrayToSort[count - 1]->next = null;
-	*moves = moveArrayToSort[0];
+	ASSERT2(count > 0 || moveNumber == 2, "gen all moves sorted moveNumber 1, count %d", count);
+#ifdef KILLER_MOVES
+	AddKillerBonuses(m, count);
+#endif
+	SortMoves(m, count);
+	*moves = m;
+	return count;
 }
 
-/// When the position is in moveNumber 2, generate all moves, sort them by heuristics and return a linked list of them
-inline void GenerateAllMovesSortedMove2(Move ** moves)
+/// When the position is in moveNumber 2, generate all moves into the move stack of the current ply and sort them by heuristics, returns their count
+inline i32 GenerateAllMovesSortedMove2(Move ** moves)
 {
+	TCOUNT(genCalls);
 	ASSERT2(abs(value) < WIN, " -- generating moves in winning position!!, moveNumber %d", moveNumber);
 	DPRINT2("gen moves sorted, pl %d", player);
 	ASSERT(moveNumber == 2, "gen all moves sorted moveNumber NOT 2, but %d", moveNumber);
+	Move *m = moveStack[turnNumber * 2 + moveNumber];
 	i32 count = 0;
+#ifdef BITBOARDS
+	for (tbitboard stones = colourBitboards[COLOUR_INDEX(player)]; stones != 0; stones &= stones - 1) {
+		i32 i = BitboardLowest(stones);
+#else
 	for (i32 i = 0; i < BOARD_ARRAY_SIZE; i++) {
 		if (board[i] == BORDER || board[i] == EMPTY || board[i] * player < 0)
 			continue;
+#endif
 		for (i32 j = 0; j < DIRECTION_COUNT; j++) {
-			i32 cx = i % 9 + dxs[j];
-			i32 cy = i / 9 + dys[j];
-			i32 curr = cy * 9 + cx;
-			while (curr >= 0 && curr < BOARD_ARRAY_SIZE && board[curr] == EMPTY) {
-				cx += dxs[j];
-				cy += dys[j];
-				curr = cy * 9 + cx;
-			}
-			if (curr < 0 || curr >= BOARD_ARRAY_SIZE || board[curr] == BORDER)
+			i32 curr = NextStoneInDirection(i, j);
+			if (curr < 0)
 				continue;
 			bool capt = board[i] * board[curr] < 0;
 			if (!capt) {
@@ -773,8 +943,7 @@ inline void GenerateAllMovesSortedMove2(Move ** moves)
 					continue;	//dont stack on last piece
 			} else if (stackHeights[i] < stackHeights[curr])
 				continue;
-			Move *n = (Move *) malloc(sizeof(Move));
-			DBG(moveAlive++);
+			Move *n = &m[count++];
 			n->from = i;
 			n->to = curr;
 			if (capt) {
@@ -783,48 +952,37 @@ inline void GenerateAllMovesSortedMove2(Move ** moves)
 				n->value = SORT_STACK_BONUS + SORT_STACK_COUNT_MULT * counts[board[i] + 3];
 			}
 			ASSERT2(IsMovePossible(n), "Gen all moves sorted: move not possible");
-			moveArrayToSort[count++] = n;
 		}
 	}
 	DPRINT2("sorting, pl %d", player);
-	if (count == 0) {
-		Move *n = (Move *) malloc(sizeof(Move));
-		DBG(moveAlive++);
-		n->from = n->to = -1;
-		n->next = null;
-		*moves = n;
-		return;
-	}
-	qsort(moveArrayToSort, count, sizeof(Move *), compareMoves);
-	for (i32 i = 1; i < count; i++) {
-		moveArrayToSort[i - 1]->next = moveArrayToSort[i];
-	}
-	//pass move
-	Move *n = (Move *) malloc(sizeof(Move));
-	DBG(moveAlive++);
-	n->from = n->to = -1;
-	n->next = null;
-	moveArrayToSort[count - 1]->next = n;	// count > 0 is ensured
-	*moves = moveArrayToSort[0];
+#ifdef KILLER_MOVES
+	AddKillerBonuses(m, count);
+#endif
+	SortMoves(m, count);
+	//pass move, the only one if count == 0
+	m[count].from = m[count].to = -1;
+	count++;
+	*moves = m;
+	return count;
 }
 
-/// Generate all moves, sort them by heuristics and return only maxMoves best
-inline void GenerateBestMovesSorted(Move ** moves, i32 maxMoves)
+/// Generate all moves, sort them by heuristics and keep only maxMoves best, returns their count
+inline i32 GenerateBestMovesSorted(Move ** moves, i32 maxMoves)
 {
+	TCOUNT(genCalls);
+	Move *m = moveStack[turnNumber * 2 + moveNumber];
 	i32 count = 0;
+#ifdef BITBOARDS
+	for (tbitboard stones = colourBitboards[COLOUR_INDEX(player)]; stones != 0; stones &= stones - 1) {
+		i32 i = BitboardLowest(stones);
+#else
 	for (i32 i = 0; i < BOARD_ARRAY_SIZE; i++) {
 		if (board[i] == BORDER || board[i] == EMPTY || board[i] * player < 0)
 			continue;
+#endif
 		for (i32 j = 0; j < DIRECTION_COUNT; j++) {
-			i32 cx = i % 9 + dxs[j];
-			i32 cy = i / 9 + dys[j];
-			i32 curr = cy * 9 + cx;
-			while (curr >= 0 && curr < BOARD_ARRAY_SIZE && board[curr] == EMPTY) {
-				cx += dxs[j];
-				cy += dys[j];
-				curr = cy * 9 + cx;
-			}
-			if (curr < 0 || curr >= BOARD_ARRAY_SIZE || board[curr] == BORDER)
+			i32 curr = NextStoneInDirection(i, j);
+			if (curr < 0)
 				continue;
 			bool capt = board[i] * board[curr] < 0;
 			if (!capt) {
@@ -834,8 +992,7 @@ inline void GenerateBestMovesSorted(Move ** moves, i32 maxMoves)
 					continue;	//dont stack on last piece
 			} else if (stackHeights[i] < stackHeights[curr])
 				continue;
-			Move *n = (Move *) malloc(sizeof(Move));
-			DBG(moveAlive++);
+			Move *n = &m[count++];
 			n->from = i;
 			n->to = curr;
 			if (capt) {
@@ -844,35 +1001,16 @@ inline void GenerateBestMovesSorted(Move ** moves, i32 maxMoves)
 				n->value = 19 + 3 * counts[board[i] + 3];
 			}
 			ASSERT2(IsMovePossible(n), "Gen some moves: move not possible");
-			moveArrayToSort[count++] = n;
 		}
 	}
-	if (count == 0 && moveNumber == 1) {
-		*moves = null;
-		return;
-	}
-	qsort(moveArrayToSort, count, sizeof(Move *), compareMoves);
+	*moves = m;
+	SortMoves(m, count);
 	i32 min = MIN(count, maxMoves);
-	for (i32 i = 1; i < min; i++) {
-		moveArrayToSort[i - 1]->next = moveArrayToSort[i];
-	}
-	for (i32 i = min; i < count; i++) {
-		FreeMove(moveArrayToSort[i]);
-	}
-	if (moveNumber == 2 && count < maxMoves) {	//pass move
-		Move *n = (Move *) malloc(sizeof(Move));
-		DBG(moveAlive++);
-		n->from = n->to = -1;
-		n->next = null;
-		if (min > 0)
-			moveArrayToSort[min - 1]->next = n; // put pass move to the end of moves list (it's not good move mostly)
-		else {
-			*moves = n;
-			return;
-		}
-	} else
-		moveArrayToSort[min - 1]->next = null;
-	*moves = moveArrayToSort[0];
+	if (moveNumber == 2 && count < maxMoves) {	// put pass move to the end of moves list (it's not good move mostly)
+		m[min].from = m[min].to = -1;
+		min++;
+	}
+	return min;
 }
 
 /// Allocates memory for new move and copies move in the parameter into its variables
@@ -881,11 +1019,28 @@ Move *CloneMove(Move * move)
 {
 	ASSERT2(move != null, "move to clone null");
 	Move *m = MALLOC(Move);
-	m->from = move->from;
-	m->to = move->to;
-	m->next = move->next;
-	m->oldStackHeight = move->oldStackHeight;
-	m->oldStone = move->oldStone;
-	m->value = move->value;
+	*m = *move;
 	return m;
 }
+
+/// Encodes from and to of the move into 16 bits for the transposition table, NO_MOVE is encoded as 0
+inline __attribute__ ((always_inline))
+u16 EncodeMove(Move * move)
+{
+	if (move->from == NO_MOVE)
+		return 0;
+	return (u16) (0x8000 | (move->from + 1) | ((move->to + 1) << 7));	// pass has from == to == -1
+}
+
+/// Decodes the move saved by EncodeMove, only from and to are set, the rest is filled by ExecuteMove
+inline __attribute__ ((always_inline))
+void DecodeMove(u16 code, Move * move)
+{
+	if (code == 0) {
+		move->from = move->to = NO_MOVE;
+	} else {
+		move->from = (code & 0x7F) - 1;
+		move->to = ((code >> 7) & 0x7F) - 1;
+	}
+	move->value = 0;
+}
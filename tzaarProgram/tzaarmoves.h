@@ -18,6 +18,8 @@
 #define SORT_STACK_COUNT_MULT 3
 #define SORT_HISTORY_PRUNES_MULT 20
 #define SORT_STACK_BONUS 6
+#define SORT_KILLER_BONUS 1000	// for the newest killer move of the ply, halved for every older one
+#define SORT_COUNTERMOVE_BONUS 500
 
 static __attribute__ ((unused))
 i32 CapturingStackHeightAdvantage[] = { 0, 0, 15, 50, 160, 200, 210, 220, 230, 240, 250, 260, 270, 280, 290, 300, 310 };
@@ -30,6 +32,25 @@ i32 dxs[] = { 1, -1, 1, -1, 0, 0 };
 // difference in y direction
 static __attribute__ ((unused))
 i32 dys[] = { 1, -1, 0, 0, 1, -1 };
+// directions with an even index go to higher indices in the board array, the odd ones to lower
+
+// generated moves for each ply, the generators fill the array on index turnNumber * 2 + moveNumber (like history)
+extern THREAD_LOCAL Move moveStack[MAX_MOVES][MAX_POSSIBILITIES];
+
+#ifdef BITBOARDS
+// fields on the ray from a field in a direction (up to the border), computed by InitRayMasks
+extern tbitboard RayMasks[BOARD_ARRAY_SIZE][DIRECTION_COUNT];
+#endif
+
+#ifdef LINE_TABLES
+// lines are indexed by the axis (direction / 2) and fields on a line are ordered by their index in the board array
+#define LINE_NONE 0xFF
+extern u8 LineOfField[BOARD_ARRAY_SIZE][DIRECTION_COUNT / 2];
+extern u8 PositionOnLine[BOARD_ARRAY_SIZE][DIRECTION_COUNT / 2];
+extern u8 LineFields[LINE_COUNT][MAX_LINE_LENGTH];
+// position of the first not empty field before [.][.][1] or after [.][.][0] a position, given the line occupancy
+extern u8 LineBlockers[MAX_LINE_LENGTH][1 << MAX_LINE_LENGTH][2];
+#endif
 
 // for converting between field index and name
 static __attribute__((unused))
@@ -51,6 +72,17 @@ char *FieldNames[] = {
 // ---------------
 
 i32 StackQuality(i32 stackHeight, i32 stone, i32 fieldTo);
+#ifdef BITBOARDS
+void InitRayMasks();
+i32 BitboardLowest(tbitboard b);
+i32 BitboardHighest(tbitboard b);
+void ToggleMoveInBitboards(i32 from, i32 to, i32 movedStone, i32 oldStone);
+#endif
+#ifdef LINE_TABLES
+void InitLineTables();
+void ToggleFieldInLines(i32 field);
+#endif
+i32 NextStoneInDirection(i32 field, i32 dir);
 void ZOCAddedStoneFrom(i32 field, i32 to);
 void ZOCAddedStoneTo(i32 field);
 void ZOCRemovingStoneFrom(i32 field, i32 to);
@@ -61,16 +93,20 @@ void ExecuteMove(Move * move);
 void RevertLastMove();
 i32 FieldNameToIndex(const char *field);
 const char *IndexToFieldName(i32 index);
-void GenerateAllMoves(Move ** moves);
+i32 GenerateAllMoves(Move ** moves);
 bool HasLegalMoves();
-void GenerateAllMovesSorted(Move ** moves);
-void GenerateAllMovesSortedMove1(Move ** moves);	//, i32 depth
-void GenerateAllMovesSortedMove2(Move ** moves);
-void GenerateBestMovesSorted(Move ** moves, i32 maxMoves);
+void SortMoves(Move * moves, i32 count);
+#ifdef KILLER_MOVES
+void AddKillerBonuses(Move * moves, i32 count);
+#endif
+i32 GenerateAllMovesSorted(Move ** moves);
+i32 GenerateAllMovesSortedMove1(Move ** moves);	//, i32 depth
+i32 GenerateAllMovesSortedMove2(Move ** moves);
+i32 GenerateBestMovesSorted(Move ** moves, i32 maxMoves);
 void FreeMove(Move * move);
-void FreeAllMoves(Move * move, Move * exception);
-void FreeAllMovesWithoutException(Move * move);
 Move *CloneMove(Move * move);
+u16 EncodeMove(Move * move);
+void DecodeMove(u16 code, Move * move);
 
 void printZOCDebug();
 void printHighestDebug();
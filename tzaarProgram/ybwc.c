@@ -0,0 +1,343 @@
+/*
+ * The module ybwc implements the split points of the parallel Alpha-beta
+ * (AlphaBetaPVMOYBWC) and of the root of the random Alpha-beta, and the worker
+ * threads that search children of split points. Workers search the children
+ * by AlphaBetaPVMO (AlphaBetaPVMOBeginner for the beginner random root) from
+ * their own copy of the position and share TT with the main thread.
+ *
+ * Author: Pavel Veselý
+ * License: GPL v3, see license.txt
+*/
+#define _GNU_SOURCE		// for clock_gettime
+#include "ybwc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+
+typedef struct workerData {
+	pthread_t thread;
+	TTBucket *table;
+	i32 evalParameters;
+	u32 generation;
+} WorkerData;
+
+static SplitPoint splitPoint;	// the only split point, it's used by the main thread
+static SplitPoint *volatile activeSplit;	// &splitPoint while workers can join it, otherwise null
+static bool workersQuit;
+static i32 workerCount;
+static WorkerData workersData[MAX_SEARCH_THREADS];
+static pthread_mutex_t splitMutex = PTHREAD_MUTEX_INITIALIZER;	// guards the split point and the variables above
+static pthread_cond_t workAvailable = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t workersDone = PTHREAD_COND_INITIALIZER;
+
+/// Searches children of the split point until there are none left or the split point is stopped.
+/// The position of the thread must be the position of the split point.
+static void SearchSplitChildren(SplitPoint * sp, bool master)
+{
+	u32 initSearchedNodes = searchedNodes;
+	while (true) {
+		pthread_mutex_lock(&splitMutex);
+		if (sp->stop || sp->next >= sp->count) {
+			pthread_mutex_unlock(&splitMutex);
+			break;
+		}
+		FullMove fm = sp->moves[sp->next++];	// a copy, history of the thread points to the executed moves
+		i32 alpha = sp->alpha, max = sp->max;
+		pthread_mutex_unlock(&splitMutex);
+		ExecuteMove(&fm.m1);
+		ExecuteMove(&fm.m2);
+		i32 val;
+		if (sp->random && sp->beginner)
+			val = -AlphaBetaPVMOBeginner(sp->depth - 2, -WIN, -max + sp->randomMargin + 1);
+		else if (sp->random)
+			val = -AlphaBetaPVMO(sp->depth - 2, -WIN, -max + sp->randomMargin + 1);
+		else if (master)
+			val = -AlphaBetaPVMOYBWC(sp->depth - 2, -sp->beta, -alpha);
+		else
+			val = -AlphaBetaPVMO(sp->depth - 2, -sp->beta, -alpha);
+		RevertLastMove();
+		RevertLastMove();
+		if (searchAborted)
+			break;
+		pthread_mutex_lock(&splitMutex);
+		if (sp->random && val >= sp->max - sp->randomMargin) {	// max may be higher than the one used for the window
+			FullMovesList *nMove = MALLOC(FullMovesList);
+			nMove->move1 = fm.m1;
+			nMove->move2 = fm.m2;
+			nMove->value = val;
+			nMove->next = sp->allMoves;
+			sp->allMoves = nMove;
+		}
+		if (val > sp->max) {
+			sp->max = val;
+			sp->best1 = fm.m1;
+			sp->best2 = fm.m2;
+		}
+		if (!sp->random && val > sp->alpha) {
+			sp->alpha = val;
+			sp->exact = true;
+			if (val >= sp->beta) {
+				TCUTOFF(false);	// the first child was searched before the split
+				sp->cutoff = sp->stop = true;
+			}
+		}
+		pthread_mutex_unlock(&splitMutex);
+	}
+	if (!master) {
+		pthread_mutex_lock(&splitMutex);
+		sp->searchedNodes += searchedNodes - initSearchedNodes;
+		pthread_mutex_unlock(&splitMutex);
+	}
+}
+
+/// Waits for a split point with children left and helps with it, until StopYBWCWorkers is called
+static void *YBWCWorker(void *arg)
+{
+	WorkerData *data = (WorkerData *) arg;
+	TranspositionTable = data->table;
+	searchGeneration = data->generation;
+	SetEvalParameters(data->evalParameters);	// positions of split points are restored later
+	currDepth = -1;		// workers never search the root
+	pthread_mutex_lock(&splitMutex);
+	while (!workersQuit) {
+		SplitPoint *sp = activeSplit;
+		if (sp == null || sp->stop || sp->next >= sp->count) {
+			pthread_cond_wait(&workAvailable, &splitMutex);
+			continue;
+		}
+		sp->workers++;
+		pthread_mutex_unlock(&splitMutex);
+		RestorePositionState(&sp->position);
+		killerRootPly = turnNumber * 2 + moveNumber;	// the history of the thread before the split point isn't set
+		searchAborted = false;
+		abortFlag = &sp->stop;
+		SearchSplitChildren(sp, false);
+		abortFlag = null;
+		pthread_mutex_lock(&splitMutex);
+		if (--sp->workers == 0)
+			pthread_cond_signal(&workersDone);
+	}
+	pthread_mutex_unlock(&splitMutex);
+	TelemetryAddHelper();	// nodes of workers are added to the main thread by split points
+	return null;
+}
+
+/// Starts searchThreads - 1 workers for the current search, returns their number
+i32 StartYBWCWorkers()
+{
+	workersQuit = false;
+	workerCount = 0;
+	FOR(i, 1, searchThreads) {
+		WorkerData *data = &workersData[workerCount];
+		data->table = TranspositionTable;
+		data->evalParameters = evalParameters;
+		data->generation = searchGeneration;
+		if (pthread_create(&data->thread, null, YBWCWorker, data) != 0) {
+			DPRINT("Error: cannot start YBWC worker %d", i);
+			break;
+		}
+		workerCount++;
+	}
+	DPRINT("started %d YBWC workers", workerCount);
+	return workerCount;
+}
+
+/// Stops the workers and waits for them
+void StopYBWCWorkers(i32 count)
+{
+	pthread_mutex_lock(&splitMutex);
+	workersQuit = true;
+	pthread_cond_broadcast(&workAvailable);
+	pthread_mutex_unlock(&splitMutex);
+	FOR(i, 0, count) pthread_join(workersData[i].thread, null);
+	workerCount = 0;
+}
+
+/// Shares the children in sp->moves with workers and searches them together with workers. Returns after all
+/// workers have left the split point, searchAborted is set if the search of the main thread was aborted.
+static void SearchSplitPoint(SplitPoint * sp)
+{
+	SavePositionState(&sp->position);
+	sp->next = 0;
+	sp->exact = sp->cutoff = sp->stop = false;
+	sp->workers = 0;
+	sp->searchedNodes = 0;
+	pthread_mutex_lock(&splitMutex);
+	activeSplit = sp;
+	pthread_cond_broadcast(&workAvailable);
+	pthread_mutex_unlock(&splitMutex);
+
+	volatile bool *oldFlag = abortFlag;
+	abortFlag = &sp->stop;
+	SearchSplitChildren(sp, true);
+	abortFlag = oldFlag;
+	if (searchAborted && sp->cutoff) {	// stopped by the cutoff, not by the deadline
+		searchAborted = false;
+		CheckSearchAbort();
+	}
+	pthread_mutex_lock(&splitMutex);
+	activeSplit = null;
+	while (sp->workers > 0) {
+		if (!searchAborted)
+			CheckSearchAbort();	// workers may search long after the deadline
+		if (searchAborted)
+			sp->stop = true;
+		struct timespec t;
+		clock_gettime(CLOCK_REALTIME, &t);
+		t.tv_nsec += YBWC_WAIT_NS;
+		if (t.tv_nsec >= 1000000000) {
+			t.tv_sec++;
+			t.tv_nsec -= 1000000000;
+		}
+		pthread_cond_timedwait(&workersDone, &splitMutex, &t);
+	}
+	pthread_mutex_unlock(&splitMutex);
+	searchedNodes += sp->searchedNodes;
+}
+
+/// True if the current thread can split the node with given depth now
+inline __attribute__ ((always_inline))
+bool CanSplit(i32 depth)
+{
+	return depth >= YBWC_MIN_SPLIT_DEPTH && workerCount > 0 && activeSplit == null && currDepth >= 0;
+}
+
+/// Searches all full-turn children of the node in parallel, except the pair best1, best2 if best1 is set
+/// (the PV move searched by the caller). When best1 isn't set, the first child is searched before the others
+/// are shared with workers. Alpha, max, best moves and ttType are updated as in the sequential loop,
+/// returns false if the search was aborted.
+bool SplitNode(i32 depth, i32 * alpha, i32 beta, i32 * max, Move * best1, Move * best2, i32 * ttType)
+{
+	Move *moves, *moves2;
+	i32 count, count2;
+	if (best1->from == NO_MOVE) {	// the eldest brother
+		GenerateAllMovesSortedMove1(&moves);
+		Move m1 = moves[0];
+		ExecuteMove(&m1);
+		if (player * value == WIN) {
+			RevertLastMove();
+			*max = *alpha = WIN;
+			*best1 = m1;
+			best2->from = NO_MOVE;
+			*ttType = LOWER_BOUND;
+			return true;
+		}
+		GenerateAllMovesSortedMove2(&moves2);
+		Move m2 = moves2[0];
+		ExecuteMove(&m2);
+		i32 val = -AlphaBetaPVMOYBWC(depth - 2, -beta, -*alpha);
+		RevertLastMove();
+		RevertLastMove();
+		if (searchAborted)
+			return false;
+		*max = val;
+		*best1 = m1;
+		*best2 = m2;
+		if (depth == currDepth)
+			SaveRootBest(best1, best2, *max, false);
+		if (val > *alpha) {
+			*alpha = val;
+			*ttType = EXACT_VALUE;
+			if (*alpha >= beta) {
+				TCUTOFF(true);	// the eldest brother
+				*ttType = LOWER_BOUND;
+				return true;
+			}
+		}
+	}
+	SplitPoint *sp = &splitPoint;
+	sp->count = 0;
+	count = GenerateAllMovesSortedMove1(&moves);
+	for (Move *move = moves; move < moves + count; move++) {
+		ExecuteMove(move);
+		if (player * value == WIN) {
+			RevertLastMove();
+			*max = *alpha = WIN;
+			*best1 = *move;
+			best2->from = NO_MOVE;
+			*ttType = LOWER_BOUND;
+			return true;
+		}
+		count2 = GenerateAllMovesSortedMove2(&moves2);
+		for (Move *move2 = moves2; move2 < moves2 + count2; move2++) {
+			if (move->from == best1->from && move->to == best1->to
+			    && move2->from == best2->from && move2->to == best2->to)
+				continue;
+			sp->moves[sp->count].m1 = *move;
+			sp->moves[sp->count].m2 = *move2;
+			sp->count++;
+		}
+		RevertLastMove();
+	}
+	if (sp->count == 0)
+		return true;
+	sp->depth = depth;
+	sp->alpha = *alpha;
+	sp->beta = beta;
+	sp->max = *max;
+	sp->best1 = *best1;
+	sp->best2 = *best2;
+	sp->random = false;
+	SearchSplitPoint(sp);
+
+	// children searched completely are valid also when the search is aborted
+	if (sp->max > *max) {
+		*max = sp->max;
+		*best1 = sp->best1;
+		*best2 = sp->best2;
+		if (depth == currDepth)
+			SaveRootBest(best1, best2, *max, false);
+	}
+	if (searchAborted)
+		return false;
+	*alpha = sp->alpha;
+	if (sp->exact)
+		*ttType = EXACT_VALUE;
+	if (sp->cutoff)
+		*ttType = LOWER_BOUND;
+	return true;
+}
+
+/// True if the root of the random Alpha-beta can be searched by SplitRandomRoot
+inline __attribute__ ((always_inline))
+bool CanSplitRoot()
+{
+	return workerCount > 0 && activeSplit == null;
+}
+
+/// Searches all full-turn children of the root as AlphaBetaPVMORandom (AlphaBetaPVMORandomBeginner if beginner)
+/// does, but in parallel. Children within randomMargin of the maximum are added to allMoves in no particular
+/// order, the caller selects from them by the final max. Returns false if the search was aborted.
+bool SplitRandomRoot(i32 depth, i32 randomMargin, bool beginner, i32 * max, FullMovesList ** allMoves, i32 * moveCount)
+{
+	Move *moves, *moves2;
+	SplitPoint *sp = &splitPoint;
+	sp->count = 0;
+	i32 count = GenerateAllMovesSortedMove1(&moves);
+	for (Move *move = moves; move < moves + count; move++) {
+		ExecuteMove(move);
+		i32 count2 = GenerateAllMovesSortedMove2(&moves2);
+		for (Move *move2 = moves2; move2 < moves2 + count2; move2++) {
+			sp->moves[sp->count].m1 = *move;
+			sp->moves[sp->count].m2 = *move2;
+			sp->count++;
+		}
+		RevertLastMove();
+	}
+	sp->depth = depth;
+	sp->alpha = -WIN;
+	sp->beta = WIN;
+	sp->max = *max;
+	sp->best1.from = sp->best2.from = NO_MOVE;
+	sp->random = true;
+	sp->beginner = beginner;
+	sp->randomMargin = randomMargin;
+	sp->allMoves = *allMoves;
+	SearchSplitPoint(sp);
+	*max = sp->max;
+	*allMoves = sp->allMoves;
+	*moveCount += sp->count;
+	return !searchAborted;
+}
@@ -0,0 +1,49 @@
+/*
+ * The header file for module ybwc which parallelizes Alpha-beta by Young
+ * Brothers Wait Concept (YBWC): after the first full-turn child of a node
+ * is searched, the remaining children are shared with idle worker threads.
+ * Only the main thread creates split points and at most one at a time, so
+ * the split point moves up along the principal variation as the main thread
+ * returns from the first children. The same workers search the root children
+ * of the random Alpha-beta (AlphaBetaPVMORandom), which needs all of them.
+ *
+ * Author: Pavel Veselý
+ * License: GPL v3, see license.txt
+*/
+#ifndef YBWC_H_INCLUDED
+#define YBWC_H_INCLUDED
+
+#include "tzaarlib.h"
+
+struct fullMovesList;		// FullMovesList, alphaBeta.h may be included after this header
+
+#define YBWC_MIN_SPLIT_DEPTH 4	// nodes with a smaller depth are searched sequentially
+#define YBWC_WAIT_NS 10000000	// the main thread checks the deadline while waiting for workers every 10 ms
+
+typedef struct splitPoint {
+	PositionState position;	// the position of the node, workers search from its copy
+	FullMove moves[MAX_POSSIBILITIES * MAX_POSSIBILITIES];	// full-turn children except the first one
+	i32 count, next;	// next is the index of the first child not taken yet
+	i32 depth, alpha, beta;
+	i32 max;
+	Move best1, best2;
+	bool exact;		// a child improved alpha
+	volatile bool cutoff;	// a child failed high, the other children are not needed
+	volatile bool stop;	// cutoff or the main thread aborted its search, polled as abortFlag
+	i32 workers;		// number of workers searching the children
+	u32 searchedNodes;	// nodes searched by workers
+	bool random;		// the root of the random Alpha-beta, children are searched with the full window
+	bool beginner;		// random with the beginner evaluation (AlphaBetaPVMOBeginner)
+	i32 randomMargin;
+	struct fullMovesList *allMoves;	// random: children with values within randomMargin of max when they were searched
+} SplitPoint;
+
+// FUNCTIONS
+i32 StartYBWCWorkers();
+void StopYBWCWorkers(i32 count);
+bool CanSplit(i32 depth);
+bool SplitNode(i32 depth, i32 * alpha, i32 beta, i32 * max, Move * best1, Move * best2, i32 * ttType);
+bool CanSplitRoot();
+bool SplitRandomRoot(i32 depth, i32 randomMargin, bool beginner, i32 * max, struct fullMovesList **allMoves, i32 * moveCount);
+
+#endif				// YBWC_H_INCLUDED